@@ -24,4 +24,33 @@ add_executable(${TEST_APP_NAME} ${TEST_SOURCES})
 target_link_libraries(${TEST_APP_NAME} ${APP_LIB_NAME} ${CPPUTEST_LDFLAGS})
 
 # (5) Run the test once the build is done
-add_custom_command(TARGET ${TEST_APP_NAME} COMMAND ./${TEST_APP_NAME} POST_BUILD)
\ No newline at end of file
+if(CMS_CPPUTEST_RUN_POST_BUILD)
+    add_custom_command(TARGET ${TEST_APP_NAME} COMMAND ./${TEST_APP_NAME} POST_BUILD)
+endif()
+
+# (6) Register the tests with CTest, split into CMS_CPPUTEST_SHARDS processes,
+#     such that "ctest -j" runs the shards in parallel. The report test then
+#     merges the shards' JUnit output and prints the slowest tests.
+set(CMS_SHARD_OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/${TEST_APP_NAME}-results)
+set(CMS_SHARD_TESTS "")
+math(EXPR CMS_LAST_SHARD "${CMS_CPPUTEST_SHARDS} - 1")
+foreach(CMS_SHARD RANGE ${CMS_LAST_SHARD})
+    add_test(NAME ${TEST_APP_NAME}_shard_${CMS_SHARD}
+            COMMAND ${CMAKE_COMMAND}
+                    -DTEST_EXE=$<TARGET_FILE:${TEST_APP_NAME}>
+                    -DTEST_EXE_NAME=$<TARGET_FILE_BASE_NAME:${TEST_APP_NAME}>
+                    -DSHARD_INDEX=${CMS_SHARD}
+                    -DSHARD_COUNT=${CMS_CPPUTEST_SHARDS}
+                    -DOUTPUT_DIR=${CMS_SHARD_OUTPUT_DIR}
+                    -P ${CMS_CMAKE_DIR}/cpputestShard.cmake)
+    list(APPEND CMS_SHARD_TESTS ${TEST_APP_NAME}_shard_${CMS_SHARD})
+endforeach()
+
+add_test(NAME ${TEST_APP_NAME}_report
+        COMMAND ${CMAKE_COMMAND}
+                -DTEST_EXE_NAME=$<TARGET_FILE_BASE_NAME:${TEST_APP_NAME}>
+                -DSHARD_COUNT=${CMS_CPPUTEST_SHARDS}
+                -DOUTPUT_DIR=${CMS_SHARD_OUTPUT_DIR}
+                -DSLOWEST_COUNT=${CMS_CPPUTEST_SLOWEST_COUNT}
+                -P ${CMS_CMAKE_DIR}/cpputestShardReport.cmake)
+set_tests_properties(${TEST_APP_NAME}_report PROPERTIES DEPENDS "${CMS_SHARD_TESTS}")
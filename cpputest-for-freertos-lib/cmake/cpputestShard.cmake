@@ -0,0 +1,174 @@
+# Runs one shard of a CppUTest executable's tests, as a CMake script:
+#
+#   cmake -DTEST_EXE=<exe> -DTEST_EXE_NAME=<exe name> -DSHARD_INDEX=<i> -DSHARD_COUNT=<n>
+#         -DOUTPUT_DIR=<dir> -P cpputestShard.cmake
+#
+# The tests are listed with -ln, and their groups assigned to the shards,
+# largest group first to the shard with the fewest tests so far. The
+# shard's groups are then run by one process, with one -sg per group,
+# -ojunit for the JUnit report and -v for the wall time of each test.
+# The process runs in OUTPUT_DIR/<exe name>_shard_<i>, such that the
+# shards' working files never collide. The results are written to
+# OUTPUT_DIR/<exe name>_shard_<i>.txt, one line per test
+# "<ms>|<group>|<name>|<status>", and the JUnit testsuites to
+# OUTPUT_DIR/<exe name>_shard_<i>.xml, both merged by
+# cpputestShardReport.cmake.
+
+foreach(var TEST_EXE TEST_EXE_NAME SHARD_INDEX SHARD_COUNT OUTPUT_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "cpputestShard.cmake requires -D${var}=...")
+    endif()
+endforeach()
+
+set(RESULTS_FILE ${OUTPUT_DIR}/${TEST_EXE_NAME}_shard_${SHARD_INDEX}.txt)
+set(JUNIT_FILE ${OUTPUT_DIR}/${TEST_EXE_NAME}_shard_${SHARD_INDEX}.xml)
+set(SHARD_DIR ${OUTPUT_DIR}/${TEST_EXE_NAME}_shard_${SHARD_INDEX})
+file(REMOVE ${RESULTS_FILE} ${JUNIT_FILE})
+file(REMOVE_RECURSE ${SHARD_DIR})
+file(MAKE_DIRECTORY ${SHARD_DIR})
+
+execute_process(COMMAND ${TEST_EXE} -ln
+        WORKING_DIRECTORY ${SHARD_DIR}
+        OUTPUT_VARIABLE listed
+        RESULT_VARIABLE listResult)
+if(NOT listResult EQUAL 0)
+    message(FATAL_ERROR "${TEST_EXE} -ln failed: ${listResult}")
+endif()
+
+string(STRIP "${listed}" listed)
+string(REGEX REPLACE "[ \t\r\n]+" ";" tests "${listed}")
+list(SORT tests)
+
+# i.e. Group.name, a group name never contains a '.'
+set(groups "")
+foreach(test IN LISTS tests)
+    string(FIND "${test}" "." dot)
+    string(SUBSTRING "${test}" 0 ${dot} group)
+    if(NOT DEFINED count_${group})
+        set(count_${group} 0)
+        list(APPEND groups ${group})
+    endif()
+    math(EXPR count_${group} "${count_${group}} + 1")
+endforeach()
+
+# zero padded, such that a string sort is a numeric sort
+set(bySize "")
+foreach(group IN LISTS groups)
+    set(count ${count_${group}})
+    string(LENGTH "${count}" digits)
+    while(digits LESS 10)
+        set(count "0${count}")
+        string(LENGTH "${count}" digits)
+    endwhile()
+    list(APPEND bySize "${count} ${group}")
+endforeach()
+list(SORT bySize)
+list(REVERSE bySize)
+
+math(EXPR lastShard "${SHARD_COUNT} - 1")
+foreach(shard RANGE ${lastShard})
+    set(load_${shard} 0)
+endforeach()
+
+set(shardGroups "")
+foreach(entry IN LISTS bySize)
+    string(REGEX MATCH "^[0-9]+ (.+)$" matched "${entry}")
+    set(group ${CMAKE_MATCH_1})
+    set(lightest 0)
+    foreach(shard RANGE ${lastShard})
+        if(${load_${shard}} LESS ${load_${lightest}})
+            set(lightest ${shard})
+        endif()
+    endforeach()
+    math(EXPR load_${lightest} "${load_${lightest}} + ${count_${group}}")
+    if(lightest EQUAL SHARD_INDEX)
+        list(APPEND shardGroups ${group})
+    endif()
+endforeach()
+
+if(NOT shardGroups)
+    # more shards than groups, without filters the process would run every test
+    file(WRITE ${RESULTS_FILE} "")
+    file(WRITE ${JUNIT_FILE} "")
+    return()
+endif()
+
+set(filters "")
+foreach(group IN LISTS shardGroups)
+    list(APPEND filters -sg ${group})
+endforeach()
+
+execute_process(COMMAND ${TEST_EXE} -v -ojunit ${filters}
+        WORKING_DIRECTORY ${SHARD_DIR}
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output
+        RESULT_VARIABLE result)
+
+# -v prints "TEST(Group, name)", any output of the test, then " - <ms> ms"
+set(results "")
+set(failures "")
+foreach(test IN LISTS tests)
+    string(FIND "${test}" "." dot)
+    string(SUBSTRING "${test}" 0 ${dot} group)
+    list(FIND shardGroups ${group} inShard)
+    if(inShard EQUAL -1)
+        continue()
+    endif()
+    math(EXPR nameStart "${dot} + 1")
+    string(SUBSTRING "${test}" ${nameStart} -1 name)
+
+    set(ms 0)
+    string(FIND "${output}" "TEST(${group}, ${name})" started)
+    if(started EQUAL -1)
+        # i.e. the process crashed before the test ran
+        set(status failed)
+    else()
+        string(SUBSTRING "${output}" ${started} -1 rest)
+        set(ended FALSE)
+        if(rest MATCHES " - ([0-9]+) ms")
+            set(ms ${CMAKE_MATCH_1})
+            set(ended TRUE)
+        endif()
+
+        set(prefix "")
+        if(started GREATER_EQUAL 7)
+            math(EXPR prefixStart "${started} - 7")
+            string(SUBSTRING "${output}" ${prefixStart} 7 prefix)
+        endif()
+
+        string(FIND "${output}" "Failure in TEST(${group}, ${name})" failedAt)
+        if(NOT ended OR NOT failedAt EQUAL -1)
+            set(status failed)
+        elseif(prefix STREQUAL "IGNORE_")
+            set(status ignored)
+        else()
+            set(status passed)
+        endif()
+    endif()
+
+    if(status STREQUAL "failed")
+        list(APPEND failures ${test})
+    endif()
+    string(APPEND results "${ms}|${group}|${name}|${status}\n")
+endforeach()
+
+# each group's cpputest_<group>.xml holds one testsuite
+file(GLOB junitFiles ${SHARD_DIR}/cpputest_*.xml)
+list(SORT junitFiles)
+set(junit "")
+foreach(junitFile IN LISTS junitFiles)
+    file(READ ${junitFile} suite)
+    string(REGEX REPLACE "<\\?xml[^>]*>[\r\n]*" "" suite "${suite}")
+    string(APPEND junit "${suite}")
+endforeach()
+
+file(WRITE ${RESULTS_FILE} "${results}")
+file(WRITE ${JUNIT_FILE} "${junit}")
+
+if(failures OR NOT result EQUAL 0)
+    message("${output}")
+    list(LENGTH failures failureCount)
+    string(REPLACE ";" "\n  " failures "${failures}")
+    message(FATAL_ERROR "${TEST_EXE_NAME} shard ${SHARD_INDEX} failed (${result}), "
+            "${failureCount} test(s) failed:\n  ${failures}")
+endif()
@@ -0,0 +1,98 @@
+# Merges the results of all shards written by cpputestShard.cmake, as a CMake script:
+#
+#   cmake -DTEST_EXE_NAME=<exe name> -DSHARD_COUNT=<n> -DOUTPUT_DIR=<dir>
+#         [-DSLOWEST_COUNT=<count>] -P cpputestShardReport.cmake
+#
+# Writes the JUnit report OUTPUT_DIR/<exe name>.xml, holding each shard's
+# CppUTest testsuites, and prints the slowest tests, longest first.
+
+foreach(var TEST_EXE_NAME SHARD_COUNT OUTPUT_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "cpputestShardReport.cmake requires -D${var}=...")
+    endif()
+endforeach()
+
+if(NOT DEFINED SLOWEST_COUNT)
+    set(SLOWEST_COUNT 10)
+endif()
+
+set(testsuites "")
+set(timings "")
+set(testCount 0)
+set(failureCount 0)
+set(skippedCount 0)
+set(totalMs 0)
+
+math(EXPR lastShard "${SHARD_COUNT} - 1")
+foreach(shard RANGE ${lastShard})
+    set(results ${OUTPUT_DIR}/${TEST_EXE_NAME}_shard_${shard}.txt)
+    set(junit ${OUTPUT_DIR}/${TEST_EXE_NAME}_shard_${shard}.xml)
+    if(NOT EXISTS ${results} OR NOT EXISTS ${junit})
+        message(FATAL_ERROR "Shard ${shard} of ${TEST_EXE_NAME} has no results, was it run?")
+    endif()
+
+    file(READ ${junit} shardTestsuites)
+    string(APPEND testsuites "${shardTestsuites}")
+
+    file(STRINGS ${results} lines)
+    foreach(line IN LISTS lines)
+        string(REGEX MATCH "^([0-9]+)\\|([^|]+)\\|([^|]+)\\|(.+)$" matched "${line}")
+        set(ms ${CMAKE_MATCH_1})
+        set(test "${CMAKE_MATCH_2}.${CMAKE_MATCH_3}")
+        set(status ${CMAKE_MATCH_4})
+
+        math(EXPR testCount "${testCount} + 1")
+        math(EXPR totalMs "${totalMs} + ${ms}")
+        if(status STREQUAL "failed")
+            math(EXPR failureCount "${failureCount} + 1")
+        elseif(status STREQUAL "ignored")
+            math(EXPR skippedCount "${skippedCount} + 1")
+        endif()
+
+        # zero padded, such that a string sort is a numeric sort
+        string(LENGTH "${ms}" digits)
+        while(digits LESS 10)
+            set(ms "0${ms}")
+            string(LENGTH "${ms}" digits)
+        endwhile()
+        list(APPEND timings "${ms} ${test}")
+    endforeach()
+endforeach()
+
+math(EXPR seconds "${totalMs} / 1000")
+math(EXPR fraction "${totalMs} % 1000")
+string(LENGTH "${fraction}" digits)
+while(digits LESS 3)
+    set(fraction "0${fraction}")
+    string(LENGTH "${fraction}" digits)
+endwhile()
+
+file(WRITE ${OUTPUT_DIR}/${TEST_EXE_NAME}.xml
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
+        "<testsuites name=\"${TEST_EXE_NAME}\" tests=\"${testCount}\" failures=\"${failureCount}\" "
+        "errors=\"0\" skipped=\"${skippedCount}\" time=\"${seconds}.${fraction}\">\n"
+        "${testsuites}"
+        "</testsuites>\n")
+
+list(SORT timings)
+list(REVERSE timings)
+list(LENGTH timings available)
+if(SLOWEST_COUNT GREATER available)
+    set(SLOWEST_COUNT ${available})
+endif()
+
+message("${TEST_EXE_NAME}: ${testCount} tests, ${failureCount} failed, ${skippedCount} ignored, "
+        "${seconds}.${fraction} s in total. JUnit: ${OUTPUT_DIR}/${TEST_EXE_NAME}.xml")
+if(SLOWEST_COUNT GREATER 0)
+    message("Slowest tests:")
+    math(EXPR last "${SLOWEST_COUNT} - 1")
+    foreach(i RANGE ${last})
+        list(GET timings ${i} entry)
+        string(REGEX MATCH "^0*([0-9]+) (.+)$" matched "${entry}")
+        message("  ${CMAKE_MATCH_1} ms  ${CMAKE_MATCH_2}")
+    endforeach()
+endif()
+
+if(failureCount GREATER 0)
+    message(FATAL_ERROR "${failureCount} test(s) of ${TEST_EXE_NAME} failed")
+endif()
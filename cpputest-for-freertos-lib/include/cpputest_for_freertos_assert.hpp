@@ -24,6 +24,9 @@
 #ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_ASSERT_HPP
 #define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_ASSERT_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 #include "FreeRTOS.h"
 #include "CppUTestExt/MockSupport.h"
 
@@ -33,6 +36,55 @@ namespace cms {
         void AssertOutputEnable();
         void AssertOutputDisable();
 
+        struct AssertRecord
+        {
+            const char * file;
+            unsigned long line;
+        };
+
+        /**
+         * Reset the assert counter, disarm ExpectAssert() and
+         * drop any captured assert records.
+         */
+        void AssertInit();
+
+        /**
+         * If ExpectAssert() was called, confirm that exactly the expected
+         * number of configASSERT failures occurred, otherwise that is
+         * considered a test failure.
+         */
+        void AssertTeardown();
+
+        /**
+         * Expect count more configASSERT failures before AssertTeardown().
+         * A lightweight alternative to MockExpectAssert(): while armed,
+         * configASSERT only increments a counter, and optionally captures
+         * the file and line, bypassing mock() and the assert output
+         * entirely. An assert beyond count fails the test. As always, a
+         * configASSERT exits the current test.
+         * @param count
+         */
+        void ExpectAssert(uint32_t count = 1);
+
+        /**
+         * @return the number of configASSERT failures since AssertInit(),
+         *         whether or not ExpectAssert() is armed.
+         */
+        uint32_t AssertCount();
+
+        /**
+         * Capture the file and line of up to maxRecords configASSERT
+         * failures. The buffer is allocated here, not when asserting.
+         * Asserts beyond maxRecords are counted but not captured.
+         * @param maxRecords - 0 disables capture.
+         */
+        void AssertCaptureEnable(size_t maxRecords);
+
+        /**
+         * @return the captured configASSERT failures, oldest first.
+         */
+        const std::vector<AssertRecord> & GetAssertRecords();
+
         static constexpr const char* ASSERT_MOCK_NAME  = "ASSERT";
         static constexpr const char* ON_ASSERT_FUNC_NAME  = "cmsAssertCalled";
 
@@ -0,0 +1,67 @@
+/// @brief Optional, records the __FILE__ and __LINE__ of each dynamically
+///        created kernel object, for the kernel object leak report. Include
+///        this header after the FreeRTOS headers, or force include it
+///        (i.e. -include) when compiling the code under test. C or C++.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_CREATION_SITE_H
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_CREATION_SITE_H
+
+/* the kernel's creation macros must be defined before they are wrapped */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the next kernel object creation attempt is attributed to file and line */
+void cmsKernelObjectCreationSite( const char * file, unsigned long line );
+
+#ifdef __cplusplus
+}
+#endif
+
+#define cmsAT_CREATION_SITE( creation )    ( cmsKernelObjectCreationSite( __FILE__, __LINE__ ), ( creation ) )
+
+/* the kernel's creation macros (xQueueCreate, xSemaphoreCreateMutex,
+ * xStreamBufferCreate, etc) expand to these, which are then wrapped */
+#define xQueueGenericCreate( ... )           cmsAT_CREATION_SITE( xQueueGenericCreate( __VA_ARGS__ ) )
+#define xQueueCreateMutex( ... )             cmsAT_CREATION_SITE( xQueueCreateMutex( __VA_ARGS__ ) )
+#define xQueueCreateCountingSemaphore( ... ) cmsAT_CREATION_SITE( xQueueCreateCountingSemaphore( __VA_ARGS__ ) )
+#define xQueueCreateSet( ... )               cmsAT_CREATION_SITE( xQueueCreateSet( __VA_ARGS__ ) )
+#define xTaskCreate( ... )                   cmsAT_CREATION_SITE( xTaskCreate( __VA_ARGS__ ) )
+#define xTimerCreate( ... )                  cmsAT_CREATION_SITE( xTimerCreate( __VA_ARGS__ ) )
+#define xEventGroupCreate( ... )             cmsAT_CREATION_SITE( xEventGroupCreate( __VA_ARGS__ ) )
+#define xStreamBufferGenericCreate( ... )    cmsAT_CREATION_SITE( xStreamBufferGenericCreate( __VA_ARGS__ ) )
+
+#if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+    #define xTaskCreateAffinitySet( ... )    cmsAT_CREATION_SITE( xTaskCreateAffinitySet( __VA_ARGS__ ) )
+#endif
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_CREATION_SITE_H
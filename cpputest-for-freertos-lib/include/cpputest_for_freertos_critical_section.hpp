@@ -0,0 +1,115 @@
+/// @brief Support methods to help with unit testing of FreeRTOS critical
+///        sections, interrupt disable/enable and scheduler suspension.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_CRITICAL_SECTION_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_CRITICAL_SECTION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace cms {
+namespace test {
+
+    enum class CriticalRegionKind
+    {
+        Critical,             ///< portENTER_CRITICAL/portEXIT_CRITICAL
+        InterruptsDisabled,   ///< portDISABLE_INTERRUPTS/portENABLE_INTERRUPTS
+        InterruptMaskFromIsr, ///< portSET/CLEAR_INTERRUPT_MASK_FROM_ISR
+        SchedulerSuspended,   ///< vTaskSuspendAll/xTaskResumeAll
+        CriticalFromIsr       ///< portENTER/EXIT_CRITICAL_FROM_ISR, SMP only
+    };
+
+    /**
+     * Statistics for all regions of a given kind which were entered
+     * from the same call site.
+     */
+    struct CriticalRegionStats
+    {
+        CriticalRegionKind kind;
+        const char * file;  ///< nullptr when the call site is unknown, see
+                            ///< cpputest_for_freertos_suspend_site.h
+        unsigned long line;
+        uint64_t count;
+        std::chrono::nanoseconds maxHostDuration;
+        std::chrono::nanoseconds totalHostDuration;
+        std::chrono::nanoseconds maxVirtualDuration;
+        std::chrono::nanoseconds totalVirtualDuration;
+    };
+
+    /**
+     * Initialize critical section tracking, such that this unit test,
+     * when Teardown is called, will confirm that all critical sections,
+     * interrupt disables and scheduler suspensions were exited and that
+     * no mismatched exits occurred. Per call site statistics are
+     * collected while tracking is active.
+     */
+    void CriticalSectionTrackingInit();
+
+    /**
+     * Check the state of critical sections. If any region is still
+     * active, or a mismatched exit was detected, then that is considered
+     * a test failure.
+     */
+    void CriticalSectionTrackingTeardown();
+
+    /**
+     * @return the current portENTER_CRITICAL nesting depth,
+     *         of the current core.
+     */
+    uint32_t GetCriticalNesting();
+
+    /**
+     * @return true: interrupts are currently disabled or masked, by any means,
+     *         on the current core.
+     */
+    bool AreInterruptsDisabled();
+
+    /**
+     * @return true: vTaskSuspendAll is currently in effect.
+     */
+    bool IsSchedulerSuspended();
+
+    /**
+     * @return the number of exits (portEXIT_CRITICAL, xTaskResumeAll, etc)
+     *         which were not matched by a prior entry.
+     */
+    uint32_t GetCriticalMismatchCount();
+
+    /**
+     * Get the per call site statistics collected since
+     * CriticalSectionTrackingInit, sorted by longest host duration first.
+     */
+    std::vector<CriticalRegionStats> GetCriticalRegionReport();
+
+    /**
+     * Print the longest regions found in GetCriticalRegionReport().
+     * @param maxEntries
+     */
+    void PrintCriticalRegionReport(size_t maxEntries = 10);
+
+} //namespace
+}//namespace
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_CRITICAL_SECTION_HPP
@@ -0,0 +1,86 @@
+/// @brief Support methods to help with unit testing of interrupt service
+///        routines and ISR to task latency.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_ISR_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_ISR_HPP
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace cms {
+namespace test {
+
+    /**
+     * Initialize ISR latency tracking, i.e. the virtual time from
+     * the entry of an ISR, executed via RunInIsrContext, until the
+     * event posted by the ISR (xQueueSendFromISR, xSemaphoreGiveFromISR, etc)
+     * is received by task level code.
+     */
+    void IsrInit();
+
+    /**
+     * Clean up/destroy ISR latency tracking.
+     */
+    void IsrTeardown();
+
+    /**
+     * Execute the provided method as if it was an interrupt service
+     * routine. While executing, non-FromISR FreeRTOS APIs will assert.
+     * Nested calls simulate nested interrupts.
+     *
+     * If the ISR does not request a context switch via portYIELD_FROM_ISR,
+     * the woken task is considered ready no earlier than the next tick,
+     * as with the kernel.
+     * @param isr
+     */
+    void RunInIsrContext(const std::function<void()>& isr);
+
+    /**
+     * @return true: currently executing within RunInIsrContext
+     */
+    bool IsInIsrContext();
+
+    /**
+     * @return true: the most recently completed (outermost) ISR
+     *         requested a context switch via portYIELD_FROM_ISR.
+     */
+    bool WasYieldRequestedFromIsr();
+
+    /**
+     * Get the ISR to task latency of each event received by task level
+     * code since IsrInit, in the order received. Each latency is the
+     * virtual time from ISR entry until the receive, and is never less
+     * than the time until the woken task was able to execute.
+     */
+    std::vector<std::chrono::nanoseconds> GetIsrLatencies();
+
+    /**
+     * @return the longest latency found in GetIsrLatencies().
+     */
+    std::chrono::nanoseconds GetMaxIsrLatency();
+
+} //namespace
+}//namespace
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_ISR_HPP
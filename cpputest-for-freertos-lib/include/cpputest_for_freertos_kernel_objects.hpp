@@ -0,0 +1,136 @@
+/// @brief Support methods to help with unit testing for FreeRTOS, detecting
+///        dynamically created kernel objects which a test never deleted.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_KERNEL_OBJECTS_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_KERNEL_OBJECTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cms {
+namespace test {
+
+    enum class KernelObjectKind
+    {
+        Queue,             ///< including queue sets
+        Semaphore,
+        Mutex,
+        Task,
+        Timer,
+        EventGroup,
+        StreamBuffer,
+        MessageBuffer
+    };
+
+    /**
+     * A kernel object created while tracking was active.
+     */
+    struct KernelObjectRecord
+    {
+        KernelObjectKind kind;
+        const void * handle;
+        std::string name;      ///< task or timer name, or queue registry name, if any
+        const char * file;     ///< creation site, nullptr when unknown,
+        unsigned long line;    ///< see cpputest_for_freertos_creation_site.h
+        std::string test;      ///< the test which created the object
+        uint64_t sequence;     ///< creation order within this tracking session
+        size_t footprint;      ///< target RAM, i.e. control block, storage and stack
+        bool isStatic;         ///< memory was provided by the caller
+    };
+
+    /**
+     * Target RAM of all kernel objects of a kind sharing a name.
+     */
+    struct FootprintEntry
+    {
+        KernelObjectKind kind;
+        std::string name;
+        uint64_t count;
+        size_t bytes;
+    };
+
+    /**
+     * Target RAM of the kernel objects created during this test,
+     * computed from the kernel's Static*_t types, queue and buffer
+     * storage and task stacks. The Static*_t and StackType_t sizes
+     * are the host's unless CMS_FREERTOS_TARGET_SIZEOF gives the
+     * target's, see FreeRTOSConfig.h.
+     */
+    struct FootprintReport
+    {
+        size_t totalBytes;     ///< all objects created, whether deleted or not
+        size_t peakBytes;      ///< the most bytes held by objects alive at once
+        size_t liveBytes;      ///< objects not yet deleted
+        std::vector<FootprintEntry> entries; ///< by kind and name, largest first
+    };
+
+    /**
+     * Initialize kernel object tracking, such that this unit test,
+     * when Teardown is called, will confirm that every queue, semaphore,
+     * mutex, task, timer, event group and stream/message buffer created
+     * with dynamic allocation was also deleted. Statically created
+     * objects are only included in the footprint report.
+     */
+    void KernelObjectTrackingInit();
+
+    /**
+     * Check for leaked kernel objects. If any remain, they are printed
+     * and that is considered a test failure, as is exceeding the
+     * footprint budget.
+     */
+    void KernelObjectTrackingTeardown();
+
+    /**
+     * @return the dynamically created kernel objects not yet deleted,
+     *         in order of creation.
+     */
+    std::vector<KernelObjectRecord> GetLiveKernelObjects();
+
+    /**
+     * Print the list found in GetLiveKernelObjects().
+     */
+    void PrintLiveKernelObjects();
+
+    /**
+     * @return the target RAM used by kernel objects created during this test.
+     */
+    FootprintReport GetFootprintReport();
+
+    /**
+     * Print the report found in GetFootprintReport().
+     */
+    void PrintFootprintReport();
+
+    /**
+     * Fail the test, at KernelObjectTrackingTeardown, if the kernel objects
+     * alive at once during this test ever needed more than the given
+     * bytes of target RAM. Zero, the default, disables the budget.
+     */
+    void SetFootprintBudget(size_t bytes);
+
+} //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_KERNEL_OBJECTS_HPP
@@ -28,28 +28,58 @@
 #include "cpputest_for_freertos_task.hpp"
 #include "cpputest_for_freertos_timers.hpp"
 #include "cpputest_for_freertos_mutex.hpp"
+#include "cpputest_for_freertos_critical_section.hpp"
+#include "cpputest_for_freertos_smp.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_kernel_objects.hpp"
+#include "cpputest_for_freertos_stream_buffer.hpp"
+#include "cpputest_for_freertos_time_budget.hpp"
+#include "cpputest_for_freertos_trace.hpp"
+#include "cpputest_for_freertos_timeline.hpp"
 
 namespace cms {
     namespace test {
         /**
          * call this in your unit test setup() method to initialize
-         * all available CppUTest for FreeRTOS modules.
+         * all available CppUTest for FreeRTOS modules. The modules'
+         * state is per thread, i.e. only for the calling thread.
          */
         void LibInitAll() {
+            HeapInit();
+            ArenaInit();
+            SmpInit();
             TaskInit();
             AssertOutputEnable();
+            AssertInit();
             TimersInit();
+            IsrInit();
             MutexTrackingInit();
+            CriticalSectionTrackingInit();
+            KernelObjectTrackingInit();
         }
 
         /**
          * call this in your unit test teardown() method to correctly
          * destroy/teardown all available CppUTest for FreeRTOS modules.
+         * An opt-in trace or timeline, see TraceInit() and TimelineInit(),
+         * is stopped first, such that it is saved when the test has
+         * already failed. A teardown which fails the test skips those
+         * after it, whose state is then discarded by the next LibInitAll().
          */
         void LibTeardownAll() {
+            TraceTeardown();
+            TimelineTeardown();
             MutexTrackingTeardown();
+            IsrTeardown();
             TimersDestroy();
             TaskDestroy();
+            CriticalSectionTrackingTeardown();
+            SmpTeardown();
+            KernelObjectTrackingTeardown();
+            HeapTeardown();
+            ArenaTeardown();
+            AssertTeardown();
         }
     } // namespace test
 } //namespace cms
@@ -1,5 +1,5 @@
 /// @brief Support methods to help with unit testing for FreeRTOS, memory allocation
-///        related support, such as unique_ptr types for allocated queues, etc.
+///        related support, such as unique_ptr types for kernel objects, etc.
 /// @ingroup
 /// @cond
 ///***************************************************************************
@@ -26,13 +26,60 @@
 
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
 #include <memory>
+#include <new>
 #include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 
 namespace cms {
     namespace test {
 
-        struct FreeRTOSQueueDeleter
+        /**
+         * The buffers of a kernel object created by one of the make_unique_*
+         * factories below: its Static*_t followed by its storage or stack, in
+         * one allocation, freed once the object was deleted. A released
+         * (i.e. release()) object's buffers are leaked on purpose, as static
+         * buffers would be on target, such that the handle given to other
+         * code remains valid.
+         */
+        struct StaticBuffersOwner
+        {
+            void * buffers = nullptr;
+
+            StaticBuffersOwner() = default;
+
+            StaticBuffersOwner(StaticBuffersOwner && other) noexcept : buffers(other.buffers)
+            {
+                other.buffers = nullptr;
+            }
+
+            //any buffers still held belong to a released object, see above
+            StaticBuffersOwner & operator=(StaticBuffersOwner && other) noexcept
+            {
+                if (this != &other)
+                {
+                    buffers = other.buffers;
+                    other.buffers = nullptr;
+                }
+                return *this;
+            }
+
+            void ReleaseBuffers()
+            {
+                std::free(buffers);
+                buffers = nullptr;
+            }
+        };
+
+        struct FreeRTOSQueueDeleter : StaticBuffersOwner
         {
             void operator()(struct QueueDefinition * handle)
             {
@@ -40,11 +87,135 @@ namespace cms {
                 {
                     vQueueDelete(handle);
                 }
+                ReleaseBuffers();
+            }
+        };
+
+        struct FreeRTOSTimerDeleter : StaticBuffersOwner
+        {
+            void operator()(struct tmrTimerControl * handle)
+            {
+                if (handle != nullptr)
+                {
+                    xTimerDelete(handle, 0);
+                }
+                ReleaseBuffers();
+            }
+        };
+
+        struct FreeRTOSEventGroupDeleter : StaticBuffersOwner
+        {
+            void operator()(struct EventGroupDef_t * handle)
+            {
+                if (handle != nullptr)
+                {
+                    vEventGroupDelete(handle);
+                }
+                ReleaseBuffers();
+            }
+        };
+
+        struct FreeRTOSStreamBufferDeleter : StaticBuffersOwner
+        {
+            void operator()(struct StreamBufferDef_t * handle)
+            {
+                if (handle != nullptr)
+                {
+                    vStreamBufferDelete(handle);
+                }
+                ReleaseBuffers();
             }
         };
 
+        struct FreeRTOSTaskDeleter : StaticBuffersOwner
+        {
+            void operator()(struct tskTaskControlBlock * handle)
+            {
+                if (handle != nullptr)
+                {
+                    vTaskDelete(handle);
+                }
+                ReleaseBuffers();
+            }
+        };
+
+        /**
+         * Owners of FreeRTOS kernel objects. Timers and tasks must be
+         * released before TimersDestroy() and TaskDestroy() respectively,
+         * i.e. a fixture resets any such members in teardown().
+         */
         using unique_queue = std::unique_ptr<struct QueueDefinition, FreeRTOSQueueDeleter>;
         using unique_sema = std::unique_ptr<struct QueueDefinition, FreeRTOSQueueDeleter>;
+        using unique_mutex = std::unique_ptr<struct QueueDefinition, FreeRTOSQueueDeleter>;
+        using unique_timer = std::unique_ptr<struct tmrTimerControl, FreeRTOSTimerDeleter>;
+        using unique_event_group = std::unique_ptr<struct EventGroupDef_t, FreeRTOSEventGroupDeleter>;
+        using unique_stream_buffer = std::unique_ptr<struct StreamBufferDef_t, FreeRTOSStreamBufferDeleter>;
+        using unique_message_buffer = std::unique_ptr<struct StreamBufferDef_t, FreeRTOSStreamBufferDeleter>;
+        using unique_task = std::unique_ptr<struct tskTaskControlBlock, FreeRTOSTaskDeleter>;
+
+        /**
+         * Create kernel objects with the static creation API, using buffers
+         * owned by the returned object's deleter. The simulated FreeRTOS heap
+         * is not used, and GetDynamicAllocationCount() is not changed. A
+         * stream or message buffer holds size bytes, as when created
+         * dynamically, i.e. its static storage is one byte more.
+         */
+        unique_queue make_unique_queue(UBaseType_t length, UBaseType_t itemSize);
+        unique_sema make_unique_binary_sema();
+        unique_sema make_unique_counting_sema(UBaseType_t maxCount, UBaseType_t initialCount);
+        unique_mutex make_unique_mutex();
+        unique_mutex make_unique_recursive_mutex();
+        unique_timer make_unique_timer(const char * name, TickType_t period, BaseType_t autoReload,
+                                       void * id, TimerCallbackFunction_t callback);
+        unique_event_group make_unique_event_group();
+        unique_stream_buffer make_unique_stream_buffer(size_t size, size_t triggerLevel);
+        unique_message_buffer make_unique_message_buffer(size_t size);
+        unique_task make_unique_task(TaskFunction_t code, const char * name,
+                                     configSTACK_DEPTH_TYPE stackDepth,
+                                     void * parameters, UBaseType_t priority);
+
+        /**
+         * @return the number of kernel objects created with dynamic
+         *         allocation (xQueueCreate, xSemaphoreCreateMutex, xTaskCreate,
+         *         xTimerCreate, etc.), i.e. the number of times the kernel
+         *         would have used its heap. The static creation variants
+         *         never change this count.
+         */
+        uint64_t GetDynamicAllocationCount();
+
+        /**
+         * Reset the simulated FreeRTOS heap (pvPortMalloc/vPortFree),
+         * such that all configTOTAL_HEAP_SIZE bytes are free. Kernel
+         * objects created dynamically are charged against this heap,
+         * with the same overhead as the kernel's heap_4.c.
+         */
+        void HeapInit();
+
+        /**
+         * Reset the simulated FreeRTOS heap. Kernel objects still alive
+         * no longer hold heap blocks, and may be deleted without harm.
+         */
+        void HeapTeardown();
+
+        /**
+         * Create a per test arena, from which the fake kernel objects
+         * (queues, semaphores, mutexes, event groups, stream buffers and
+         * their storage) are allocated, bypassing the global heap and
+         * CppUTest's per allocation leak detection. Leaked kernel objects
+         * are instead reported by KernelObjectTrackingTeardown().
+         */
+        void ArenaInit();
+
+        /**
+         * Release the arena, and all memory allocated from it, in one step.
+         * Kernel objects created from the arena must not be used afterwards.
+         */
+        void ArenaTeardown();
+
+        /**
+         * @return the bytes allocated from the active arena, if any.
+         */
+        size_t GetArenaBytesUsed();
 
     } //namespace test
 } //namespace cms
@@ -24,13 +24,72 @@
 #ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_MUTEX_HPP
 #define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_MUTEX_HPP
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "FreeRTOS.h"
+#include "queue.h"
+
 namespace cms {
 namespace test {
 
+    /**
+     * A higher priority task waiting on a mutex held by
+     * a lower priority task.
+     */
+    struct PriorityInversion
+    {
+        QueueHandle_t mutex;
+        TaskHandle_t holder;
+        UBaseType_t holderPriority;     ///< prior to inheriting the waiter's priority
+        TaskHandle_t waiter;
+        UBaseType_t waiterPriority;
+        std::chrono::nanoseconds start; ///< virtual time
+        std::chrono::nanoseconds duration;
+        bool isActive;                  ///< the holder has not yet given the mutex
+    };
+
+    /**
+     * A potential deadlock: a mutex was taken while holding another
+     * mutex, after the opposite order was already recorded.
+     */
+    struct LockOrderViolation
+    {
+        TaskHandle_t task;    ///< the task taking the mutex, nullptr if none was selected
+        QueueHandle_t taken;
+        QueueHandle_t held;
+        std::vector<QueueHandle_t> cycle; ///< taken -> ... -> held -> taken, as previously recorded
+    };
+
+    /**
+     * Hold time and contention statistics of a mutex, or of all
+     * mutexes sharing a registry name.
+     */
+    struct MutexProfile
+    {
+        uint64_t acquisitions;        ///< successful takes by a non-holder
+        uint64_t failedTakes;         ///< takes which would block or timed out
+        uint64_t maxRecursiveDepth;   ///< 1 for a standard mutex once taken
+        TickType_t maxHoldTicks;      ///< virtual time, in ticks
+        TickType_t totalHoldTicks;
+        std::chrono::nanoseconds maxHoldHostTime;
+        std::chrono::nanoseconds totalHoldHostTime;
+
+        /// recursive mutexes only: the number of takes which reached
+        /// each depth, i.e. [1] is the outermost take.
+        std::map<uint64_t, uint64_t> recursiveDepthHistogram;
+    };
+
     /**
      * Initialize the mutex state tracking,
      * such that this unit test, when Teardown is called,
      * will confirm that all mutexes are unlocked.
+     * While tracking, the order in which each task takes mutexes is
+     * recorded (lockdep style), and taking mutexes in an order that
+     * could deadlock fails the test immediately.
      */
     void MutexTrackingInit();
 
@@ -49,6 +108,40 @@ namespace test {
      */
     bool IsAnyMutexLocked();
 
+    /**
+     * @return the number of mutexes created since MutexTrackingInit
+     *         which have not been deleted.
+     */
+    size_t GetTrackedMutexCount();
+
+    /**
+     * Get all priority inversions detected since MutexTrackingInit.
+     * An inversion starts when a task, selected via SetCurrentTask(),
+     * fails to take (with a non-zero wait) a mutex held by a lower
+     * priority task. It ends when the holder gives or deletes the
+     * mutex, or when the waiter would have timed out, in virtual time.
+     */
+    std::vector<PriorityInversion> GetPriorityInversions();
+
+    /**
+     * @return the longest duration found in GetPriorityInversions().
+     */
+    std::chrono::nanoseconds GetMaxPriorityInversionDuration();
+
+    /**
+     * Get all lock order violations detected since MutexTrackingInit.
+     */
+    std::vector<LockOrderViolation> GetLockOrderViolations();
+
+    /**
+     * Get the hold time and contention profile of each mutex used since
+     * MutexTrackingInit, including mutexes since deleted, keyed by
+     * registry name (see vQueueAddToRegistry). Unregistered mutexes are
+     * keyed by their handle's address. A mutex which is currently held
+     * includes the hold time so far.
+     */
+    std::map<std::string, MutexProfile> GetMutexProfile();
+
 } //namespace
 }//namespace
 
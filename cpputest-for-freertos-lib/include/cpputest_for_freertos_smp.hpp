@@ -0,0 +1,98 @@
+/// @brief Support methods to help with unit testing of code targeting
+///        multi-core (SMP) FreeRTOS builds.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_SMP_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_SMP_HPP
+
+#include <cstdint>
+#include "FreeRTOS.h"
+
+namespace cms {
+namespace test {
+
+    /**
+     * The SMP port locks, see portGET_TASK_LOCK and portGET_ISR_LOCK.
+     */
+    enum class SmpLock
+    {
+        Task,
+        Isr
+    };
+
+    struct SmpLockStats
+    {
+        uint64_t acquisitions;  ///< outermost acquisitions, by any core
+        uint64_t contentions;   ///< acquisitions while another core held the lock
+    };
+
+    /**
+     * Initialize the simulated multi-core (SMP) state. Code executes
+     * on core 0 until SetCurrentCore() is called.
+     */
+    void SmpInit();
+
+    /**
+     * Check and reset the simulated multi-core state. If a port lock
+     * is still held, or was released more often than acquired, then that
+     * is considered a test failure.
+     */
+    void SmpTeardown();
+
+    /**
+     * Select the core which subsequent code under test executes on,
+     * i.e. the value returned by portGET_CORE_ID().
+     * @param core - must be less than configNUMBER_OF_CORES
+     */
+    void SetCurrentCore(BaseType_t core);
+
+    /**
+     * @return the core which code under test is executing on.
+     */
+    BaseType_t GetCurrentCore();
+
+    /**
+     * @return the acquisition and contention counts for the given lock.
+     */
+    SmpLockStats GetSmpLockStats(SmpLock lock);
+
+    /**
+     * @return true: the given core currently holds the given lock.
+     */
+    bool IsSmpLockHeld(SmpLock lock, BaseType_t core);
+
+    /**
+     * @return the number of portYIELD_CORE requests targeting the given core.
+     */
+    uint32_t GetYieldCoreCount(BaseType_t core);
+
+    /**
+     * Used by the fake kernel to acquire and release the port locks,
+     * counting contention when another core holds the lock.
+     */
+    void SmpLockAcquire(SmpLock lock);
+    void SmpLockRelease(SmpLock lock);
+
+} //namespace
+}//namespace
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_SMP_HPP
@@ -0,0 +1,89 @@
+/// @brief Support methods to help with unit testing of FreeRTOS
+///        stream buffers and message buffers.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_STREAM_BUFFER_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_STREAM_BUFFER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "FreeRTOS.h"
+#include "stream_buffer.h"
+
+namespace cms {
+namespace test {
+
+    /**
+     * The bytes currently held by a stream or message buffer, oldest first,
+     * referencing the buffer's own storage. As the storage is a ring, the
+     * bytes may wrap, in which case the remainder is found in the second
+     * region. For message buffers, each message is preceded by its
+     * configMESSAGE_BUFFER_LENGTH_TYPE length, as with the kernel.
+     *
+     * Only valid until the buffer is next modified.
+     */
+    struct StreamBufferContents
+    {
+        const uint8_t * first;
+        size_t firstLength;
+        const uint8_t * second;
+        size_t secondLength;
+
+        size_t size() const { return firstLength + secondLength; }
+        uint8_t operator[](size_t index) const
+        {
+            return (index < firstLength) ? first[index] : second[index - firstLength];
+        }
+    };
+
+    /**
+     * Throughput statistics of a stream or message buffer, since creation.
+     */
+    struct StreamBufferStats
+    {
+        uint64_t sends;                ///< send calls, task or ISR
+        uint64_t bytesSent;            ///< excluding message length prefixes
+        uint64_t bytesDropped;         ///< requested to send, but did not fit
+        uint64_t receives;             ///< receive calls which returned data
+        uint64_t bytesReceived;        ///< excluding message length prefixes
+        size_t maxBytesBuffered;       ///< high water mark, including message length prefixes
+        std::chrono::nanoseconds elapsed; ///< virtual time since creation
+    };
+
+    /**
+     * Inspect the bytes held by a stream or message buffer without
+     * copying or consuming them.
+     * @param buffer
+     */
+    StreamBufferContents GetStreamBufferContents(StreamBufferHandle_t buffer);
+
+    /**
+     * @param buffer
+     * @return the throughput statistics of the stream or message buffer.
+     */
+    StreamBufferStats GetStreamBufferStats(StreamBufferHandle_t buffer);
+
+} //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_STREAM_BUFFER_HPP
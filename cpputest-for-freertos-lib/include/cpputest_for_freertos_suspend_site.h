@@ -0,0 +1,46 @@
+/// @brief Optional, records the __FILE__ and __LINE__ of each vTaskSuspendAll,
+///        for the per call site critical region report. Include this header
+///        after the FreeRTOS headers, or force include it (i.e. -include)
+///        when compiling the code under test. C or C++.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_SUSPEND_SITE_H
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_SUSPEND_SITE_H
+
+/* the kernel's vTaskSuspendAll must be declared before it is wrapped */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the next vTaskSuspendAll is attributed to file and line */
+void cmsSchedulerSuspendSite( const char * file, unsigned long line );
+
+#ifdef __cplusplus
+}
+#endif
+
+#define vTaskSuspendAll()    ( cmsSchedulerSuspendSite( __FILE__, __LINE__ ), vTaskSuspendAll() )
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_SUSPEND_SITE_H
@@ -24,6 +24,10 @@
 #ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TASK_HPP
 #define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TASK_HPP
 
+#include <chrono>
+#include "FreeRTOS.h"
+#include "task.h"
+
 namespace cms {
     namespace test {
 
@@ -38,6 +42,35 @@ namespace cms {
          * related to time.
          */
         void TaskDestroy();
+
+        /**
+         * Get the current virtual (fake kernel) time. Uses the fake
+         * timers' internal time when timers are active, otherwise
+         * the tick count maintained by vTaskDelay and friends.
+         * @return
+         */
+        std::chrono::nanoseconds GetVirtualTime();
+
+        /**
+         * Select the task which the code under test is executing within,
+         * on the current core (see SetCurrentCore()). i.e. the value
+         * returned by xTaskGetCurrentTaskHandle(). The task's core
+         * affinity must permit the current core.
+         * @param task - nullptr when not executing within a task.
+         */
+        void SetCurrentTask(TaskHandle_t task);
+
+        /**
+         * @return the virtual time the given task has been the
+         *         current task, on any core.
+         */
+        std::chrono::nanoseconds GetTaskRunTime(TaskHandle_t task);
+
+        /**
+         * @return the virtual time the given core has been executing
+         *         a task, useful for checking load balance.
+         */
+        std::chrono::nanoseconds GetCoreRunTime(BaseType_t core);
     }
 }
 
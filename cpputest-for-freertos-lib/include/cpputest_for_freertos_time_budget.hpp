@@ -0,0 +1,120 @@
+/// @brief Support methods to help with unit testing of latency requirements,
+///        via scoped virtual time and wall clock budgets.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TIME_BUDGET_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TIME_BUDGET_HPP
+
+#include <chrono>
+#include "FreeRTOS.h"
+
+namespace cms {
+namespace test {
+
+    /**
+     * Scoped virtual time budget. Fails the current test if the code
+     * executed within the scope (service calls, vTaskDelay, xTaskDelayUntil,
+     * timers firing, etc.) moves the fake kernel's time forward by more
+     * than the allowed budget.
+     *
+     * Example:
+     *    {
+     *        cms::test::VirtualTimeBudget budget(pdMS_TO_TICKS(50));
+     *        GiveProcessingTime();
+     *    } //test fails here if more than 50ms of virtual time passed
+     */
+    class VirtualTimeBudget
+    {
+    public:
+        explicit VirtualTimeBudget(TickType_t budget);
+        ~VirtualTimeBudget() noexcept(false);
+
+        VirtualTimeBudget(const VirtualTimeBudget&) = delete;
+        VirtualTimeBudget& operator=(const VirtualTimeBudget&) = delete;
+
+        /**
+         * @return virtual time consumed since this budget was created.
+         */
+        std::chrono::nanoseconds Elapsed() const;
+
+        /**
+         * @return virtual ticks consumed since this budget was created.
+         */
+        TickType_t ElapsedTicks() const;
+
+        /**
+         * @return true: the budget has already been exceeded.
+         */
+        bool IsExceeded() const;
+
+        /**
+         * Check the budget now, failing the test if exceeded.
+         * The budget is not checked again when the scope ends.
+         */
+        void Check();
+
+    private:
+        std::chrono::nanoseconds m_budget;
+        std::chrono::nanoseconds m_start;
+        bool m_checked;
+    };
+
+    /**
+     * Scoped wall clock (host) time budget. Fails the current test if
+     * the code executed within the scope takes longer than the allowed
+     * budget to execute on the host.
+     */
+    class WallClockBudget
+    {
+    public:
+        explicit WallClockBudget(std::chrono::nanoseconds budget);
+        ~WallClockBudget() noexcept(false);
+
+        WallClockBudget(const WallClockBudget&) = delete;
+        WallClockBudget& operator=(const WallClockBudget&) = delete;
+
+        /**
+         * @return host time consumed since this budget was created.
+         */
+        std::chrono::nanoseconds Elapsed() const;
+
+        /**
+         * @return true: the budget has already been exceeded.
+         */
+        bool IsExceeded() const;
+
+        /**
+         * Check the budget now, failing the test if exceeded.
+         * The budget is not checked again when the scope ends.
+         */
+        void Check();
+
+    private:
+        std::chrono::nanoseconds m_budget;
+        std::chrono::steady_clock::time_point m_start;
+        bool m_checked;
+    };
+
+} //namespace
+}//namespace
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TIME_BUDGET_HPP
@@ -0,0 +1,127 @@
+/// @brief Opt-in Chrome Trace Event/Perfetto timeline of a test, in virtual time.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TIMELINE_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TIMELINE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cms {
+namespace test {
+
+    /**
+     * Start recording a timeline of the calling thread's fake kernel,
+     * stamped with virtual time (see GetVirtualTime()):
+     *  - a counter track per queue and semaphore, i.e. its messages waiting,
+     *    named by vQueueAddToRegistry, if registered
+     *  - an "ISR" track of RunInIsrContext executions
+     *  - a "Timers" track of timer fires
+     *  - a track per TimelineSpan name, e.g. a service's ProcessOneEvent
+     *  - a flow from each ISR to the task level receipt of its event
+     * Replaces any prior timeline.
+     * @param file - when not nullptr, TimelineTeardown() saves the
+     *               timeline to this file.
+     */
+    void TimelineInit(const char * file = nullptr);
+
+    /**
+     * Stop recording the timeline, saving it first if TimelineInit()
+     * was given a file.
+     */
+    void TimelineTeardown();
+
+    struct Timeline;
+
+    /**
+     * The timeline of TimelineInit(), nullptr when the timeline is not active.
+     */
+    extern thread_local Timeline * activeTimeline;
+
+    /**
+     * @return true: the timeline is active. Inline, such that a call
+     *         site without a timeline costs one thread local load.
+     */
+    inline bool TimelineIsActive()
+    {
+        return activeTimeline != nullptr;
+    }
+
+    /**
+     * @return the timeline in Chrome Trace Event JSON format, as opened
+     *         by chrome://tracing or https://ui.perfetto.dev
+     */
+    std::string GetTimelineJson();
+
+    /**
+     * An event of the timeline, with its track by name, such that a
+     * unit test may check the timeline without parsing its JSON.
+     */
+    struct TimelineRecord
+    {
+        char phase;                 ///< Chrome Trace Event "ph", e.g. 'B'/'E' of a slice, 's'/'f' of a flow
+        std::chrono::nanoseconds time;
+        std::string track;
+        std::string name;
+        uint64_t value;             ///< counter value, or flow id
+    };
+
+    /**
+     * @return the events recorded since TimelineInit(), in order,
+     *         none when the timeline is not active.
+     */
+    std::vector<TimelineRecord> GetTimelineEvents();
+
+    /**
+     * Write GetTimelineJson() to a file.
+     * @param path
+     * @return true: the file was written.
+     */
+    bool TimelineSave(const char * path);
+
+    /**
+     * Records its own lifetime as a slice of the timeline, on the track
+     * of the same name. Slices of spans nested on the same track nest.
+     * Does nothing when the timeline is not active.
+     *
+     *     cms::test::TimelineSpan span("ButtonService_ProcessOneEvent");
+     *     ButtonService_ProcessOneEvent(EXECUTION_OPTION_UNIT_TEST);
+     */
+    class TimelineSpan
+    {
+    public:
+        explicit TimelineSpan(const char * name);
+        ~TimelineSpan();
+
+        TimelineSpan(const TimelineSpan&) = delete;
+        TimelineSpan& operator=(const TimelineSpan&) = delete;
+
+    private:
+        bool m_recorded;
+    };
+
+} //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TIMELINE_HPP
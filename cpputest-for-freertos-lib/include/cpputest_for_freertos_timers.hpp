@@ -30,6 +30,7 @@ namespace test {
 
     /**
      * Initialize the functional but fake CppUTest for FreeRTOS timers.
+     * The fake timers are only started once the first timer is created.
      */
     void TimersInit();
 
@@ -45,6 +46,12 @@ namespace test {
      */
     bool TimersIsActive();
 
+    /**
+     * @return true: a timer was created since TimersInit(), such that
+     *         the fake timers were started.
+     */
+    bool TimersIsStarted();
+
     /**
      * Move Time Forward.
      * @param duration
@@ -0,0 +1,166 @@
+/// @brief Opt-in binary trace recorder of fake kernel API calls.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TRACE_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cms {
+namespace test {
+
+    enum class TraceOp : uint8_t
+    {
+        QueueSend,         ///< size: item size
+        QueueReceive,      ///< size: item size
+        QueuePeek,         ///< size: item size
+        SemaphoreGive,
+        SemaphoreTake,
+        MutexGive,
+        MutexTake,
+        TimerStart,
+        TimerStop,
+        TimerReset,
+        TimerChangePeriod, ///< size: new period in ticks
+        TimerDelete,
+        TimerFire,
+        TaskDelay,         ///< size: ticks delayed
+        TaskDelayUntil     ///< size: increment in ticks
+    };
+
+    inline const char * TraceOpName(TraceOp op)
+    {
+        switch (op)
+        {
+            case TraceOp::QueueSend:         return "QueueSend";
+            case TraceOp::QueueReceive:      return "QueueReceive";
+            case TraceOp::QueuePeek:         return "QueuePeek";
+            case TraceOp::SemaphoreGive:     return "SemaphoreGive";
+            case TraceOp::SemaphoreTake:     return "SemaphoreTake";
+            case TraceOp::MutexGive:         return "MutexGive";
+            case TraceOp::MutexTake:         return "MutexTake";
+            case TraceOp::TimerStart:        return "TimerStart";
+            case TraceOp::TimerStop:         return "TimerStop";
+            case TraceOp::TimerReset:        return "TimerReset";
+            case TraceOp::TimerChangePeriod: return "TimerChangePeriod";
+            case TraceOp::TimerDelete:       return "TimerDelete";
+            case TraceOp::TimerFire:         return "TimerFire";
+            case TraceOp::TaskDelay:         return "TaskDelay";
+            case TraceOp::TaskDelayUntil:    return "TaskDelayUntil";
+        }
+        return "Unknown";
+    }
+
+    /**
+     * One traced kernel API call. Fixed size, and written as is
+     * to trace files, see TraceFileHeader.
+     */
+    struct TraceRecord
+    {
+        int64_t virtualTime;   ///< ns, see GetVirtualTime()
+        int64_t hostTime;      ///< ns of steady_clock since TraceInit(), 0 when not recorded
+        uint64_t object;       ///< the queue, timer or task handle, 0 when none
+        uint32_t size;         ///< op dependent, see TraceOp
+        TraceOp op;
+        uint8_t result;        ///< pdTRUE/pdFALSE, or pdPASS/pdFAIL
+        uint8_t fromIsr;       ///< 1 when called while in simulated ISR context
+        uint8_t reserved;
+    };
+
+    static_assert(sizeof(TraceRecord) == 32, "trace records are written to files as is");
+
+    /**
+     * A trace file is this header, followed by recordCount TraceRecords,
+     * oldest first, in host byte order.
+     */
+    struct TraceFileHeader
+    {
+        char magic[8];         ///< TRACE_FILE_MAGIC
+        uint32_t version;      ///< TRACE_FILE_VERSION
+        uint32_t recordSize;   ///< sizeof(TraceRecord)
+        uint64_t eventCount;   ///< events traced, including those overwritten
+        uint64_t recordCount;  ///< records following this header
+    };
+
+    static constexpr char TRACE_FILE_MAGIC[8] = {'C', 'M', 'S', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t TRACE_FILE_VERSION = 1;
+
+    /**
+     * Start tracing fake kernel API calls of the calling thread into a
+     * preallocated ring of capacity records (rounded up to a power of two).
+     * Once full, the oldest records are overwritten. Replaces any prior trace.
+     * @param capacity
+     * @param failureFile - when not nullptr, TraceTeardown() saves the
+     *                      trace to this file if the current test failed.
+     * @param hostTime - false: skip reading the host clock, by far the
+     *                   largest cost of recording an event.
+     */
+    void TraceInit(size_t capacity = 65536, const char * failureFile = nullptr,
+                   bool hostTime = true);
+
+    /**
+     * Stop tracing, saving the trace first if the current test
+     * has failed and TraceInit() was given a failure file.
+     */
+    void TraceTeardown();
+
+    struct TraceRing;
+
+    /**
+     * The trace of TraceInit(), nullptr when tracing is not active.
+     */
+    extern thread_local TraceRing * activeTrace;
+
+    /**
+     * @return true: tracing is active. Inline, such that a call site
+     *         not being traced costs one thread local load.
+     */
+    inline bool TraceIsActive()
+    {
+        return activeTrace != nullptr;
+    }
+
+    /**
+     * @return the number of events traced since TraceInit(),
+     *         including those since overwritten.
+     */
+    uint64_t GetTraceEventCount();
+
+    /**
+     * @return the records held by the ring, oldest first.
+     */
+    std::vector<TraceRecord> GetTraceRecords();
+
+    /**
+     * Write the records held by the ring to a trace file, which
+     * may be decoded with the cpputest-for-freertos-trace-decode tool.
+     * @param path
+     * @return true: the file was written.
+     */
+    bool TraceSave(const char * path);
+
+} //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_TRACE_HPP
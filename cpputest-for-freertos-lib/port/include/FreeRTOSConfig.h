@@ -245,7 +245,46 @@
  * or heap_4.c are included in the build.  This value is defaulted to 4096 bytes but
  * it must be tailored to each application.  Note the heap will appear in the .bss
  * section.  See https://www.freertos.org/a00111.html. */
+
+//CMS: the simulated heap, see CMS_FREERTOS_TOTAL_HEAP_SIZE
+//     in the library's CMakeLists.txt
+#ifndef configTOTAL_HEAP_SIZE
 #define configTOTAL_HEAP_SIZE                        4096
+#endif
+
+//CMS: the target's pointer size and heap alignment, which size the simulated
+//     heap's block headers and padding, see CMS_FREERTOS_TARGET_POINTER_SIZE and
+//     CMS_FREERTOS_TARGET_BYTE_ALIGNMENT in the library's CMakeLists.txt.
+//     Both default to the host's. Allocations are aligned for host data either way.
+#ifndef CMS_FREERTOS_TARGET_POINTER_SIZE
+#define CMS_FREERTOS_TARGET_POINTER_SIZE             sizeof(void *)
+#endif
+#ifndef CMS_FREERTOS_TARGET_BYTE_ALIGNMENT
+#define CMS_FREERTOS_TARGET_BYTE_ALIGNMENT           ((portBYTE_ALIGNMENT > sizeof(void *)) ? portBYTE_ALIGNMENT : sizeof(void *))
+#endif
+
+//CMS: the target's sizeof() of each kernel object's control block, and of a
+//     stack word, as charged to the simulated heap and reported by the footprint
+//     report, see CMS_FREERTOS_TARGET_SIZEOF in the library's CMakeLists.txt.
+//     Each defaults to the host's.
+#ifndef CMS_FREERTOS_TARGET_SIZEOF_STATIC_TASK
+#define CMS_FREERTOS_TARGET_SIZEOF_STATIC_TASK          sizeof(StaticTask_t)
+#endif
+#ifndef CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE
+#define CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE         sizeof(StaticQueue_t)
+#endif
+#ifndef CMS_FREERTOS_TARGET_SIZEOF_STATIC_TIMER
+#define CMS_FREERTOS_TARGET_SIZEOF_STATIC_TIMER         sizeof(StaticTimer_t)
+#endif
+#ifndef CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP
+#define CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP   sizeof(StaticEventGroup_t)
+#endif
+#ifndef CMS_FREERTOS_TARGET_SIZEOF_STATIC_STREAM_BUFFER
+#define CMS_FREERTOS_TARGET_SIZEOF_STATIC_STREAM_BUFFER sizeof(StaticStreamBuffer_t)
+#endif
+#ifndef CMS_FREERTOS_TARGET_SIZEOF_STACK_TYPE
+#define CMS_FREERTOS_TARGET_SIZEOF_STACK_TYPE           sizeof(StackType_t)
+#endif
 
 /* Set configAPPLICATION_ALLOCATED_HEAP to 1 to have the application allocate
  * the array used as the FreeRTOS heap.  Set to 0 to have the linker allocate the
@@ -469,9 +508,11 @@ void cmsAssertCalled( const char * pcFile, unsigned long ulLine );
 /* Set configNUMBER_OF_CORES to the number of available processor cores. Defaults
  * to 1 if left undefined. */
 
-/*
- #define configNUMBER_OF_CORES                     [Num of available cores]
- */
+//CMS: provided by the build when simulating a multi-core part,
+//     see CMS_FREERTOS_NUMBER_OF_CORES in the library's CMakeLists.txt
+#ifndef configNUMBER_OF_CORES
+#define configNUMBER_OF_CORES                     1
+#endif
 
 /* When using SMP (i.e. configNUMBER_OF_CORES is greater than one), set
  * configRUN_MULTIPLE_PRIORITIES to 0 to allow multiple tasks to run
@@ -488,7 +529,11 @@ void cmsAssertCalled( const char * pcFile, unsigned long ulLine );
  * APIs can be used to set and retrieve which cores a task can run on. If
  * configUSE_CORE_AFFINITY is set to 0 then the FreeRTOS scheduler is free to
  * run any task on any available core. */
+#if ( configNUMBER_OF_CORES > 1 )
+#define configUSE_CORE_AFFINITY                   1
+#else
 #define configUSE_CORE_AFFINITY                   0
+#endif
 
 /* When using SMP with core affinity feature enabled, set
  * configTASK_DEFAULT_CORE_AFFINITY to change the default core affinity mask for
@@ -609,14 +654,21 @@ void cmsAssertCalled( const char * pcFile, unsigned long ulLine );
 #define INCLUDE_vTaskDelay                     1
 #define INCLUDE_xTaskGetSchedulerState         1
 #define INCLUDE_xTaskGetCurrentTaskHandle      1
+#define INCLUDE_xSemaphoreGetMutexHolder       1
 #define INCLUDE_uxTaskGetStackHighWaterMark    0
 #define INCLUDE_xTaskGetIdleTaskHandle         0
 #define INCLUDE_eTaskGetState                  0
 #define INCLUDE_xEventGroupSetBitFromISR       1
-#define INCLUDE_xTimerPendFunctionCall         0
+#define INCLUDE_xTimerPendFunctionCall         1
 #define INCLUDE_xTaskAbortDelay                0
 #define INCLUDE_xTaskGetHandle                 0
 #define INCLUDE_xTaskResumeFromISR             1
 
+//CMS: the project's trace macros (traceQUEUE_SEND etc.), invoked by
+//     the fakes where the kernel would, see CMS_FREERTOS_TRACE_HOOKS_HEADER
+//     and CMS_FREERTOS_TRACE_HOOKS_INCLUDE_DIR in the library's CMakeLists.txt
+#ifdef CMS_FREERTOS_TRACE_HOOKS_HEADER
+#include CMS_FREERTOS_TRACE_HOOKS_HEADER
+#endif
 
 #endif //CPPUTEST_FOR_FREERTOS_LIB_FREE_RTOS_CONFIG_H
@@ -66,72 +66,107 @@ typedef uint64_t     TickType_t;
 
 #endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 
+/* cpputest-for-freertos: interrupt and critical section hooks, which
+ * track nesting, mismatched exits and the duration of each region.
+ * See cpputest_for_freertos_critical_section.hpp */
+void cmsPortDisableInterrupts( const char * file, unsigned long line );
+void cmsPortEnableInterrupts( const char * file, unsigned long line );
+void cmsPortEnterCritical( const char * file, unsigned long line );
+void cmsPortExitCritical( const char * file, unsigned long line );
+UBaseType_t cmsPortSetInterruptMaskFromIsr( const char * file, unsigned long line );
+void cmsPortClearInterruptMaskFromIsr( UBaseType_t savedStatus, const char * file, unsigned long line );
+
 /* Disable the interrupts */
-#define portDISABLE_INTERRUPTS()    do {} while( 0 )
+#define portDISABLE_INTERRUPTS()    cmsPortDisableInterrupts( __FILE__, __LINE__ )
 
 /* Enable the interrupts */
-#define portENABLE_INTERRUPTS()     do {} while( 0 )
+#define portENABLE_INTERRUPTS()     cmsPortEnableInterrupts( __FILE__, __LINE__ )
+
+/* Mask interrupts from within an ISR, returning the previous mask */
+#define portSET_INTERRUPT_MASK_FROM_ISR()    cmsPortSetInterruptMaskFromIsr( __FILE__, __LINE__ )
+
+/* Restore the interrupt mask previously returned by portSET_INTERRUPT_MASK_FROM_ISR */
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    cmsPortClearInterruptMaskFromIsr( ( x ), __FILE__, __LINE__ )
 
-#if ( configNUMBER_OF_CORES == 1 )
-/* preserve current interrupt state and then disable interrupts */
-#define portENTER_CRITICAL()    do {} while( 0 )
+/* preserve current interrupt state and then disable interrupts.
+ * With configNUMBER_OF_CORES > 1 the hooks also take the TASK and ISR locks,
+ * as vTaskEnterCritical would, tracking the nesting per core. */
+#define portENTER_CRITICAL()    cmsPortEnterCritical( __FILE__, __LINE__ )
 
 /* restore previously preserved interrupt state */
-#define portEXIT_CRITICAL()     do {} while( 0 )
-#else
+#define portEXIT_CRITICAL()     cmsPortExitCritical( __FILE__, __LINE__ )
+
+#if ( configNUMBER_OF_CORES > 1 )
 
 /* The port can maintain the critical nesting count in TCB or maintain the critical
  * nesting count in the port. */
     #define portCRITICAL_NESTING_IN_TCB    1
 
-/* vTaskEnterCritical and vTaskExitCritical should be used in the implementation
- * of portENTER/EXIT_CRITICAL if the number of cores is more than 1 in the system. */
-    #define portENTER_CRITICAL             vTaskEnterCritical
-    #define portEXIT_CRITICAL              vTaskExitCritical
+/* cpputest-for-freertos: SMP hooks, which simulate the current core and
+ * count lock contention between cores.
+ * See cpputest_for_freertos_smp.hpp */
+UBaseType_t cmsPortEnterCriticalFromIsr( const char * file, unsigned long line );
+void cmsPortExitCriticalFromIsr( UBaseType_t savedStatus, const char * file, unsigned long line );
+BaseType_t cmsPortGetCoreId( void );
+void cmsPortYieldCore( BaseType_t core );
+void cmsPortGetTaskLock( void );
+void cmsPortReleaseTaskLock( void );
+void cmsPortGetIsrLock( void );
+void cmsPortReleaseIsrLock( void );
+
+/* Mask interrupts and take the ISR lock from within an ISR */
+    #define portENTER_CRITICAL_FROM_ISR()    cmsPortEnterCriticalFromIsr( __FILE__, __LINE__ )
 
-/* vTaskEnterCriticalFromISR and vTaskExitCriticalFromISR should be used in the
- * implementation of portENTER/EXIT_CRITICAL_FROM_ISR if the number of cores is
- * more than 1 in the system. */
-    #define portENTER_CRITICAL_FROM_ISR    vTaskEnterCriticalFromISR
-    #define portEXIT_CRITICAL_FROM_ISR     vTaskExitCriticalFromISR
+/* Release the ISR lock and restore the interrupt mask */
+    #define portEXIT_CRITICAL_FROM_ISR( x )  cmsPortExitCriticalFromIsr( ( x ), __FILE__, __LINE__ )
 
-#endif /* if ( configNUMBER_OF_CORES == 1 ) */
+#endif /* if ( configNUMBER_OF_CORES > 1 ) */
+
+/* cpputest-for-freertos: simulated interrupt context hooks, which record
+ * a context switch requested from an ISR and report whether the caller is
+ * within cms::test::RunInIsrContext. See cpputest_for_freertos_isr.hpp */
+void cmsPortYieldFromIsr( BaseType_t switchRequired );
+BaseType_t cmsPortCheckIfInIsr( void );
 
 #define portYIELD() do {} while(0)
-#define portYIELD_FROM_ISR(x) do {} while(0)
+#define portYIELD_FROM_ISR( x )       cmsPortYieldFromIsr( ( x ) )
+#define portEND_SWITCHING_ISR( x )    cmsPortYieldFromIsr( ( x ) )
 
 /* Task function macros as described on the FreeRTOS.org WEB site. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters )    void vFunction( void * pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters )          void vFunction( void * pvParameters )
 
 #if ( configNUMBER_OF_CORES > 1 )
-/* Return the core ID on which the code is running. */
-    #define portGET_CORE_ID()                0
+/* Return the core ID on which the code is running, as selected by the unit test. */
+    #define portGET_CORE_ID()                cmsPortGetCoreId()
 
 /* Set the interrupt mask. */
-    #define portSET_INTERRUPT_MASK()         0
+    #define portSET_INTERRUPT_MASK()         cmsPortSetInterruptMaskFromIsr( __FILE__, __LINE__ )
 
 /* Clear the interrupt mask. */
-    #define portCLEAR_INTERRUPT_MASK( x )    ( ( void ) ( x ) )
+    #define portCLEAR_INTERRUPT_MASK( x )    cmsPortClearInterruptMaskFromIsr( ( x ), __FILE__, __LINE__ )
 
 /* Request the core ID x to yield. */
-    #define portYIELD_CORE( x )              do {} while( 0 )
+    #define portYIELD_CORE( x )              cmsPortYieldCore( ( x ) )
 
 /* Acquire the TASK lock. TASK lock is a recursive lock.
  * It should be able to be locked by the same core multiple times. */
-    #define portGET_TASK_LOCK()              do {} while( 0 )
+    #define portGET_TASK_LOCK()              cmsPortGetTaskLock()
 
 /* Release the TASK lock. If a TASK lock is locked by the same core multiple times,
  * it should be released as many times as it is locked. */
-    #define portRELEASE_TASK_LOCK()          do {} while( 0 )
+    #define portRELEASE_TASK_LOCK()          cmsPortReleaseTaskLock()
 
 /* Acquire the ISR lock. ISR lock is a recursive lock.
  * It should be able to be locked by the same core multiple times. */
-    #define portGET_ISR_LOCK()               do {} while( 0 )
+    #define portGET_ISR_LOCK()               cmsPortGetIsrLock()
 
 /* Release the ISR lock. If a ISR lock is locked by the same core multiple times, \
  * it should be released as many times as it is locked. */
-    #define portRELEASE_ISR_LOCK()           do {} while( 0 )
+    #define portRELEASE_ISR_LOCK()           cmsPortReleaseIsrLock()
+
+/* Check if the caller is executing within an interrupt. */
+    #define portCHECK_IF_IN_ISR()            cmsPortCheckIfInIsr()
 
 #endif /* if ( configNUMBER_OF_CORES > 1 ) */
 
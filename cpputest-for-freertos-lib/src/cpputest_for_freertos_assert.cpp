@@ -24,7 +24,15 @@
 #include <cstdio>
 #include "cpputest_for_freertos_assert.hpp"
 
-static bool m_printAssert = true;
+//must be last
+#include "CppUTest/TestHarness.h"
+
+static thread_local bool m_printAssert = true;
+static thread_local bool m_expectArmed = false;
+static thread_local uint32_t m_expectedCount = 0;
+static thread_local uint32_t m_assertCount = 0;
+static thread_local size_t m_captureCapacity = 0;
+static thread_local std::vector<cms::test::AssertRecord> m_captured;
 
 void cms::test::AssertOutputEnable()
 {
@@ -36,11 +44,87 @@ void cms::test::AssertOutputDisable()
     m_printAssert = false;
 }
 
+void cms::test::AssertInit()
+{
+    m_expectArmed = false;
+    m_expectedCount = 0;
+    m_assertCount = 0;
+    m_captureCapacity = 0;
+    m_captured.clear();
+    m_captured.shrink_to_fit();
+}
+
+void cms::test::AssertTeardown()
+{
+    auto armed = m_expectArmed;
+    auto expected = m_expectedCount;
+    auto actual = m_assertCount;
+    AssertInit();
+
+    if (armed && (actual != expected))
+    {
+        auto msg = StringFromFormat("Expected %lu configASSERT failure(s), but %lu occurred.",
+                                    static_cast<unsigned long>(expected),
+                                    static_cast<unsigned long>(actual));
+        FAIL_TEST(msg.asCharString());
+    }
+}
+
+void cms::test::ExpectAssert(uint32_t count)
+{
+    if (!m_expectArmed)
+    {
+        m_expectArmed = true;
+        m_expectedCount = m_assertCount;
+    }
+    m_expectedCount += count;
+}
+
+uint32_t cms::test::AssertCount()
+{
+    return m_assertCount;
+}
+
+void cms::test::AssertCaptureEnable(size_t maxRecords)
+{
+    m_captureCapacity = maxRecords;
+    m_captured.clear();
+    m_captured.reserve(maxRecords);
+}
+
+const std::vector<cms::test::AssertRecord> & cms::test::GetAssertRecords()
+{
+    return m_captured;
+}
+
 extern "C" void cmsAssertCalled( const char * file, unsigned long line )
 {
-    if (m_printAssert)
+    m_assertCount++;
+    if (m_captured.size() < m_captureCapacity)
     {
-        fprintf(stdout, "\n%s(%s:%lu)\n", __FUNCTION__ , file, line);
+        m_captured.push_back({file, line});
+    }
+
+    if (m_expectArmed)
+    {
+        //counters only, no mock bookkeeping or output
+        if (m_assertCount > m_expectedCount)
+        {
+            auto msg = StringFromFormat("Unexpected configASSERT failure at %s:%lu.", file, line);
+            FAIL_TEST(msg.asCharString());
+        }
+    }
+    else
+    {
+        if (m_printAssert)
+        {
+            fprintf(stdout, "\n%s(%s:%lu)\n", __FUNCTION__ , file, line);
+        }
+
+        mock(cms::test::ASSERT_MOCK_NAME)
+                .actualCall(cms::test::ON_ASSERT_FUNC_NAME)
+                .withParameter("file", file)
+                .withParameter("line", line);
     }
 
     // The TEST_EXIT macro used below is throwing an exception.
@@ -53,11 +137,6 @@ extern "C" void cmsAssertCalled( const char * file, unsigned long line )
     //    handler encounters the outermost block of a non-throwing function,
     //    the function std::terminate ... is called ..."
     //
-    mock(cms::test::ASSERT_MOCK_NAME)
-            .actualCall(cms::test::ON_ASSERT_FUNC_NAME)
-            .withParameter("file", file)
-            .withParameter("line", line);
-
     TEST_EXIT;
 
     //help compiler, which doesn't realize that TEST_EXIT is a no-return
@@ -0,0 +1,472 @@
+/// @brief Provides instrumented FreeRTOS critical section, interrupt
+///        disable/enable and scheduler suspension hooks. Tracks nesting
+///        (per core), mismatched exits and the host and virtual duration
+///        of each region, per call site.
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include <array>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "cpputest_for_freertos_critical_section.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_smp.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+
+//must be last
+#include "CppUTest/TestHarness.h"
+
+namespace cms {
+namespace test {
+
+    struct CallSite
+    {
+        CriticalRegionKind kind;
+        const char * file;
+        unsigned long line;
+
+        bool operator<(const CallSite& other) const
+        {
+            if (kind != other.kind)
+            {
+                return kind < other.kind;
+            }
+            if (line != other.line)
+            {
+                return line < other.line;
+            }
+            //__FILE__ may not be pooled across translation units
+            return strcmp(file ? file : "", other.file ? other.file : "") < 0;
+        }
+    };
+
+    struct RegionTracker
+    {
+        uint32_t nesting = 0;
+        CallSite site = {};
+        std::chrono::steady_clock::time_point hostStart = {};
+        std::chrono::nanoseconds virtualStart = {};
+    };
+
+    static constexpr size_t REGION_KIND_COUNT = 5;
+    using CoreTrackers = std::array<RegionTracker, REGION_KIND_COUNT>;
+    static thread_local std::array<CoreTrackers, configNUMBER_OF_CORES> s_trackers = {};
+    static thread_local uint32_t s_mismatchCount = 0;
+    static thread_local bool s_isTracking = false;
+    static thread_local std::map<CallSite, CriticalRegionStats>* s_regionStats = nullptr;
+
+    //set by cpputest_for_freertos_suspend_site.h, for the next vTaskSuspendAll
+    static thread_local const char * s_suspendSiteFile = nullptr;
+    static thread_local unsigned long s_suspendSiteLine = 0;
+
+    static RegionTracker& Tracker(CriticalRegionKind kind, BaseType_t core)
+    {
+        return s_trackers[static_cast<size_t>(core)][static_cast<size_t>(kind)];
+    }
+
+    static RegionTracker& Tracker(CriticalRegionKind kind)
+    {
+        return Tracker(kind, GetCurrentCore());
+    }
+
+    static const char * KindToString(CriticalRegionKind kind)
+    {
+        switch (kind)
+        {
+            case CriticalRegionKind::Critical:
+                return "critical";
+            case CriticalRegionKind::InterruptsDisabled:
+                return "interrupts disabled";
+            case CriticalRegionKind::InterruptMaskFromIsr:
+                return "interrupt mask from ISR";
+            case CriticalRegionKind::SchedulerSuspended:
+                return "scheduler suspended";
+            case CriticalRegionKind::CriticalFromIsr:
+                return "critical from ISR";
+        }
+        return "unknown";
+    }
+
+    static void RegionStarted(RegionTracker& tracker, CriticalRegionKind kind,
+                              const char * file, unsigned long line)
+    {
+        tracker.site = { kind, file, line };
+        tracker.hostStart = std::chrono::steady_clock::now();
+        tracker.virtualStart = GetVirtualTime();
+    }
+
+    static void RegionEnded(RegionTracker& tracker)
+    {
+        if (!s_isTracking)
+        {
+            return;
+        }
+
+        if (s_regionStats == nullptr)
+        {
+            s_regionStats = new std::map<CallSite, CriticalRegionStats>;
+        }
+
+        std::chrono::nanoseconds host = std::chrono::steady_clock::now() - tracker.hostStart;
+        std::chrono::nanoseconds virt = GetVirtualTime() - tracker.virtualStart;
+
+        auto iter = s_regionStats->find(tracker.site);
+        if (iter == s_regionStats->end())
+        {
+            CriticalRegionStats stats = {};
+            stats.kind = tracker.site.kind;
+            stats.file = tracker.site.file;
+            stats.line = tracker.site.line;
+            iter = s_regionStats->emplace(tracker.site, stats).first;
+        }
+
+        auto& stats = iter->second;
+        stats.count++;
+        stats.totalHostDuration += host;
+        stats.maxHostDuration = std::max(stats.maxHostDuration, host);
+        stats.totalVirtualDuration += virt;
+        stats.maxVirtualDuration = std::max(stats.maxVirtualDuration, virt);
+    }
+
+    static void AcquireSmpLocks(CriticalRegionKind kind)
+    {
+#if ( configNUMBER_OF_CORES > 1 )
+        //mirrors the kernel's vTaskEnterCritical, vTaskEnterCriticalFromISR
+        //and vTaskSuspendAll
+        switch (kind)
+        {
+            case CriticalRegionKind::Critical:
+                SmpLockAcquire(SmpLock::Task);
+                SmpLockAcquire(SmpLock::Isr);
+                break;
+            case CriticalRegionKind::CriticalFromIsr:
+                SmpLockAcquire(SmpLock::Isr);
+                break;
+            case CriticalRegionKind::SchedulerSuspended:
+                SmpLockAcquire(SmpLock::Task);
+                break;
+            default:
+                break;
+        }
+#else
+        (void)kind;
+#endif
+    }
+
+    static void ReleaseSmpLocks(CriticalRegionKind kind)
+    {
+#if ( configNUMBER_OF_CORES > 1 )
+        switch (kind)
+        {
+            case CriticalRegionKind::Critical:
+                SmpLockRelease(SmpLock::Isr);
+                SmpLockRelease(SmpLock::Task);
+                break;
+            case CriticalRegionKind::CriticalFromIsr:
+                SmpLockRelease(SmpLock::Isr);
+                break;
+            case CriticalRegionKind::SchedulerSuspended:
+                SmpLockRelease(SmpLock::Task);
+                break;
+            default:
+                break;
+        }
+#else
+        (void)kind;
+#endif
+    }
+
+    static void EnterNested(CriticalRegionKind kind, const char * file, unsigned long line)
+    {
+        auto& tracker = Tracker(kind);
+        if (tracker.nesting == 0)
+        {
+            AcquireSmpLocks(kind);
+            RegionStarted(tracker, kind, file, line);
+        }
+        tracker.nesting++;
+    }
+
+    static void ExitNested(CriticalRegionKind kind)
+    {
+        auto& tracker = Tracker(kind);
+        if (tracker.nesting == 0)
+        {
+            s_mismatchCount++;
+            return;
+        }
+
+        tracker.nesting--;
+        if (tracker.nesting == 0)
+        {
+            RegionEnded(tracker);
+            ReleaseSmpLocks(kind);
+        }
+    }
+
+    static void ResetTrackers()
+    {
+        s_trackers = {};
+        s_mismatchCount = 0;
+    }
+
+    static void ReleaseRegionStats()
+    {
+        delete s_regionStats;
+        s_regionStats = nullptr;
+    }
+
+    void CriticalSectionTrackingInit()
+    {
+        //i.e. discard the state of a teardown skipped by an earlier failure
+        ResetTrackers();
+        ReleaseRegionStats();
+        s_isTracking = true;
+    }
+
+    void CriticalSectionTrackingTeardown()
+    {
+        bool isAnyActive = false;
+        for (const auto& coreTrackers : s_trackers)
+        {
+            isAnyActive |= std::any_of(coreTrackers.begin(), coreTrackers.end(), [](const RegionTracker& tracker)
+            {
+                return tracker.nesting != 0;
+            });
+        }
+        auto mismatches = s_mismatchCount;
+
+        ResetTrackers();
+        s_isTracking = false;
+        ReleaseRegionStats();
+
+        if (isAnyActive)
+        {
+            FAIL_TEST("A critical section, interrupt disable or scheduler suspension is still active.");
+        }
+
+        if (mismatches != 0)
+        {
+            FAIL_TEST("A critical section, interrupt mask or scheduler suspension was exited without a matching entry.");
+        }
+    }
+
+    uint32_t GetCriticalNesting()
+    {
+        return Tracker(CriticalRegionKind::Critical).nesting;
+    }
+
+    bool AreInterruptsDisabled()
+    {
+        return (Tracker(CriticalRegionKind::Critical).nesting != 0) ||
+               (Tracker(CriticalRegionKind::InterruptsDisabled).nesting != 0) ||
+               (Tracker(CriticalRegionKind::InterruptMaskFromIsr).nesting != 0) ||
+               (Tracker(CriticalRegionKind::CriticalFromIsr).nesting != 0);
+    }
+
+    bool IsSchedulerSuspended()
+    {
+        //scheduler suspension applies to all cores
+        for (BaseType_t core = 0; core < configNUMBER_OF_CORES; ++core)
+        {
+            if (Tracker(CriticalRegionKind::SchedulerSuspended, core).nesting != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t GetCriticalMismatchCount()
+    {
+        return s_mismatchCount;
+    }
+
+    std::vector<CriticalRegionStats> GetCriticalRegionReport()
+    {
+        std::vector<CriticalRegionStats> report;
+        if (s_regionStats == nullptr)
+        {
+            return report;
+        }
+
+        for (const auto& entry : *s_regionStats)
+        {
+            report.push_back(entry.second);
+        }
+
+        std::sort(report.begin(), report.end(), [](const CriticalRegionStats& a, const CriticalRegionStats& b)
+        {
+            return a.maxHostDuration > b.maxHostDuration;
+        });
+
+        return report;
+    }
+
+    void PrintCriticalRegionReport(size_t maxEntries)
+    {
+        auto report = GetCriticalRegionReport();
+        fprintf(stdout, "\nLongest critical regions:\n");
+        for (size_t i = 0; (i < report.size()) && (i < maxEntries); ++i)
+        {
+            const auto& stats = report[i];
+            fprintf(stdout, "  %s(%lu) %s: count=%llu host max=%lld ns total=%lld ns, virtual max=%lld ns total=%lld ns\n",
+                    stats.file ? stats.file : "<unknown>", stats.line,
+                    KindToString(stats.kind),
+                    static_cast<unsigned long long>(stats.count),
+                    static_cast<long long>(stats.maxHostDuration.count()),
+                    static_cast<long long>(stats.totalHostDuration.count()),
+                    static_cast<long long>(stats.maxVirtualDuration.count()),
+                    static_cast<long long>(stats.totalVirtualDuration.count()));
+        }
+    }
+
+} //namespace test
+} //namespace cms
+
+using namespace cms::test;
+
+extern "C" void cmsPortEnterCritical(const char * file, unsigned long line)
+{
+    //ISRs must use portENTER_CRITICAL_FROM_ISR/portSET_INTERRUPT_MASK_FROM_ISR
+    configASSERT(!cms::test::IsInIsrContext());
+    EnterNested(CriticalRegionKind::Critical, file, line);
+}
+
+extern "C" void cmsPortExitCritical(const char * file, unsigned long line)
+{
+    (void)file;
+    (void)line;
+    ExitNested(CriticalRegionKind::Critical);
+}
+
+extern "C" void cmsPortDisableInterrupts(const char * file, unsigned long line)
+{
+    //interrupt disable does not nest, repeated disables are the same region
+    auto& tracker = Tracker(CriticalRegionKind::InterruptsDisabled);
+    if (tracker.nesting == 0)
+    {
+        RegionStarted(tracker, CriticalRegionKind::InterruptsDisabled, file, line);
+        tracker.nesting = 1;
+    }
+}
+
+extern "C" void cmsPortEnableInterrupts(const char * file, unsigned long line)
+{
+    (void)file;
+    (void)line;
+
+    //enabling already enabled interrupts is legal, not a mismatch
+    auto& tracker = Tracker(CriticalRegionKind::InterruptsDisabled);
+    if (tracker.nesting != 0)
+    {
+        tracker.nesting = 0;
+        RegionEnded(tracker);
+    }
+}
+
+extern "C" UBaseType_t cmsPortSetInterruptMaskFromIsr(const char * file, unsigned long line)
+{
+    auto previous = Tracker(CriticalRegionKind::InterruptMaskFromIsr).nesting;
+    EnterNested(CriticalRegionKind::InterruptMaskFromIsr, file, line);
+    return static_cast<UBaseType_t>(previous);
+}
+
+extern "C" void cmsPortClearInterruptMaskFromIsr(UBaseType_t savedStatus, const char * file, unsigned long line)
+{
+    (void)file;
+    (void)line;
+
+    auto& tracker = Tracker(CriticalRegionKind::InterruptMaskFromIsr);
+    if ((tracker.nesting != 0) && (savedStatus != static_cast<UBaseType_t>(tracker.nesting - 1)))
+    {
+        //restoring a mask other than the one returned by the matching set
+        s_mismatchCount++;
+    }
+
+    ExitNested(CriticalRegionKind::InterruptMaskFromIsr);
+}
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+extern "C" UBaseType_t cmsPortEnterCriticalFromIsr(const char * file, unsigned long line)
+{
+    auto previous = Tracker(CriticalRegionKind::CriticalFromIsr).nesting;
+    EnterNested(CriticalRegionKind::CriticalFromIsr, file, line);
+    return static_cast<UBaseType_t>(previous);
+}
+
+extern "C" void cmsPortExitCriticalFromIsr(UBaseType_t savedStatus, const char * file, unsigned long line)
+{
+    (void)file;
+    (void)line;
+
+    auto& tracker = Tracker(CriticalRegionKind::CriticalFromIsr);
+    if ((tracker.nesting != 0) && (savedStatus != static_cast<UBaseType_t>(tracker.nesting - 1)))
+    {
+        s_mismatchCount++;
+    }
+
+    ExitNested(CriticalRegionKind::CriticalFromIsr);
+}
+
+#endif /* if ( configNUMBER_OF_CORES > 1 ) */
+
+extern "C" void cmsSchedulerSuspendSite(const char * file, unsigned long line)
+{
+    s_suspendSiteFile = file;
+    s_suspendSiteLine = line;
+}
+
+extern "C" void vTaskSuspendAll(void)
+{
+    auto file = s_suspendSiteFile;
+    auto line = s_suspendSiteLine;
+    s_suspendSiteFile = nullptr;
+    s_suspendSiteLine = 0;
+
+    configASSERT(!cms::test::IsInIsrContext());
+    EnterNested(CriticalRegionKind::SchedulerSuspended, file, line);
+}
+
+extern "C" BaseType_t xTaskResumeAll(void)
+{
+    ExitNested(CriticalRegionKind::SchedulerSuspended);
+
+    //the fake never has a pending context switch to perform
+    return pdFALSE;
+}
+
+extern "C" BaseType_t xTaskGetSchedulerState(void)
+{
+    if (IsSchedulerSuspended())
+    {
+        return taskSCHEDULER_SUSPENDED;
+    }
+
+    return taskSCHEDULER_RUNNING;
+}
@@ -0,0 +1,247 @@
+/// @brief Provides an implementation of a fake FreeRTOS event group.
+///        cpputest-for-freertos-lib assumes that an event group should be
+///        functional, i.e. not a mock. No blocking is implemented.
+///
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+
+#include <new>
+#include "cpputest_for_freertos_fake_isr.hpp"
+#include "cpputest_for_freertos_fake_memory.hpp"
+#include "cpputest_for_freertos_fake_kernel_objects.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "FreeRTOS.h"
+#include "event_groups.h"
+
+#ifndef eventEVENT_BITS_CONTROL_BYTES
+    //the upper byte of EventBits_t is reserved for the kernel's own use
+    #define eventEVENT_BITS_CONTROL_BYTES (static_cast<EventBits_t>(0xffU) << ((sizeof(EventBits_t) - 1U) * 8U))
+#endif
+
+typedef struct EventGroupDef_t
+{
+    EventBits_t bits = {};
+    bool isStatic = false; ///< control block was provided by the caller
+    cms::test::HeapCharge heapCharge;
+} FakeEventGroup;
+
+static_assert(sizeof(FakeEventGroup) <= sizeof(StaticEventGroup_t),
+              "the fake event group must fit within the caller's StaticEventGroup_t");
+static_assert(alignof(FakeEventGroup) <= alignof(StaticEventGroup_t),
+              "the fake event group must be aligned as StaticEventGroup_t");
+
+static bool AreBitsSatisfied(EventBits_t current, EventBits_t bitsToWaitFor, bool waitForAll)
+{
+    if (waitForAll)
+    {
+        return (current & bitsToWaitFor) == bitsToWaitFor;
+    }
+
+    return (current & bitsToWaitFor) != 0;
+}
+
+static EventBits_t SetBits(FakeEventGroup * group, const EventBits_t bitsToSet)
+{
+    configASSERT(group != nullptr);
+    configASSERT((bitsToSet & eventEVENT_BITS_CONTROL_BYTES) == 0);
+    traceEVENT_GROUP_SET_BITS(group, bitsToSet);
+
+    group->bits |= bitsToSet;
+    cms::test::IsrEventPosted(group);
+    return group->bits;
+}
+
+static EventBits_t ClearBits(FakeEventGroup * group, const EventBits_t bitsToClear)
+{
+    configASSERT(group != nullptr);
+    configASSERT((bitsToClear & eventEVENT_BITS_CONTROL_BYTES) == 0);
+    traceEVENT_GROUP_CLEAR_BITS(group, bitsToClear);
+
+    auto previous = group->bits;
+    group->bits &= ~bitsToClear;
+    return previous;
+}
+
+extern "C" EventGroupHandle_t xEventGroupCreate(void)
+{
+    auto charge = cms::test::ChargeHeap(CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP);
+    if (charge.block == nullptr)
+    {
+        traceEVENT_GROUP_CREATE_FAILED();
+        cms::test::KernelObjectCreated(cms::test::KernelObjectKind::EventGroup, nullptr, CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP);
+        return nullptr;
+    }
+    cms::test::DynamicAllocationMade();
+
+    auto group = cms::test::ArenaNew<FakeEventGroup>();
+    group->heapCharge = charge;
+    traceEVENT_GROUP_CREATE(group);
+    cms::test::KernelObjectCreated(cms::test::KernelObjectKind::EventGroup, group, CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP);
+    return group;
+}
+
+extern "C" EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t * pxEventGroupBuffer)
+{
+    configASSERT(pxEventGroupBuffer != nullptr);
+
+    //as with the kernel, the control block lives in the caller's buffer
+    auto group = new (pxEventGroupBuffer) FakeEventGroup();
+    group->isStatic = true;
+    traceEVENT_GROUP_CREATE(group);
+    cms::test::StaticKernelObjectCreated(cms::test::KernelObjectKind::EventGroup, group, CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP);
+    return group;
+}
+
+extern "C" BaseType_t xEventGroupGetStaticBuffer(EventGroupHandle_t xEventGroup,
+                                                 StaticEventGroup_t ** ppxEventGroupBuffer)
+{
+    configASSERT(xEventGroup != nullptr);
+    configASSERT(ppxEventGroupBuffer != nullptr);
+
+    if (!xEventGroup->isStatic)
+    {
+        return pdFALSE;
+    }
+
+    *ppxEventGroupBuffer = reinterpret_cast<StaticEventGroup_t *>(xEventGroup);
+    return pdTRUE;
+}
+
+extern "C" void vEventGroupDelete(EventGroupHandle_t xEventGroup)
+{
+    configASSERT(xEventGroup != nullptr);
+    traceEVENT_GROUP_DELETE(xEventGroup);
+    cms::test::IsrObjectDeleted(xEventGroup);
+    cms::test::KernelObjectDeleted(xEventGroup);
+    if (xEventGroup->isStatic)
+    {
+        xEventGroup->~EventGroupDef_t();
+    }
+    else
+    {
+        cms::test::ReleaseHeap(xEventGroup->heapCharge);
+        cms::test::ArenaDelete(xEventGroup);
+    }
+}
+
+extern "C" EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup,
+                                           const EventBits_t uxBitsToWaitFor,
+                                           const BaseType_t xClearOnExit,
+                                           const BaseType_t xWaitForAllBits,
+                                           TickType_t xTicksToWait)
+{
+    configASSERT(xEventGroup != nullptr);
+    configASSERT(uxBitsToWaitFor != 0);
+    configASSERT((uxBitsToWaitFor & eventEVENT_BITS_CONTROL_BYTES) == 0);
+    configASSERT(!cms::test::IsInIsrContext());
+
+    (void)xTicksToWait; //in our unit testing fake, never honor ticks to wait.
+
+    //as with the kernel, return the bits as they were when the wait
+    //condition was met (or not), prior to any clear on exit.
+    auto current = xEventGroup->bits;
+    auto isSatisfied = AreBitsSatisfied(current, uxBitsToWaitFor, xWaitForAllBits != pdFALSE);
+    if (isSatisfied)
+    {
+        if (xClearOnExit != pdFALSE)
+        {
+            xEventGroup->bits &= ~uxBitsToWaitFor;
+        }
+        cms::test::IsrEventReceived(xEventGroup);
+    }
+
+    //the wait ends at once, having timed out if not satisfied
+    traceEVENT_GROUP_WAIT_BITS_END(xEventGroup, uxBitsToWaitFor, isSatisfied ? pdFALSE : pdTRUE);
+    return current;
+}
+
+extern "C" EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+    return SetBits(xEventGroup, uxBitsToSet);
+}
+
+extern "C" EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+    return ClearBits(xEventGroup, uxBitsToClear);
+}
+
+extern "C" EventBits_t xEventGroupGetBitsFromISR(EventGroupHandle_t xEventGroup)
+{
+    configASSERT(xEventGroup != nullptr);
+    return xEventGroup->bits;
+}
+
+extern "C" EventBits_t xEventGroupSync(EventGroupHandle_t xEventGroup,
+                                       const EventBits_t uxBitsToSet,
+                                       const EventBits_t uxBitsToWaitFor,
+                                       TickType_t xTicksToWait)
+{
+    configASSERT(xEventGroup != nullptr);
+    configASSERT(uxBitsToWaitFor != 0);
+    configASSERT((uxBitsToWaitFor & eventEVENT_BITS_CONTROL_BYTES) == 0);
+    configASSERT(!cms::test::IsInIsrContext());
+
+    (void)xTicksToWait; //in our unit testing fake, never honor ticks to wait.
+
+    auto current = SetBits(xEventGroup, uxBitsToSet);
+    auto isSatisfied = AreBitsSatisfied(current, uxBitsToWaitFor, true);
+    if (isSatisfied)
+    {
+        //the rendezvous is complete, all tasks leave it with the bits cleared
+        xEventGroup->bits &= ~uxBitsToWaitFor;
+        cms::test::IsrEventReceived(xEventGroup);
+    }
+
+    traceEVENT_GROUP_SYNC_END(xEventGroup, uxBitsToSet, uxBitsToWaitFor, isSatisfied ? pdFALSE : pdTRUE);
+    return current;
+}
+
+extern "C" void vEventGroupSetBitsCallback(void * pvEventGroup, uint32_t ulBitsToSet)
+{
+    SetBits(static_cast<FakeEventGroup *>(pvEventGroup), ulBitsToSet);
+}
+
+extern "C" void vEventGroupClearBitsCallback(void * pvEventGroup, uint32_t ulBitsToClear)
+{
+    ClearBits(static_cast<FakeEventGroup *>(pvEventGroup), ulBitsToClear);
+}
+
+#if (configUSE_TRACE_FACILITY == 1)
+extern "C" BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t xEventGroup,
+                                                const EventBits_t uxBitsToSet,
+                                                BaseType_t * pxHigherPriorityTaskWoken)
+{
+    traceEVENT_GROUP_SET_BITS_FROM_ISR(xEventGroup, uxBitsToSet);
+    return xTimerPendFunctionCallFromISR(vEventGroupSetBitsCallback, xEventGroup,
+                                         static_cast<uint32_t>(uxBitsToSet), pxHigherPriorityTaskWoken);
+}
+
+extern "C" BaseType_t xEventGroupClearBitsFromISR(EventGroupHandle_t xEventGroup,
+                                                  const EventBits_t uxBitsToClear)
+{
+    traceEVENT_GROUP_CLEAR_BITS_FROM_ISR(xEventGroup, uxBitsToClear);
+    return xTimerPendFunctionCallFromISR(vEventGroupClearBitsCallback, xEventGroup,
+                                         static_cast<uint32_t>(uxBitsToClear), nullptr);
+}
+#endif
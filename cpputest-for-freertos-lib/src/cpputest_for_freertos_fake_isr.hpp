@@ -0,0 +1,18 @@
+
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_ISR_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_ISR_HPP
+
+namespace cms {
+    namespace test {
+        /**
+         * ISR to task latency accounting. Kernel objects report an event
+         * posted from ISR context, the receipt of an event by task
+         * level code, and their own deletion.
+         */
+        void IsrEventPosted(const void * object);
+        void IsrEventReceived(const void * object);
+        void IsrObjectDeleted(const void * object);
+    } //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_ISR_HPP
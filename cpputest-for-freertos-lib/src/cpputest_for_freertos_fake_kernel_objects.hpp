@@ -0,0 +1,23 @@
+
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_KERNEL_OBJECTS_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_KERNEL_OBJECTS_HPP
+
+#include "cpputest_for_freertos_kernel_objects.hpp"
+
+namespace cms {
+    namespace test {
+        /**
+         * Each dynamic creation attempt reports its result, nullptr
+         * if the attempt failed, consuming any pending creation site.
+         * The footprint is the object's target RAM, see FootprintReport.
+         */
+        void KernelObjectCreated(KernelObjectKind kind, const void * handle, size_t footprint,
+                                 const char * name = nullptr);
+        void StaticKernelObjectCreated(KernelObjectKind kind, const void * handle, size_t footprint,
+                                       const char * name = nullptr);
+        void KernelObjectNamed(const void * handle, const char * name);
+        void KernelObjectDeleted(const void * handle);
+    } //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_KERNEL_OBJECTS_HPP
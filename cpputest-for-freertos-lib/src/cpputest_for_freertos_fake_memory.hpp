@@ -0,0 +1,73 @@
+
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_MEMORY_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace cms {
+    namespace test {
+        /**
+         * Kernel objects report each creation which, on target,
+         * would have allocated from the FreeRTOS heap.
+         */
+        void DynamicAllocationMade();
+
+        /**
+         * A block of the simulated FreeRTOS heap, held on behalf of
+         * a dynamically created kernel object.
+         */
+        struct HeapCharge
+        {
+            void * block = nullptr;
+            uint32_t generation = 0;
+        };
+
+        /**
+         * Allocate from the simulated FreeRTOS heap the bytes which
+         * the kernel would have allocated for an object.
+         * @return block is nullptr if the heap is exhausted.
+         */
+        HeapCharge ChargeHeap(size_t bytes);
+
+        /**
+         * Return a charge to the simulated FreeRTOS heap. Charges made
+         * before the heap was last reset are ignored.
+         */
+        void ReleaseHeap(HeapCharge & charge);
+
+        /**
+         * Allocate from the per test arena, if ArenaInit is active,
+         * otherwise from the global heap.
+         */
+        void * ArenaAllocate(size_t bytes, size_t alignment);
+
+        /**
+         * Return memory from ArenaAllocate. Memory within the active
+         * arena is only reclaimed when the arena is released. An arena
+         * is released only in part while objects remain within it, such
+         * that an object deleted after ArenaTeardown() is still readable.
+         */
+        void ArenaFree(void * memory);
+
+        template <typename T, typename... Args>
+        T * ArenaNew(Args&&... args)
+        {
+            return new (ArenaAllocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        template <typename T>
+        void ArenaDelete(T * object)
+        {
+            if (object != nullptr)
+            {
+                object->~T();
+                ArenaFree(object);
+            }
+        }
+    } //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_MEMORY_HPP
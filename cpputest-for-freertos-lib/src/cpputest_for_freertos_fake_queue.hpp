@@ -2,24 +2,46 @@
 #ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_QUEUE_HPP
 #define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_QUEUE_HPP
 
-#include <deque>
-#include <vector>
+#include <cstdint>
 #include "FreeRTOS.h"
+#include "task.h"
+#include "cpputest_for_freertos_fake_memory.hpp"
 
 typedef struct QueueDefinition
 {
     UBaseType_t queueLength = {};
     UBaseType_t itemSize = {};
     uint8_t queueType = {};
-    std::deque<std::vector<uint8_t>> queue = {};
+    uint8_t * storage = nullptr;      ///< ring buffer of queueLength items, none when itemSize is zero
+    UBaseType_t head = {};            ///< index of the oldest item
+    UBaseType_t messagesWaiting = {}; ///< items, or available tokens for semaphores and mutexes
+    bool isStatic = false;            ///< control block and storage were provided by the caller
+    cms::test::HeapCharge heapCharge; ///< the kernel's allocation, when created dynamically
     uint64_t recursiveCallCount = {};
     const char * registryName = nullptr;
     struct QueueDefinition * queueSetContainer = nullptr;
+    TaskHandle_t mutexHolder = nullptr;
+
+    //intrusive mutex tracking, see cpputest_for_freertos_mutex.cpp
+    uint32_t mutexTrackingSession = 0;
+    struct QueueDefinition * trackedPrev = nullptr;
+    struct QueueDefinition * trackedNext = nullptr;
 } FakeQueue;
 
 namespace cms {
     BaseType_t InternalQueueReceive(FakeQueue *queue, void * const buffer);
     BaseType_t InternalQueueReceive(FakeQueue *queue);
+    BaseType_t InternalQueueSend(FakeQueue *queue, const void * const itemToQueue,
+                                 const BaseType_t copyPosition);
+
+    namespace test {
+        bool IsMutex(const FakeQueue * queue);
+        void MutexAboutToDelete(FakeQueue * mutex);
+        void MutexTaken(FakeQueue * mutex);
+        void MutexGiven(FakeQueue * mutex);
+        void MutexTakeFailed(FakeQueue * mutex, TickType_t ticks);
+        void MutexRecursiveDepth(FakeQueue * mutex);
+    } //namespace test
 } //namespace cms
 
 #endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_QUEUE_HPP
@@ -0,0 +1,38 @@
+
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TASK_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TASK_HPP
+
+#include <chrono>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cpputest_for_freertos_fake_memory.hpp"
+
+//fake task control block
+typedef struct tskTaskControlBlock
+{
+    bool inUse;
+    TaskFunction_t code;
+    char name[configMAX_TASK_NAME_LEN];
+    void * parameters;
+    UBaseType_t priority;
+    UBaseType_t basePriority;
+    UBaseType_t mutexesHeld;
+    UBaseType_t coreAffinityMask;
+    std::chrono::nanoseconds runTime;
+    cms::test::HeapCharge stackCharge; ///< the kernel's allocations, when created dynamically
+    cms::test::HeapCharge tcbCharge;
+} FakeTask;
+
+namespace cms {
+    namespace test {
+        /**
+         * Mutex priority inheritance, see xTaskPriorityInherit
+         * and xTaskPriorityDisinherit in the FreeRTOS kernel.
+         */
+        void TaskMutexTaken(FakeTask * holder);
+        void TaskMutexGiven(FakeTask * holder);
+        void TaskPriorityInherit(FakeTask * holder, UBaseType_t priority);
+    } //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TASK_HPP
@@ -0,0 +1,24 @@
+
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TIMELINE_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TIMELINE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include "cpputest_for_freertos_timeline.hpp"
+
+namespace cms {
+    namespace test {
+        /**
+         * Timeline events reported by the fake kernel objects. Each
+         * returns at once when the timeline is not active, a call site
+         * which computes its arguments tests TimelineIsActive() first.
+         */
+        void TimelineQueueLevel(const void * queue, const char * name, uint32_t messagesWaiting);
+        void TimelineTimerFired(const char * name);
+        void TimelineIsrEntered();
+        void TimelineIsrExited();
+        void TimelineIsrEventReceived(std::chrono::nanoseconds isrEntry);
+    } //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TIMELINE_HPP
@@ -0,0 +1,31 @@
+
+#ifndef CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TRACE_HPP
+#define CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TRACE_HPP
+
+#include <cstdint>
+#include "cpputest_for_freertos_trace.hpp"
+
+namespace cms {
+    namespace test {
+        /**
+         * Record a kernel API call to the active trace.
+         */
+        void TraceRecordEvent(TraceRing & trace, TraceOp op, const void * object, uint32_t size, int32_t result);
+
+        /**
+         * Record a kernel API call, if tracing is active. The arguments
+         * are evaluated regardless, so a call site which computes them,
+         * e.g. with xTaskGetCurrentTaskHandle(), tests TraceIsActive() first.
+         */
+        inline void TraceEvent(TraceOp op, const void * object, uint32_t size, int32_t result)
+        {
+            auto trace = activeTrace;
+            if (trace != nullptr)
+            {
+                TraceRecordEvent(*trace, op, object, size, result);
+            }
+        }
+    } //namespace test
+} //namespace cms
+
+#endif //CPPUTEST_FOR_FREERTOS_LIB_CPPUTEST_FOR_FREERTOS_FAKE_TRACE_HPP
@@ -0,0 +1,454 @@
+/// @brief Provides a simulated FreeRTOS heap, following the first fit,
+///        coalescing algorithm and block overheads of the kernel's heap_4.c,
+///        within an array of configTOTAL_HEAP_SIZE bytes. Fake kernel
+///        objects created dynamically are charged against the same heap.
+///
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_fake_memory.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "FreeRTOS.h"
+#include "portable.h"
+
+//the target's alignment and size_t, see CMS_FREERTOS_TARGET_POINTER_SIZE
+//in FreeRTOSConfig.h, such that block headers and padding are the target's
+#define heapBYTE_ALIGNMENT        ((size_t)CMS_FREERTOS_TARGET_BYTE_ALIGNMENT)
+#define heapBYTE_ALIGNMENT_MASK   (heapBYTE_ALIGNMENT - 1)
+
+typedef std::conditional<(CMS_FREERTOS_TARGET_POINTER_SIZE) == 2, uint16_t,
+        std::conditional<(CMS_FREERTOS_TARGET_POINTER_SIZE) == 4, uint32_t, uint64_t>::type>::type heapTargetSize_t;
+
+static_assert(sizeof(heapTargetSize_t) == (CMS_FREERTOS_TARGET_POINTER_SIZE),
+              "CMS_FREERTOS_TARGET_POINTER_SIZE must be 2, 4 or 8");
+static_assert((heapBYTE_ALIGNMENT & heapBYTE_ALIGNMENT_MASK) == 0,
+              "CMS_FREERTOS_TARGET_BYTE_ALIGNMENT must be a power of two");
+static_assert(heapBYTE_ALIGNMENT >= alignof(heapTargetSize_t),
+              "CMS_FREERTOS_TARGET_BYTE_ALIGNMENT must be at least CMS_FREERTOS_TARGET_POINTER_SIZE");
+
+#define heapMINIMUM_BLOCK_SIZE    ((size_t)(s_heapStructSize << 1))
+#define heapBITS_PER_BYTE         ((size_t)8)
+#define heapSIZE_MAX              ((size_t)(~((heapTargetSize_t)0)))
+#define heapADD_WILL_OVERFLOW(a, b)          ((a) > (heapSIZE_MAX - (b)))
+#define heapMULTIPLY_WILL_OVERFLOW(a, b)     (((a) > 0) && ((b) > (heapSIZE_MAX / (a))))
+#define heapSUBTRACT_WILL_UNDERFLOW(a, b)    ((a) < (b))
+
+//the top bit of a block's size marks it as allocated
+#define heapBLOCK_ALLOCATED_BITMASK          (((size_t)1) << ((sizeof(heapTargetSize_t) * heapBITS_PER_BYTE) - 1))
+#define heapBLOCK_SIZE_IS_VALID(xBlockSize)  (((xBlockSize) & heapBLOCK_ALLOCATED_BITMASK) == 0)
+#define heapBLOCK_IS_ALLOCATED(pxBlock)      (((pxBlock->xBlockSize) & heapBLOCK_ALLOCATED_BITMASK) != 0)
+#define heapALLOCATE_BLOCK(pxBlock)          ((pxBlock->xBlockSize) |= heapBLOCK_ALLOCATED_BITMASK)
+#define heapFREE_BLOCK(pxBlock)              ((pxBlock->xBlockSize) &= (heapTargetSize_t)~heapBLOCK_ALLOCATED_BITMASK)
+
+#if (configAPPLICATION_ALLOCATED_HEAP == 1)
+    extern "C" uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#else
+    static thread_local uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#endif
+
+#if (configUSE_MALLOC_FAILED_HOOK == 1)
+    extern "C" void vApplicationMallocFailedHook(void);
+#endif
+
+namespace cms {
+namespace test {
+
+    //as heap_4's, with the next free block held as the target's pointer
+    //would be, i.e. an offset within ucHeap, heapNO_BLOCK for NULL
+    typedef struct A_BLOCK_LINK
+    {
+        heapTargetSize_t xNextFreeBlock;
+        heapTargetSize_t xBlockSize;
+    } BlockLink_t;
+
+    static const heapTargetSize_t heapNO_BLOCK = static_cast<heapTargetSize_t>(~static_cast<heapTargetSize_t>(0));
+
+    static BlockLink_t * NextFreeBlock(const BlockLink_t * block)
+    {
+        return (block->xNextFreeBlock == heapNO_BLOCK) ? nullptr :
+               reinterpret_cast<BlockLink_t *>(ucHeap + block->xNextFreeBlock);
+    }
+
+    static void SetNextFreeBlock(BlockLink_t * block, const BlockLink_t * next)
+    {
+        block->xNextFreeBlock = (next == nullptr) ? heapNO_BLOCK :
+            static_cast<heapTargetSize_t>(reinterpret_cast<const uint8_t *>(next) - ucHeap);
+    }
+
+    static const size_t s_heapStructSize = (sizeof(BlockLink_t) + ((size_t)(heapBYTE_ALIGNMENT - 1))) &
+                                           ~((size_t)heapBYTE_ALIGNMENT_MASK);
+
+    static thread_local BlockLink_t s_start;
+    static thread_local BlockLink_t * s_end = nullptr;
+    static thread_local uint8_t * s_heapStart = nullptr;
+
+    //the blocks, i.e. the accounting, are the target's, while host code uses
+    //the memory returned. Each block's memory is therefore placed in a host
+    //array, at its offset from the heap's start scaled such that the target's
+    //alignment becomes the host's. Memory never overlaps, as a block's bytes
+    //are at most the distance to the next block.
+    static constexpr size_t heapHOST_SCALE = (alignof(std::max_align_t) > heapBYTE_ALIGNMENT) ?
+                                             (alignof(std::max_align_t) / heapBYTE_ALIGNMENT) : 1;
+    alignas(std::max_align_t) static thread_local uint8_t
+            s_hostHeap[(heapHOST_SCALE == 1) ? 1 : (configTOTAL_HEAP_SIZE * heapHOST_SCALE)];
+
+    static void * HostMemory(BlockLink_t * block)
+    {
+        auto memory = reinterpret_cast<uint8_t *>(block) + s_heapStructSize;
+        if (heapHOST_SCALE == 1)
+        {
+            return memory;
+        }
+        return s_hostHeap + (static_cast<size_t>(memory - s_heapStart) * heapHOST_SCALE);
+    }
+
+    static BlockLink_t * BlockOfHostMemory(void * pv)
+    {
+        auto memory = static_cast<uint8_t *>(pv);
+        if (heapHOST_SCALE != 1)
+        {
+            //i.e. a pointer not from pvPortMalloc
+            configASSERT((memory >= s_hostHeap) && (memory < (s_hostHeap + sizeof(s_hostHeap))));
+            memory = s_heapStart + (static_cast<size_t>(memory - s_hostHeap) / heapHOST_SCALE);
+        }
+        return reinterpret_cast<BlockLink_t *>(memory - s_heapStructSize);
+    }
+
+    static thread_local size_t s_freeBytesRemaining = 0;
+    static thread_local size_t s_minimumEverFreeBytesRemaining = 0;
+    static thread_local size_t s_numberOfSuccessfulAllocations = 0;
+    static thread_local size_t s_numberOfSuccessfulFrees = 0;
+
+    //charges made before the most recent reset are no longer in the heap
+    static thread_local uint32_t s_generation = 0;
+
+    static void HeapInitBlocks()
+    {
+        auto startAddress = reinterpret_cast<portPOINTER_SIZE_TYPE>(ucHeap);
+        size_t totalHeapSize = configTOTAL_HEAP_SIZE;
+
+        if ((startAddress & heapBYTE_ALIGNMENT_MASK) != 0)
+        {
+            startAddress += (heapBYTE_ALIGNMENT - 1);
+            startAddress &= ~(static_cast<portPOINTER_SIZE_TYPE>(heapBYTE_ALIGNMENT_MASK));
+            totalHeapSize -= static_cast<size_t>(startAddress - reinterpret_cast<portPOINTER_SIZE_TYPE>(ucHeap));
+        }
+
+        s_heapStart = reinterpret_cast<uint8_t *>(startAddress);
+        SetNextFreeBlock(&s_start, reinterpret_cast<BlockLink_t *>(startAddress));
+        s_start.xBlockSize = 0;
+
+        //the end marker occupies the last struct sized space of the heap
+        auto endAddress = startAddress + static_cast<portPOINTER_SIZE_TYPE>(totalHeapSize);
+        endAddress -= static_cast<portPOINTER_SIZE_TYPE>(s_heapStructSize);
+        endAddress &= ~(static_cast<portPOINTER_SIZE_TYPE>(heapBYTE_ALIGNMENT_MASK));
+        s_end = reinterpret_cast<BlockLink_t *>(endAddress);
+        s_end->xBlockSize = 0;
+        SetNextFreeBlock(s_end, nullptr);
+
+        auto firstFreeBlock = reinterpret_cast<BlockLink_t *>(startAddress);
+        firstFreeBlock->xBlockSize = static_cast<heapTargetSize_t>(endAddress - startAddress);
+        SetNextFreeBlock(firstFreeBlock, s_end);
+
+        s_minimumEverFreeBytesRemaining = firstFreeBlock->xBlockSize;
+        s_freeBytesRemaining = firstFreeBlock->xBlockSize;
+    }
+
+    static void InsertBlockIntoFreeList(BlockLink_t * blockToInsert)
+    {
+        //the free list is ordered by address, find the block prior to the insertion point
+        BlockLink_t * iterator;
+        for (iterator = &s_start; NextFreeBlock(iterator) < blockToInsert; iterator = NextFreeBlock(iterator))
+        {
+        }
+
+        //coalesce with the previous free block, if contiguous
+        auto puc = reinterpret_cast<uint8_t *>(iterator);
+        if ((puc + iterator->xBlockSize) == reinterpret_cast<uint8_t *>(blockToInsert))
+        {
+            iterator->xBlockSize += blockToInsert->xBlockSize;
+            blockToInsert = iterator;
+        }
+
+        //coalesce with the next free block, if contiguous
+        puc = reinterpret_cast<uint8_t *>(blockToInsert);
+        if ((puc + blockToInsert->xBlockSize) == reinterpret_cast<uint8_t *>(NextFreeBlock(iterator)))
+        {
+            if (NextFreeBlock(iterator) != s_end)
+            {
+                blockToInsert->xBlockSize += NextFreeBlock(iterator)->xBlockSize;
+                SetNextFreeBlock(blockToInsert, NextFreeBlock(NextFreeBlock(iterator)));
+            }
+            else
+            {
+                SetNextFreeBlock(blockToInsert, s_end);
+            }
+        }
+        else
+        {
+            SetNextFreeBlock(blockToInsert, NextFreeBlock(iterator));
+        }
+
+        if (iterator != blockToInsert)
+        {
+            SetNextFreeBlock(iterator, blockToInsert);
+        }
+    }
+
+    static void HeapReset()
+    {
+        vPortHeapResetState();
+        s_generation++;
+    }
+
+    void HeapInit()
+    {
+        HeapReset();
+    }
+
+    void HeapTeardown()
+    {
+        HeapReset();
+    }
+
+    HeapCharge ChargeHeap(size_t bytes)
+    {
+        return { pvPortMalloc(bytes), s_generation };
+    }
+
+    void ReleaseHeap(HeapCharge & charge)
+    {
+        if ((charge.block != nullptr) && (charge.generation == s_generation))
+        {
+            vPortFree(charge.block);
+        }
+        charge = {};
+    }
+
+} //namespace test
+} //namespace cms
+
+using namespace cms::test;
+
+extern "C" void * pvPortMalloc(size_t xWantedSize)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+
+    void * pvReturn = nullptr;
+    if (xWantedSize > 0)
+    {
+        //room for the block header, then the alignment padding
+        if (heapADD_WILL_OVERFLOW(xWantedSize, s_heapStructSize) == 0)
+        {
+            xWantedSize += s_heapStructSize;
+            if ((xWantedSize & heapBYTE_ALIGNMENT_MASK) != 0x00)
+            {
+                size_t additionalRequiredSize = heapBYTE_ALIGNMENT - (xWantedSize & heapBYTE_ALIGNMENT_MASK);
+                if (heapADD_WILL_OVERFLOW(xWantedSize, additionalRequiredSize) == 0)
+                {
+                    xWantedSize += additionalRequiredSize;
+                }
+                else
+                {
+                    xWantedSize = 0;
+                }
+            }
+        }
+        else
+        {
+            xWantedSize = 0;
+        }
+    }
+
+    if (s_end == nullptr)
+    {
+        HeapInitBlocks();
+    }
+
+    if (heapBLOCK_SIZE_IS_VALID(xWantedSize) && (xWantedSize > 0) && (xWantedSize <= s_freeBytesRemaining))
+    {
+        //first fit, walking the address ordered free list
+        BlockLink_t * previousBlock = &s_start;
+        BlockLink_t * block = NextFreeBlock(&s_start);
+        while ((block->xBlockSize < xWantedSize) && (NextFreeBlock(block) != nullptr))
+        {
+            previousBlock = block;
+            block = NextFreeBlock(block);
+        }
+
+        if (block != s_end)
+        {
+            pvReturn = HostMemory(block);
+            SetNextFreeBlock(previousBlock, NextFreeBlock(block));
+
+            //split the block if the remainder is large enough to be useful
+            if ((block->xBlockSize - xWantedSize) > heapMINIMUM_BLOCK_SIZE)
+            {
+                auto newBlockLink = reinterpret_cast<BlockLink_t *>(reinterpret_cast<uint8_t *>(block) + xWantedSize);
+                newBlockLink->xBlockSize = static_cast<heapTargetSize_t>(block->xBlockSize - xWantedSize);
+                block->xBlockSize = static_cast<heapTargetSize_t>(xWantedSize);
+                InsertBlockIntoFreeList(newBlockLink);
+            }
+
+            s_freeBytesRemaining -= block->xBlockSize;
+            if (s_freeBytesRemaining < s_minimumEverFreeBytesRemaining)
+            {
+                s_minimumEverFreeBytesRemaining = s_freeBytesRemaining;
+            }
+
+            heapALLOCATE_BLOCK(block);
+            SetNextFreeBlock(block, nullptr);
+            s_numberOfSuccessfulAllocations++;
+        }
+    }
+
+    traceMALLOC(pvReturn, xWantedSize);
+
+    #if (configUSE_MALLOC_FAILED_HOOK == 1)
+        if (pvReturn == nullptr)
+        {
+            vApplicationMallocFailedHook();
+        }
+    #endif
+
+    configASSERT((reinterpret_cast<size_t>(pvReturn) % alignof(std::max_align_t)) == 0);
+    return pvReturn;
+}
+
+extern "C" void vPortFree(void * pv)
+{
+    if (pv == nullptr)
+    {
+        return;
+    }
+
+    configASSERT(!cms::test::IsInIsrContext());
+
+    auto link = BlockOfHostMemory(pv);
+
+    //i.e. a double free, or a pointer not from pvPortMalloc
+    configASSERT(heapBLOCK_IS_ALLOCATED(link));
+    configASSERT(NextFreeBlock(link) == nullptr);
+
+    heapFREE_BLOCK(link);
+    traceFREE(pv, link->xBlockSize);
+    #if (configHEAP_CLEAR_MEMORY_ON_FREE == 1)
+        if (heapSUBTRACT_WILL_UNDERFLOW(link->xBlockSize, s_heapStructSize) == 0)
+        {
+            memset(pv, 0, link->xBlockSize - s_heapStructSize);
+        }
+    #endif
+
+    s_freeBytesRemaining += link->xBlockSize;
+    InsertBlockIntoFreeList(link);
+    s_numberOfSuccessfulFrees++;
+}
+
+extern "C" void * pvPortCalloc(size_t xNum, size_t xSize)
+{
+    if (heapMULTIPLY_WILL_OVERFLOW(xNum, xSize))
+    {
+        return nullptr;
+    }
+
+    void * pv = pvPortMalloc(xNum * xSize);
+    if (pv != nullptr)
+    {
+        memset(pv, 0, xNum * xSize);
+    }
+    return pv;
+}
+
+extern "C" size_t xPortGetFreeHeapSize(void)
+{
+    if (s_end == nullptr)
+    {
+        HeapInitBlocks();
+    }
+    return s_freeBytesRemaining;
+}
+
+extern "C" size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    if (s_end == nullptr)
+    {
+        HeapInitBlocks();
+    }
+    return s_minimumEverFreeBytesRemaining;
+}
+
+extern "C" void xPortResetHeapMinimumEverFreeHeapSize(void)
+{
+    s_minimumEverFreeBytesRemaining = s_freeBytesRemaining;
+}
+
+extern "C" void vPortInitialiseBlocks(void)
+{
+    //only required when heap_1, heap_2 or heap_3 are used
+}
+
+extern "C" void vPortGetHeapStats(HeapStats_t * pxHeapStats)
+{
+    configASSERT(pxHeapStats != nullptr);
+
+    if (s_end == nullptr)
+    {
+        HeapInitBlocks();
+    }
+
+    size_t blocks = 0;
+    size_t maxSize = 0;
+    size_t minSize = heapSIZE_MAX;
+    for (BlockLink_t * block = NextFreeBlock(&s_start); block != s_end; block = NextFreeBlock(block))
+    {
+        blocks++;
+        if (block->xBlockSize > maxSize)
+        {
+            maxSize = block->xBlockSize;
+        }
+        if (block->xBlockSize < minSize)
+        {
+            minSize = block->xBlockSize;
+        }
+    }
+
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = maxSize;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = (blocks == 0) ? 0 : minSize;
+    pxHeapStats->xNumberOfFreeBlocks = blocks;
+    pxHeapStats->xAvailableHeapSpaceInBytes = s_freeBytesRemaining;
+    pxHeapStats->xNumberOfSuccessfulAllocations = s_numberOfSuccessfulAllocations;
+    pxHeapStats->xNumberOfSuccessfulFrees = s_numberOfSuccessfulFrees;
+    pxHeapStats->xMinimumEverFreeBytesRemaining = s_minimumEverFreeBytesRemaining;
+}
+
+extern "C" void vPortHeapResetState(void)
+{
+    s_end = nullptr;
+    s_freeBytesRemaining = 0;
+    s_minimumEverFreeBytesRemaining = 0;
+    s_numberOfSuccessfulAllocations = 0;
+    s_numberOfSuccessfulFrees = 0;
+}
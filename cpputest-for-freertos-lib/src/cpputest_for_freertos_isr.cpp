@@ -0,0 +1,260 @@
+/// @brief Provides a simulated interrupt context. Non-FromISR APIs
+///        assert while in the simulated context, and the virtual time
+///        from ISR entry until task level code receives the posted
+///        event is recorded.
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include <deque>
+#include <algorithm>
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_fake_isr.hpp"
+#include "cpputest_for_freertos_fake_timeline.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "FreeRTOS.h"
+
+namespace cms {
+namespace test {
+
+    struct IsrEvent
+    {
+        const void * object;
+        std::chrono::nanoseconds isrEntry;
+        std::chrono::nanoseconds taskReady;
+    };
+
+    struct IsrTracking
+    {
+        std::vector<IsrEvent> postedByCurrentIsr;
+        std::deque<IsrEvent> pending;
+        std::vector<std::chrono::nanoseconds> latencies;
+    };
+
+    static thread_local uint32_t s_isrNesting = 0;
+    static thread_local std::chrono::nanoseconds s_isrEntry = {};
+    static thread_local bool s_yieldRequested = false;
+    static thread_local bool s_lastIsrYieldRequested = false;
+    static thread_local bool s_isTracking = false;
+    static thread_local IsrTracking* s_tracking = nullptr;
+
+    static void ResetIsr()
+    {
+        s_isrNesting = 0;
+        s_yieldRequested = false;
+        s_lastIsrYieldRequested = false;
+        delete s_tracking;
+        s_tracking = nullptr;
+    }
+
+    void IsrInit()
+    {
+        //i.e. discard the state of a teardown skipped by an earlier failure
+        ResetIsr();
+        s_isTracking = true;
+    }
+
+    void IsrTeardown()
+    {
+        ResetIsr();
+        s_isTracking = false;
+    }
+
+    static std::chrono::nanoseconds NextTick(std::chrono::nanoseconds now)
+    {
+        const std::chrono::nanoseconds tick = std::chrono::nanoseconds(std::chrono::seconds(1)) / configTICK_RATE_HZ;
+        return ((now / tick) + 1) * tick;
+    }
+
+    static void IsrExit()
+    {
+        s_lastIsrYieldRequested = s_yieldRequested;
+        if (s_tracking == nullptr)
+        {
+            return;
+        }
+
+        //without a requested context switch, the woken task
+        //waits for the next tick to be scheduled.
+        auto now = GetVirtualTime();
+        auto taskReady = s_yieldRequested ? now : NextTick(now);
+        for (auto& event : s_tracking->postedByCurrentIsr)
+        {
+            event.taskReady = taskReady;
+            s_tracking->pending.push_back(event);
+        }
+        s_tracking->postedByCurrentIsr.clear();
+    }
+
+    void RunInIsrContext(const std::function<void()>& isr)
+    {
+        configASSERT(isr);
+        if (s_isrNesting == 0)
+        {
+            s_isrEntry = GetVirtualTime();
+            s_yieldRequested = false;
+        }
+
+        s_isrNesting++;
+        TimelineIsrEntered();
+        try
+        {
+            isr();
+        }
+        catch (...)
+        {
+            //i.e. a configASSERT or failed CHECK exiting the test
+            s_isrNesting--;
+            TimelineIsrExited();
+            throw;
+        }
+        s_isrNesting--;
+        TimelineIsrExited();
+
+        if (s_isrNesting == 0)
+        {
+            IsrExit();
+        }
+    }
+
+    bool IsInIsrContext()
+    {
+        return s_isrNesting != 0;
+    }
+
+    bool WasYieldRequestedFromIsr()
+    {
+        return s_lastIsrYieldRequested;
+    }
+
+    std::vector<std::chrono::nanoseconds> GetIsrLatencies()
+    {
+        if (s_tracking == nullptr)
+        {
+            return {};
+        }
+
+        return s_tracking->latencies;
+    }
+
+    std::chrono::nanoseconds GetMaxIsrLatency()
+    {
+        auto latencies = GetIsrLatencies();
+        if (latencies.empty())
+        {
+            return std::chrono::nanoseconds::zero();
+        }
+
+        return *std::max_element(latencies.begin(), latencies.end());
+    }
+
+    void IsrEventPosted(const void * object)
+    {
+        if (!s_isTracking || !IsInIsrContext())
+        {
+            return;
+        }
+
+        //i.e. only tests which post from an ISR pay for the tracking
+        if (s_tracking == nullptr)
+        {
+            s_tracking = new IsrTracking;
+        }
+        s_tracking->postedByCurrentIsr.push_back({object, s_isrEntry, s_isrEntry});
+    }
+
+    void IsrEventReceived(const void * object)
+    {
+        if (s_tracking == nullptr)
+        {
+            return;
+        }
+
+        auto isObject = [=](const IsrEvent& event)
+        {
+            return event.object == object;
+        };
+
+        auto& pending = s_tracking->pending;
+        auto iter = std::find_if(pending.begin(), pending.end(), isObject);
+        if (IsInIsrContext())
+        {
+            //consumed by an ISR, no task was involved
+            if (iter != pending.end())
+            {
+                pending.erase(iter);
+                return;
+            }
+
+            auto& posted = s_tracking->postedByCurrentIsr;
+            auto postedIter = std::find_if(posted.begin(), posted.end(), isObject);
+            if (postedIter != posted.end())
+            {
+                posted.erase(postedIter);
+            }
+            return;
+        }
+
+        if (iter == pending.end())
+        {
+            return;
+        }
+
+        auto received = std::max(GetVirtualTime(), iter->taskReady);
+        s_tracking->latencies.push_back(received - iter->isrEntry);
+        TimelineIsrEventReceived(iter->isrEntry);
+        pending.erase(iter);
+    }
+
+    void IsrObjectDeleted(const void * object)
+    {
+        if (s_tracking == nullptr)
+        {
+            return;
+        }
+
+        auto isObject = [=](const IsrEvent& event)
+        {
+            return event.object == object;
+        };
+
+        auto& pending = s_tracking->pending;
+        pending.erase(std::remove_if(pending.begin(), pending.end(), isObject), pending.end());
+        auto& posted = s_tracking->postedByCurrentIsr;
+        posted.erase(std::remove_if(posted.begin(), posted.end(), isObject), posted.end());
+    }
+
+} //namespace test
+} //namespace cms
+
+extern "C" void cmsPortYieldFromIsr(BaseType_t switchRequired)
+{
+    if (cms::test::IsInIsrContext() && (switchRequired != pdFALSE))
+    {
+        cms::test::s_yieldRequested = true;
+    }
+}
+
+extern "C" BaseType_t cmsPortCheckIfInIsr(void)
+{
+    return cms::test::IsInIsrContext() ? pdTRUE : pdFALSE;
+}
@@ -0,0 +1,316 @@
+/// @brief Tracks dynamically created kernel objects, allowing unit tests
+///        to confirm that each one was deleted.
+///
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <utility>
+#include <vector>
+#include "cpputest_for_freertos_kernel_objects.hpp"
+#include "cpputest_for_freertos_fake_kernel_objects.hpp"
+#include "cpputest_for_freertos_creation_site.h"
+
+//must be last
+#include "CppUTest/TestHarness.h"
+
+namespace cms {
+namespace test {
+
+    struct KernelObjectSession
+    {
+        std::vector<KernelObjectRecord> created;     ///< in order of creation
+        std::map<const void *, size_t> live;         ///< handle to index within created
+        size_t liveBytes = 0;
+        size_t peakBytes = 0;
+        size_t budget = 0;
+    };
+
+    static thread_local bool s_isTracking = false;
+    static thread_local KernelObjectSession * s_session = nullptr;
+    static thread_local const char * s_siteFile = nullptr;
+    static thread_local unsigned long s_siteLine = 0;
+
+    static const char * KindToString(KernelObjectKind kind)
+    {
+        switch (kind)
+        {
+            case KernelObjectKind::Queue:
+                return "queue";
+            case KernelObjectKind::Semaphore:
+                return "semaphore";
+            case KernelObjectKind::Mutex:
+                return "mutex";
+            case KernelObjectKind::Task:
+                return "task";
+            case KernelObjectKind::Timer:
+                return "timer";
+            case KernelObjectKind::EventGroup:
+                return "event group";
+            case KernelObjectKind::StreamBuffer:
+                return "stream buffer";
+            case KernelObjectKind::MessageBuffer:
+                return "message buffer";
+            default:
+                return "unknown";
+        }
+    }
+
+    void KernelObjectTrackingInit()
+    {
+        //i.e. discard the session of a teardown skipped by an earlier failure
+        delete s_session;
+        s_session = nullptr;
+        s_isTracking = true;
+        s_siteFile = nullptr;
+        s_siteLine = 0;
+    }
+
+    //the session is only created once the first kernel object is,
+    //or a budget is set, while tracking is active.
+    static bool StartSession()
+    {
+        if (!s_isTracking)
+            return false;
+
+        if (s_session == nullptr)
+        {
+            s_session = new KernelObjectSession;
+        }
+        return true;
+    }
+
+    void KernelObjectTrackingTeardown()
+    {
+        s_isTracking = false;
+        if (s_session == nullptr)
+            return;
+
+        auto leaked = GetLiveKernelObjects().size();
+        if (leaked != 0)
+        {
+            PrintLiveKernelObjects();
+        }
+
+        auto budget = s_session->budget;
+        auto peakBytes = s_session->peakBytes;
+        bool isOverBudget = (budget != 0) && (peakBytes > budget);
+        if (isOverBudget)
+        {
+            PrintFootprintReport();
+        }
+
+        delete s_session;
+        s_session = nullptr;
+
+        if (leaked != 0)
+        {
+            auto msg = StringFromFormat("%llu kernel object(s) were created but not deleted.",
+                                        static_cast<unsigned long long>(leaked));
+            FAIL_TEST(msg.asCharString());
+        }
+
+        if (isOverBudget)
+        {
+            auto msg = StringFromFormat("Kernel object footprint budget exceeded: %llu bytes peak, %llu bytes allowed.",
+                                        static_cast<unsigned long long>(peakBytes),
+                                        static_cast<unsigned long long>(budget));
+            FAIL_TEST(msg.asCharString());
+        }
+    }
+
+    std::vector<KernelObjectRecord> GetLiveKernelObjects()
+    {
+        std::vector<KernelObjectRecord> live;
+        if (s_session == nullptr)
+        {
+            return live;
+        }
+
+        for (const auto& entry : s_session->live)
+        {
+            const auto& record = s_session->created[entry.second];
+            if (!record.isStatic)
+            {
+                live.push_back(record);
+            }
+        }
+
+        std::sort(live.begin(), live.end(), [](const KernelObjectRecord& a, const KernelObjectRecord& b)
+        {
+            return a.sequence < b.sequence;
+        });
+
+        return live;
+    }
+
+    void PrintLiveKernelObjects()
+    {
+        auto live = GetLiveKernelObjects();
+        fprintf(stdout, "\nKernel objects not deleted:\n");
+        for (const auto& record : live)
+        {
+            fprintf(stdout, "  %s '%s' (%p) created by %s at %s(%lu)\n",
+                    KindToString(record.kind), record.name.c_str(), record.handle,
+                    record.test.c_str(),
+                    record.file ? record.file : "<unknown>", record.line);
+        }
+    }
+
+    FootprintReport GetFootprintReport()
+    {
+        FootprintReport report = {};
+        if (s_session == nullptr)
+        {
+            return report;
+        }
+
+        std::map<std::pair<KernelObjectKind, std::string>, FootprintEntry> entries;
+        for (const auto& record : s_session->created)
+        {
+            auto& entry = entries[std::make_pair(record.kind, record.name)];
+            entry.kind = record.kind;
+            entry.name = record.name;
+            entry.count++;
+            entry.bytes += record.footprint;
+            report.totalBytes += record.footprint;
+        }
+
+        for (const auto& entry : entries)
+        {
+            report.entries.push_back(entry.second);
+        }
+
+        std::stable_sort(report.entries.begin(), report.entries.end(), [](const FootprintEntry& a, const FootprintEntry& b)
+        {
+            return a.bytes > b.bytes;
+        });
+
+        report.peakBytes = s_session->peakBytes;
+        report.liveBytes = s_session->liveBytes;
+        return report;
+    }
+
+    void PrintFootprintReport()
+    {
+        auto report = GetFootprintReport();
+        fprintf(stdout, "\nKernel object footprint: total=%llu peak=%llu live=%llu bytes\n",
+                static_cast<unsigned long long>(report.totalBytes),
+                static_cast<unsigned long long>(report.peakBytes),
+                static_cast<unsigned long long>(report.liveBytes));
+        for (const auto& entry : report.entries)
+        {
+            fprintf(stdout, "  %s '%s': count=%llu bytes=%llu\n",
+                    KindToString(entry.kind), entry.name.c_str(),
+                    static_cast<unsigned long long>(entry.count),
+                    static_cast<unsigned long long>(entry.bytes));
+        }
+    }
+
+    void SetFootprintBudget(size_t bytes)
+    {
+        auto isTracking = StartSession();
+        configASSERT(isTracking);
+        s_session->budget = bytes;
+    }
+
+    static void Created(KernelObjectKind kind, const void * handle, size_t footprint,
+                        const char * name, bool isStatic, const char * file, unsigned long line)
+    {
+        if ((handle == nullptr) || !StartSession())
+            return;
+
+        auto current = UtestShell::getCurrent();
+        KernelObjectRecord record = {};
+        record.kind = kind;
+        record.handle = handle;
+        record.name = (name != nullptr) ? name : "";
+        record.file = file;
+        record.line = line;
+        record.test = std::string("TEST(") + current->getGroup().asCharString() + ", " +
+                      current->getName().asCharString() + ")";
+        record.sequence = s_session->created.size() + 1;
+        record.footprint = footprint;
+        record.isStatic = isStatic;
+
+        //i.e. a static object recreated in place, without a delete
+        KernelObjectDeleted(handle);
+
+        s_session->live[handle] = s_session->created.size();
+        s_session->created.push_back(record);
+        s_session->liveBytes += footprint;
+        if (s_session->liveBytes > s_session->peakBytes)
+        {
+            s_session->peakBytes = s_session->liveBytes;
+        }
+    }
+
+    void KernelObjectCreated(KernelObjectKind kind, const void * handle, size_t footprint, const char * name)
+    {
+        auto file = s_siteFile;
+        auto line = s_siteLine;
+        s_siteFile = nullptr;
+        s_siteLine = 0;
+
+        Created(kind, handle, footprint, name, false, file, line);
+    }
+
+    void StaticKernelObjectCreated(KernelObjectKind kind, const void * handle, size_t footprint, const char * name)
+    {
+        Created(kind, handle, footprint, name, true, nullptr, 0);
+    }
+
+    void KernelObjectNamed(const void * handle, const char * name)
+    {
+        if (s_session == nullptr)
+            return;
+
+        auto found = s_session->live.find(handle);
+        if (found != s_session->live.end())
+        {
+            s_session->created[found->second].name = (name != nullptr) ? name : "";
+        }
+    }
+
+    void KernelObjectDeleted(const void * handle)
+    {
+        if (s_session == nullptr)
+            return;
+
+        auto found = s_session->live.find(handle);
+        if (found != s_session->live.end())
+        {
+            s_session->liveBytes -= s_session->created[found->second].footprint;
+            s_session->live.erase(found);
+        }
+    }
+
+} //namespace test
+} //namespace cms
+
+extern "C" void cmsKernelObjectCreationSite(const char * file, unsigned long line)
+{
+    cms::test::s_siteFile = file;
+    cms::test::s_siteLine = line;
+}
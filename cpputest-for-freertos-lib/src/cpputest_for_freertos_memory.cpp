@@ -0,0 +1,339 @@
+/// @brief Accounts for kernel object memory use, allowing unit tests
+///        to confirm that code intended to be heap free is so.
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include <cstddef>
+#include <cstdlib>
+#include <utility>
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_fake_memory.hpp"
+#include "FreeRTOS.h"
+
+namespace cms {
+namespace test {
+
+    static thread_local uint64_t s_dynamicAllocationCount = 0;
+
+    void DynamicAllocationMade()
+    {
+        s_dynamicAllocationCount++;
+    }
+
+    uint64_t GetDynamicAllocationCount()
+    {
+        return s_dynamicAllocationCount;
+    }
+
+    //the arena is a list of chunks, each bump allocated, obtained
+    //with malloc such that only the chunks are seen by any leak detector.
+    //A chunk counts its objects not yet freed, such that a released
+    //arena's chunk is only returned to malloc once none remain.
+    struct alignas(std::max_align_t) ArenaChunk
+    {
+        ArenaChunk * next;
+        size_t size;
+        size_t used;
+        size_t live;
+    };
+
+    static constexpr size_t ARENA_CHUNK_SIZE = 64 * 1024;
+
+    //allocations made while no arena is active, listed such that ArenaFree
+    //recognises them by address alone, never reading memory it may not own
+    struct alignas(std::max_align_t) HeapAllocation
+    {
+        HeapAllocation * next;
+    };
+
+    static thread_local bool s_arenaActive = false;
+    static thread_local ArenaChunk * s_arenaChunks = nullptr;
+    static thread_local ArenaChunk * s_retiredChunks = nullptr;
+    static thread_local size_t s_arenaBytesUsed = 0;
+    static thread_local HeapAllocation * s_heapAllocations = nullptr;
+
+    static uint8_t * ChunkData(ArenaChunk * chunk)
+    {
+        return reinterpret_cast<uint8_t *>(chunk) + sizeof(ArenaChunk);
+    }
+
+    static uint8_t * HeapAllocationData(HeapAllocation * allocation)
+    {
+        return reinterpret_cast<uint8_t *>(allocation) + sizeof(HeapAllocation);
+    }
+
+    //a chunk still holding objects, e.g. a fixture member deleted after
+    //teardown(), is retired until its last object is freed
+    static void ReleaseArenaChunks()
+    {
+        while (s_arenaChunks != nullptr)
+        {
+            auto chunk = s_arenaChunks;
+            s_arenaChunks = chunk->next;
+            if (chunk->live == 0)
+            {
+                std::free(chunk);
+            }
+            else
+            {
+                chunk->next = s_retiredChunks;
+                s_retiredChunks = chunk;
+            }
+        }
+        s_arenaBytesUsed = 0;
+    }
+
+    static bool IsInChunk(ArenaChunk * chunk, const void * memory)
+    {
+        auto data = ChunkData(chunk);
+        return (memory >= data) && (memory < (data + chunk->size));
+    }
+
+    static ArenaChunk * AddArenaChunk(size_t bytes)
+    {
+        auto size = (bytes > ARENA_CHUNK_SIZE) ? bytes : ARENA_CHUNK_SIZE;
+        auto chunk = static_cast<ArenaChunk *>(std::malloc(sizeof(ArenaChunk) + size));
+        configASSERT(chunk != nullptr);
+        chunk->next = s_arenaChunks;
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->live = 0;
+        s_arenaChunks = chunk;
+        return chunk;
+    }
+
+    void ArenaInit()
+    {
+        //an arena left by a test which exited early is released here
+        ReleaseArenaChunks();
+        s_arenaActive = true;
+    }
+
+    void ArenaTeardown()
+    {
+        ReleaseArenaChunks();
+        s_arenaActive = false;
+    }
+
+    size_t GetArenaBytesUsed()
+    {
+        return s_arenaBytesUsed;
+    }
+
+    void * ArenaAllocate(size_t bytes, size_t alignment)
+    {
+        configASSERT(alignment <= alignof(std::max_align_t));
+        if (!s_arenaActive)
+        {
+            auto allocation = static_cast<HeapAllocation *>(::operator new(sizeof(HeapAllocation) + bytes));
+            allocation->next = s_heapAllocations;
+            s_heapAllocations = allocation;
+            return HeapAllocationData(allocation);
+        }
+
+        //all chunks but the newest are considered full
+        auto chunk = s_arenaChunks;
+        size_t offset = 0;
+        if (chunk != nullptr)
+        {
+            offset = (chunk->used + alignment - 1) & ~(alignment - 1);
+        }
+        if ((chunk == nullptr) || ((offset + bytes) > chunk->size))
+        {
+            chunk = AddArenaChunk(bytes);
+            offset = 0;
+        }
+
+        chunk->used = offset + bytes;
+        chunk->live++;
+        s_arenaBytesUsed += bytes;
+        return ChunkData(chunk) + offset;
+    }
+
+    void ArenaFree(void * memory)
+    {
+        if (memory == nullptr)
+        {
+            return;
+        }
+
+        for (auto chunk = s_arenaChunks; chunk != nullptr; chunk = chunk->next)
+        {
+            if (IsInChunk(chunk, memory))
+            {
+                chunk->live--;
+                return;
+            }
+        }
+
+        for (auto link = &s_retiredChunks; *link != nullptr; link = &(*link)->next)
+        {
+            auto chunk = *link;
+            if (IsInChunk(chunk, memory))
+            {
+                if (--chunk->live == 0)
+                {
+                    *link = chunk->next;
+                    std::free(chunk);
+                }
+                return;
+            }
+        }
+
+        for (auto link = &s_heapAllocations; *link != nullptr; link = &(*link)->next)
+        {
+            auto allocation = *link;
+            if (HeapAllocationData(allocation) == memory)
+            {
+                *link = allocation->next;
+                ::operator delete(allocation);
+                return;
+            }
+        }
+
+        //i.e. memory never allocated by ArenaAllocate, or already freed
+        configASSERT(false);
+    }
+
+    //one allocation of the object's Static*_t, then its count of Storage,
+    //obtained with malloc such that a released object's buffers, leaked on
+    //purpose, are not reported by any leak detector
+    template <typename Static, typename Storage = uint8_t>
+    struct StaticBuffers
+    {
+        static size_t StorageOffset()
+        {
+            return ((sizeof(Static) + alignof(Storage) - 1) / alignof(Storage)) * alignof(Storage);
+        }
+
+        static void * Allocate(size_t bytes)
+        {
+            auto memory = std::malloc(bytes);
+            configASSERT(memory != nullptr);
+            return memory;
+        }
+
+        explicit StaticBuffers(size_t count = 0) :
+            memory(Allocate(StorageOffset() + (count * sizeof(Storage)))),
+            object(new (memory) Static()),
+            storage((count == 0) ? nullptr :
+                    reinterpret_cast<Storage *>(static_cast<uint8_t *>(memory) + StorageOffset()))
+        {
+        }
+
+        void * memory;
+        Static * object;
+        Storage * storage;
+    };
+
+    template <typename Owner>
+    static Owner OwnStatic(typename Owner::pointer handle, void * buffers)
+    {
+        Owner owner(handle);
+        if (handle != nullptr)
+        {
+            owner.get_deleter().buffers = buffers;
+        }
+        else
+        {
+            std::free(buffers);
+        }
+        configASSERT(handle != nullptr);
+        return owner;
+    }
+
+    unique_queue make_unique_queue(UBaseType_t length, UBaseType_t itemSize)
+    {
+        StaticBuffers<StaticQueue_t> buffers(static_cast<size_t>(length) * itemSize);
+        return OwnStatic<unique_queue>(xQueueCreateStatic(length, itemSize, buffers.storage, buffers.object),
+                                       buffers.memory);
+    }
+
+    unique_sema make_unique_binary_sema()
+    {
+        StaticBuffers<StaticSemaphore_t> buffers;
+        return OwnStatic<unique_sema>(xSemaphoreCreateBinaryStatic(buffers.object), buffers.memory);
+    }
+
+    unique_sema make_unique_counting_sema(UBaseType_t maxCount, UBaseType_t initialCount)
+    {
+        StaticBuffers<StaticSemaphore_t> buffers;
+        return OwnStatic<unique_sema>(xSemaphoreCreateCountingStatic(maxCount, initialCount, buffers.object),
+                                      buffers.memory);
+    }
+
+    unique_mutex make_unique_mutex()
+    {
+        StaticBuffers<StaticSemaphore_t> buffers;
+        return OwnStatic<unique_mutex>(xSemaphoreCreateMutexStatic(buffers.object), buffers.memory);
+    }
+
+    unique_mutex make_unique_recursive_mutex()
+    {
+        StaticBuffers<StaticSemaphore_t> buffers;
+        return OwnStatic<unique_mutex>(xSemaphoreCreateRecursiveMutexStatic(buffers.object), buffers.memory);
+    }
+
+    unique_timer make_unique_timer(const char * name, TickType_t period, BaseType_t autoReload,
+                                   void * id, TimerCallbackFunction_t callback)
+    {
+        StaticBuffers<StaticTimer_t> buffers;
+        return OwnStatic<unique_timer>(xTimerCreateStatic(name, period, autoReload, id, callback, buffers.object),
+                                       buffers.memory);
+    }
+
+    unique_event_group make_unique_event_group()
+    {
+        StaticBuffers<StaticEventGroup_t> buffers;
+        return OwnStatic<unique_event_group>(xEventGroupCreateStatic(buffers.object), buffers.memory);
+    }
+
+    //as the kernel documents, static storage of one byte more holds size bytes
+    unique_stream_buffer make_unique_stream_buffer(size_t size, size_t triggerLevel)
+    {
+        StaticBuffers<StaticStreamBuffer_t> buffers(size + 1);
+        return OwnStatic<unique_stream_buffer>(
+                xStreamBufferCreateStatic(size + 1, triggerLevel, buffers.storage, buffers.object),
+                buffers.memory);
+    }
+
+    unique_message_buffer make_unique_message_buffer(size_t size)
+    {
+        StaticBuffers<StaticStreamBuffer_t> buffers(size + 1);
+        return OwnStatic<unique_message_buffer>(
+                xMessageBufferCreateStatic(size + 1, buffers.storage, buffers.object),
+                buffers.memory);
+    }
+
+    unique_task make_unique_task(TaskFunction_t code, const char * name,
+                                 configSTACK_DEPTH_TYPE stackDepth,
+                                 void * parameters, UBaseType_t priority)
+    {
+        StaticBuffers<StaticTask_t, StackType_t> buffers(stackDepth);
+        return OwnStatic<unique_task>(xTaskCreateStatic(code, name, stackDepth, parameters, priority,
+                                                        buffers.storage, buffers.object),
+                                      buffers.memory);
+    }
+
+} //namespace test
+} //namespace cms
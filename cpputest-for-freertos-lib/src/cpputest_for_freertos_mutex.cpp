@@ -25,10 +25,16 @@
 ///***************************************************************************
 /// @endcond
 
-#include <list>
+#include <vector>
+#include <map>
+#include <set>
 #include <algorithm>
 #include "cpputest_for_freertos_fake_queue.hpp"
+#include "cpputest_for_freertos_fake_task.hpp"
+#include "cpputest_for_freertos_fake_trace.hpp"
 #include "cpputest_for_freertos_mutex.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_task.hpp"
 #include "queue.h"
 #include "semphr.h"
 
@@ -38,24 +44,94 @@
 namespace cms {
     namespace test {
 
-        static std::list<QueueHandle_t>* s_mutexes = nullptr;
+        struct InversionRecord
+        {
+            PriorityInversion inversion;
+            std::chrono::nanoseconds maxWait;
+        };
+
+        //mutexes created while tracking is active are linked through
+        //their FakeQueue. A session number, rather than a flag, allows
+        //teardown to abandon the list without visiting each mutex.
+        static thread_local uint32_t s_trackingSession = 0;
+        static thread_local uint32_t s_lastTrackingSession = 0;
+        static thread_local QueueHandle_t s_trackedMutexes = nullptr;
+        static thread_local size_t s_trackedCount = 0;
+        static thread_local size_t s_lockedCount = 0;
+        static thread_local std::vector<InversionRecord>* s_inversions = nullptr;
+
+        struct LockOrderGraph
+        {
+            //edge a -> b: b was taken while a was held
+            std::map<QueueHandle_t, std::set<QueueHandle_t>> takenWhileHeld;
+            std::map<TaskHandle_t, std::vector<QueueHandle_t>> heldByTask;
+            std::vector<LockOrderViolation> violations;
+        };
+
+        static thread_local LockOrderGraph* s_lockOrder = nullptr;
+
+        struct MutexProfileRecord
+        {
+            MutexProfile profile;
+            bool isHeld;
+            std::chrono::nanoseconds heldSinceVirtual;
+            std::chrono::steady_clock::time_point heldSinceHost;
+        };
+
+        struct MutexProfiles
+        {
+            std::map<QueueHandle_t, MutexProfileRecord> active;
+            std::map<std::string, MutexProfile> deleted;
+        };
+
+        static thread_local MutexProfiles* s_profiles = nullptr;
+
+        static void ResetMutexTracking()
+        {
+            s_trackingSession = 0;
+            s_trackedMutexes = nullptr;
+            s_trackedCount = 0;
+            s_lockedCount = 0;
+            delete s_inversions;
+            s_inversions = nullptr;
+            delete s_lockOrder;
+            s_lockOrder = nullptr;
+            delete s_profiles;
+            s_profiles = nullptr;
+        }
 
         void MutexTrackingInit()
         {
-            configASSERT(s_mutexes == nullptr);
-            s_mutexes = new std::list<QueueHandle_t>;
+            //i.e. discard the state of a teardown skipped by an earlier failure
+            ResetMutexTracking();
+            s_lastTrackingSession++;
+            if (s_lastTrackingSession == 0)
+            {
+                s_lastTrackingSession = 1;
+            }
+            s_trackingSession = s_lastTrackingSession;
+        }
+
+        //the inversion, lock order and profile records are only
+        //created once a mutex is first taken within this session.
+        static void StartMutexRecords()
+        {
+            if ((s_trackingSession == 0) || (s_profiles != nullptr))
+                return;
+
+            s_inversions = new std::vector<InversionRecord>;
+            s_lockOrder = new LockOrderGraph;
+            s_profiles = new MutexProfiles;
         }
 
         void MutexTrackingTeardown()
         {
-            if (s_mutexes == nullptr)
+            if (s_trackingSession == 0)
                 return;
 
             bool isAnyLocked = IsAnyMutexLocked();
 
-            s_mutexes->clear();
-            delete s_mutexes;
-            s_mutexes = nullptr;
+            ResetMutexTracking();
 
             if (isAnyLocked)
             {
@@ -65,29 +141,441 @@ namespace cms {
 
         bool IsAnyMutexLocked()
         {
-            if (s_mutexes == nullptr)
-                return false;
+            return s_lockedCount != 0;
+        }
+
+        size_t GetTrackedMutexCount()
+        {
+            return s_trackedCount;
+        }
+
+        static bool IsTracked(const FakeQueue * mutex)
+        {
+            return (s_trackingSession != 0) && (mutex->mutexTrackingSession == s_trackingSession);
+        }
+
+        static void Track(QueueHandle_t mutex)
+        {
+            if (s_trackingSession == 0)
+                return;
+
+            mutex->mutexTrackingSession = s_trackingSession;
+            mutex->trackedPrev = nullptr;
+            mutex->trackedNext = s_trackedMutexes;
+            if (s_trackedMutexes != nullptr)
+            {
+                s_trackedMutexes->trackedPrev = mutex;
+            }
+            s_trackedMutexes = mutex;
+            s_trackedCount++;
+        }
+
+        static void Untrack(QueueHandle_t mutex)
+        {
+            if (!IsTracked(mutex))
+                return;
+
+            if (mutex->trackedPrev != nullptr)
+            {
+                mutex->trackedPrev->trackedNext = mutex->trackedNext;
+            }
+            else
+            {
+                s_trackedMutexes = mutex->trackedNext;
+            }
+
+            if (mutex->trackedNext != nullptr)
+            {
+                mutex->trackedNext->trackedPrev = mutex->trackedPrev;
+            }
+
+            if (mutex->messagesWaiting == 0)
+            {
+                s_lockedCount--;
+            }
+
+            mutex->mutexTrackingSession = 0;
+            mutex->trackedPrev = nullptr;
+            mutex->trackedNext = nullptr;
+            s_trackedCount--;
+        }
+
+        static std::chrono::nanoseconds CurrentDuration(const InversionRecord& record)
+        {
+            auto elapsed = GetVirtualTime() - record.inversion.start;
+
+            //the waiting task would have timed out
+            return std::min(elapsed, record.maxWait);
+        }
+
+        static void EndInversions(QueueHandle_t mutex)
+        {
+            if (s_inversions == nullptr)
+                return;
+
+            for (auto& record : *s_inversions)
+            {
+                if (record.inversion.isActive && (record.inversion.mutex == mutex))
+                {
+                    record.inversion.duration = CurrentDuration(record);
+                    record.inversion.isActive = false;
+                }
+            }
+        }
+
+        static bool FindLockOrderPath(QueueHandle_t from, QueueHandle_t to,
+                                      std::set<QueueHandle_t>& visited,
+                                      std::vector<QueueHandle_t>& path)
+        {
+            path.push_back(from);
+            if (from == to)
+                return true;
+
+            visited.insert(from);
+            auto edges = s_lockOrder->takenWhileHeld.find(from);
+            if (edges != s_lockOrder->takenWhileHeld.end())
+            {
+                for (auto next : edges->second)
+                {
+                    if ((visited.count(next) == 0) && FindLockOrderPath(next, to, visited, path))
+                        return true;
+                }
+            }
+
+            path.pop_back();
+            return false;
+        }
+
+        static SimpleString MutexName(QueueHandle_t mutex)
+        {
+            if (mutex->registryName != nullptr)
+                return SimpleString(mutex->registryName);
+
+            return StringFromFormat("%p", static_cast<void*>(mutex));
+        }
+
+        static void LockOrderTaken(QueueHandle_t mutex)
+        {
+            if (s_lockOrder == nullptr)
+                return;
+
+            auto& held = s_lockOrder->heldByTask[mutex->mutexHolder];
+            std::vector<LockOrderViolation> found;
+            for (auto heldMutex : held)
+            {
+                std::set<QueueHandle_t> visited;
+                std::vector<QueueHandle_t> path;
+                if (FindLockOrderPath(mutex, heldMutex, visited, path))
+                {
+                    path.push_back(mutex);
+                    found.push_back({mutex->mutexHolder, mutex, heldMutex, path});
+                }
+                else
+                {
+                    s_lockOrder->takenWhileHeld[heldMutex].insert(mutex);
+                }
+            }
+            held.push_back(mutex);
+
+            if (found.empty())
+                return;
+
+            SimpleString cycle;
+            for (auto step : found.front().cycle)
+            {
+                if (!cycle.isEmpty())
+                    cycle += " -> ";
+                cycle += MutexName(step);
+            }
+            s_lockOrder->violations.insert(s_lockOrder->violations.end(), found.begin(), found.end());
+
+            auto msg = StringFromFormat("Potential deadlock: mutex %s taken while holding mutex %s, "
+                                        "opposite order previously recorded (%s).",
+                                        MutexName(mutex).asCharString(),
+                                        MutexName(found.front().held).asCharString(),
+                                        cycle.asCharString());
+            FAIL_TEST(msg.asCharString());
+        }
+
+        static void LockOrderGiven(QueueHandle_t mutex)
+        {
+            if (s_lockOrder == nullptr)
+                return;
+
+            auto task = s_lockOrder->heldByTask.find(mutex->mutexHolder);
+            if (task == s_lockOrder->heldByTask.end())
+                return;
+
+            auto& held = task->second;
+            held.erase(std::remove(held.begin(), held.end(), mutex), held.end());
+        }
+
+        static void LockOrderDeleted(QueueHandle_t mutex)
+        {
+            if (s_lockOrder == nullptr)
+                return;
 
-            return std::any_of(s_mutexes->begin(), s_mutexes->end(), [](QueueDefinition* mutex)
+            //the handle may be reused by a later mutex
+            for (auto& task : s_lockOrder->heldByTask)
             {
-                return uxSemaphoreGetCount(mutex) == 0;
-            });
+                auto& held = task.second;
+                held.erase(std::remove(held.begin(), held.end(), mutex), held.end());
+            }
+            s_lockOrder->takenWhileHeld.erase(mutex);
+            for (auto& edges : s_lockOrder->takenWhileHeld)
+            {
+                edges.second.erase(mutex);
+            }
+        }
+
+        static TickType_t ToTicks(std::chrono::nanoseconds duration)
+        {
+            auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+            return pdMS_TO_TICKS(milliseconds.count());
+        }
+
+        static std::string ProfileKey(QueueHandle_t mutex)
+        {
+            return MutexName(mutex).asCharString();
+        }
+
+        static void Accumulate(MutexProfile& into, const MutexProfile& from)
+        {
+            into.acquisitions += from.acquisitions;
+            into.failedTakes += from.failedTakes;
+            into.maxRecursiveDepth = std::max(into.maxRecursiveDepth, from.maxRecursiveDepth);
+            into.maxHoldTicks = std::max(into.maxHoldTicks, from.maxHoldTicks);
+            into.totalHoldTicks += from.totalHoldTicks;
+            into.maxHoldHostTime = std::max(into.maxHoldHostTime, from.maxHoldHostTime);
+            into.totalHoldHostTime += from.totalHoldHostTime;
+            for (const auto& depth : from.recursiveDepthHistogram)
+            {
+                into.recursiveDepthHistogram[depth.first] += depth.second;
+            }
+        }
+
+        static void AddHold(MutexProfile& profile, const MutexProfileRecord& record)
+        {
+            auto ticks = ToTicks(GetVirtualTime() - record.heldSinceVirtual);
+            auto host = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - record.heldSinceHost);
+            profile.maxHoldTicks = std::max(profile.maxHoldTicks, ticks);
+            profile.totalHoldTicks += ticks;
+            profile.maxHoldHostTime = std::max(profile.maxHoldHostTime, host);
+            profile.totalHoldHostTime += host;
+        }
+
+        static void ProfileTaken(QueueHandle_t mutex)
+        {
+            if (s_profiles == nullptr)
+                return;
+
+            auto& record = s_profiles->active[mutex];
+            record.profile.acquisitions++;
+            record.profile.maxRecursiveDepth = std::max<uint64_t>(record.profile.maxRecursiveDepth, 1);
+            record.isHeld = true;
+            record.heldSinceVirtual = GetVirtualTime();
+            record.heldSinceHost = std::chrono::steady_clock::now();
+        }
+
+        static void ProfileGiven(QueueHandle_t mutex)
+        {
+            if (s_profiles == nullptr)
+                return;
+
+            auto iter = s_profiles->active.find(mutex);
+            if ((iter == s_profiles->active.end()) || !iter->second.isHeld)
+                return;
+
+            AddHold(iter->second.profile, iter->second);
+            iter->second.isHeld = false;
+        }
+
+        static void ProfileDeleted(QueueHandle_t mutex)
+        {
+            if (s_profiles == nullptr)
+                return;
+
+            ProfileGiven(mutex);
+            auto iter = s_profiles->active.find(mutex);
+            if (iter == s_profiles->active.end())
+                return;
+
+            Accumulate(s_profiles->deleted[ProfileKey(mutex)], iter->second.profile);
+            s_profiles->active.erase(iter);
+        }
+
+        void MutexRecursiveDepth(QueueHandle_t mutex)
+        {
+            StartMutexRecords();
+            if (s_profiles == nullptr)
+                return;
+
+            auto& profile = s_profiles->active[mutex].profile;
+            profile.maxRecursiveDepth = std::max(profile.maxRecursiveDepth, mutex->recursiveCallCount);
+            profile.recursiveDepthHistogram[mutex->recursiveCallCount]++;
+        }
+
+        bool IsMutex(const FakeQueue * queue)
+        {
+            return (queue->queueType == queueQUEUE_TYPE_MUTEX) ||
+                   (queue->queueType == queueQUEUE_TYPE_RECURSIVE_MUTEX);
         }
 
         void MutexAboutToDelete(QueueHandle_t mutex)
         {
-            if (s_mutexes == nullptr)
+            ProfileDeleted(mutex);
+            LockOrderDeleted(mutex);
+            if (mutex->mutexHolder != nullptr)
+            {
+                TaskMutexGiven(mutex->mutexHolder);
+                mutex->mutexHolder = nullptr;
+            }
+            EndInversions(mutex);
+            Untrack(mutex);
+        }
+
+        void MutexTaken(QueueHandle_t mutex)
+        {
+            StartMutexRecords();
+            mutex->mutexHolder = xTaskGetCurrentTaskHandle();
+            TaskMutexTaken(mutex->mutexHolder);
+            if (IsTracked(mutex))
+            {
+                s_lockedCount++;
+            }
+            ProfileTaken(mutex);
+            LockOrderTaken(mutex);
+        }
+
+        void MutexGiven(QueueHandle_t mutex)
+        {
+            ProfileGiven(mutex);
+            LockOrderGiven(mutex);
+            TaskMutexGiven(mutex->mutexHolder);
+            mutex->mutexHolder = nullptr;
+            EndInversions(mutex);
+            if (IsTracked(mutex))
+            {
+                s_lockedCount--;
+            }
+        }
+
+        void MutexTakeFailed(QueueHandle_t mutex, TickType_t ticks)
+        {
+            StartMutexRecords();
+            if (s_profiles != nullptr)
+            {
+                s_profiles->active[mutex].profile.failedTakes++;
+            }
+
+            if (ticks == 0)
+                return;
+
+            TaskHandle_t waiter = xTaskGetCurrentTaskHandle();
+            TaskHandle_t holder = mutex->mutexHolder;
+            if ((s_inversions == nullptr) || (waiter == nullptr) || (holder == nullptr))
                 return;
 
-            s_mutexes->remove(mutex);
+            auto waiterPriority = uxTaskPriorityGet(waiter);
+            auto holderPriority = uxTaskPriorityGet(holder);
+            if (waiterPriority <= holderPriority)
+                return;
+
+            //a retry by the same waiter is the same inversion
+            for (const auto& record : *s_inversions)
+            {
+                if (record.inversion.isActive && (record.inversion.mutex == mutex) &&
+                    (record.inversion.waiter == waiter))
+                {
+                    return;
+                }
+            }
+
+            InversionRecord record = {};
+            record.inversion.mutex = mutex;
+            record.inversion.holder = holder;
+            record.inversion.holderPriority = holderPriority;
+            record.inversion.waiter = waiter;
+            record.inversion.waiterPriority = waiterPriority;
+            record.inversion.start = GetVirtualTime();
+            record.inversion.isActive = true;
+            record.maxWait = (ticks == portMAX_DELAY) ?
+                             std::chrono::nanoseconds::max() :
+                             std::chrono::milliseconds(pdTICKS_TO_MS(ticks));
+            s_inversions->push_back(record);
+
+            //as the kernel does, the holder inherits the waiter's priority
+            TaskPriorityInherit(holder, waiterPriority);
+        }
+
+        std::vector<PriorityInversion> GetPriorityInversions()
+        {
+            std::vector<PriorityInversion> inversions;
+            if (s_inversions == nullptr)
+                return inversions;
+
+            for (const auto& record : *s_inversions)
+            {
+                auto inversion = record.inversion;
+                if (inversion.isActive)
+                {
+                    inversion.duration = CurrentDuration(record);
+                }
+                inversions.push_back(inversion);
+            }
+            return inversions;
+        }
+
+        std::chrono::nanoseconds GetMaxPriorityInversionDuration()
+        {
+            std::chrono::nanoseconds longest = std::chrono::nanoseconds::zero();
+            for (const auto& inversion : GetPriorityInversions())
+            {
+                longest = std::max(longest, inversion.duration);
+            }
+            return longest;
+        }
+
+        std::vector<LockOrderViolation> GetLockOrderViolations()
+        {
+            if (s_lockOrder == nullptr)
+                return {};
+
+            return s_lockOrder->violations;
+        }
+
+        std::map<std::string, MutexProfile> GetMutexProfile()
+        {
+            std::map<std::string, MutexProfile> profiles;
+            if (s_profiles == nullptr)
+                return profiles;
+
+            profiles = s_profiles->deleted;
+            for (const auto& active : s_profiles->active)
+            {
+                auto profile = active.second.profile;
+                if (active.second.isHeld)
+                {
+                    AddHold(profile, active.second);
+                }
+                Accumulate(profiles[ProfileKey(active.first)], profile);
+            }
+            return profiles;
         }
     } //namespace
 }//namespace
 
-extern "C" QueueHandle_t xQueueCreateMutex(const uint8_t queueType)
+static QueueHandle_t InitMutex(QueueHandle_t mutex, const uint8_t queueType)
 {
-    (void)queueType;
-    auto mutex = xQueueGenericCreate(1, 0, queueType);
+    if (mutex == nullptr)
+    {
+        //i.e. the heap is exhausted
+        traceCREATE_MUTEX_FAILED();
+        return nullptr;
+    }
+
+    traceCREATE_MUTEX(mutex);
     switch (queueType) {
         case queueQUEUE_TYPE_MUTEX:
             //wasn't documented, but in experiment, the standard mutex is created unlocked
@@ -101,32 +589,55 @@ extern "C" QueueHandle_t xQueueCreateMutex(const uint8_t queueType)
         default:
             configASSERT(true == false);
     }
-    configASSERT(mutex != nullptr);
-    if (cms::test::s_mutexes != nullptr)
-    {
-        cms::test::s_mutexes->push_back(mutex);
-    }
+    cms::test::Track(mutex);
     return mutex;
 }
 
+extern "C" QueueHandle_t xQueueCreateMutex(const uint8_t queueType)
+{
+    return InitMutex(xQueueGenericCreate(1, 0, queueType), queueType);
+}
+
+extern "C" QueueHandle_t xQueueCreateMutexStatic(const uint8_t queueType, StaticQueue_t * staticQueue)
+{
+    return InitMutex(xQueueGenericCreateStatic(1, 0, nullptr, staticQueue, queueType), queueType);
+}
+
 extern "C" BaseType_t xQueueTakeMutexRecursive(QueueHandle_t mutex,
                                                TickType_t ticks)
 {
-    (void) ticks; //not used
-
     configASSERT(mutex != nullptr);
+    configASSERT(!cms::test::IsInIsrContext());
     configASSERT(mutex->queueType == queueQUEUE_TYPE_RECURSIVE_MUTEX);
+    traceTAKE_MUTEX_RECURSIVE(mutex);
 
     if (1 == uxSemaphoreGetCount(mutex))
     {
         auto rtn = cms::InternalQueueReceive(mutex);
         if (rtn != pdTRUE)
         {
+            traceQUEUE_RECEIVE_FAILED(mutex);
+            traceTAKE_MUTEX_RECURSIVE_FAILED(mutex);
             return rtn;
         }
+        traceQUEUE_RECEIVE(mutex);
+    }
+    else if (mutex->mutexHolder != xTaskGetCurrentTaskHandle())
+    {
+        //held by another task, the calling task would block
+        traceQUEUE_RECEIVE_FAILED(mutex);
+        traceTAKE_MUTEX_RECURSIVE_FAILED(mutex);
+        cms::test::MutexTakeFailed(mutex, ticks);
+        cms::test::TraceEvent(cms::test::TraceOp::MutexTake, mutex, 0, pdFALSE);
+        return pdFALSE;
+    }
+    else
+    {
+        cms::test::TraceEvent(cms::test::TraceOp::MutexTake, mutex, 0, pdTRUE);
     }
 
     mutex->recursiveCallCount++;
+    cms::test::MutexRecursiveDepth(mutex);
     return pdTRUE;
 
 }
@@ -134,19 +645,42 @@ extern "C" BaseType_t xQueueTakeMutexRecursive(QueueHandle_t mutex,
 extern "C" BaseType_t xQueueGiveMutexRecursive(QueueHandle_t mutex)
 {
     configASSERT(mutex != nullptr);
+    configASSERT(!cms::test::IsInIsrContext());
     configASSERT(mutex->queueType == queueQUEUE_TYPE_RECURSIVE_MUTEX);
 
     if (0 == uxSemaphoreGetCount(mutex) && mutex->recursiveCallCount > 0)
     {
+        //only the holder may give a recursive mutex
+        configASSERT(mutex->mutexHolder == xTaskGetCurrentTaskHandle());
+        traceGIVE_MUTEX_RECURSIVE(mutex);
+
         mutex->recursiveCallCount--;
         if (mutex->recursiveCallCount == 0)
         {
             return xSemaphoreGive(mutex);
         }
 
+        cms::test::TraceEvent(cms::test::TraceOp::MutexGive, mutex, 0, pdTRUE);
         return pdTRUE;
     }
 
+    traceGIVE_MUTEX_RECURSIVE_FAILED(mutex);
+    cms::test::TraceEvent(cms::test::TraceOp::MutexGive, mutex, 0, pdFALSE);
     return pdFALSE;
 }
 
+extern "C" TaskHandle_t xQueueGetMutexHolder(QueueHandle_t mutex)
+{
+    configASSERT(mutex != nullptr);
+    if (!cms::test::IsMutex(mutex))
+    {
+        return nullptr;
+    }
+
+    return mutex->mutexHolder;
+}
+
+extern "C" TaskHandle_t xQueueGetMutexHolderFromISR(QueueHandle_t mutex)
+{
+    return xQueueGetMutexHolder(mutex);
+}
@@ -25,69 +25,180 @@
 /// @endcond
 
 #include "cpputest_for_freertos_fake_queue.hpp"
+#include "cpputest_for_freertos_fake_isr.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_fake_memory.hpp"
+#include "cpputest_for_freertos_fake_kernel_objects.hpp"
+#include "cpputest_for_freertos_fake_trace.hpp"
+#include "cpputest_for_freertos_fake_timeline.hpp"
+#include <cstddef>
 #include <cstring>
+#include <new>
 #include "FreeRTOS.h"
 #include "queue.h"
 
+static_assert(sizeof(FakeQueue) <= sizeof(StaticQueue_t),
+              "the fake queue must fit within the caller's StaticQueue_t/StaticSemaphore_t");
+static_assert(alignof(FakeQueue) <= alignof(StaticQueue_t),
+              "the fake queue must be aligned as StaticQueue_t/StaticSemaphore_t");
+
+static cms::test::KernelObjectKind QueueKind(const uint8_t queueType)
+{
+    switch (queueType)
+    {
+        case queueQUEUE_TYPE_MUTEX:
+        case queueQUEUE_TYPE_RECURSIVE_MUTEX:
+            return cms::test::KernelObjectKind::Mutex;
+        case queueQUEUE_TYPE_COUNTING_SEMAPHORE:
+        case queueQUEUE_TYPE_BINARY_SEMAPHORE:
+            return cms::test::KernelObjectKind::Semaphore;
+        default:
+            return cms::test::KernelObjectKind::Queue;
+    }
+}
+
+static void TimelineQueueLevel(const FakeQueue * queue)
+{
+    //a mutex's level is its lock state, see the mutex tracking instead
+    if (cms::test::TimelineIsActive() && !cms::test::IsMutex(queue))
+    {
+        cms::test::TimelineQueueLevel(queue, queue->registryName, queue->messagesWaiting);
+    }
+}
+
+static cms::test::TraceOp QueueTraceOp(const FakeQueue * queue, const bool isSend)
+{
+    switch (QueueKind(queue->queueType))
+    {
+        case cms::test::KernelObjectKind::Mutex:
+            return isSend ? cms::test::TraceOp::MutexGive : cms::test::TraceOp::MutexTake;
+        case cms::test::KernelObjectKind::Semaphore:
+            return isSend ? cms::test::TraceOp::SemaphoreGive : cms::test::TraceOp::SemaphoreTake;
+        default:
+            return isSend ? cms::test::TraceOp::QueueSend : cms::test::TraceOp::QueueReceive;
+    }
+}
+
 extern "C" QueueHandle_t xQueueGenericCreate(const UBaseType_t queueLength,
                                              const UBaseType_t itemSize,
                                              const uint8_t queueType)
 {
-    auto queue = new FakeQueue();
+    //as with the kernel, one allocation holds the control block and the storage
+    auto footprint = CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE + (static_cast<size_t>(queueLength) * itemSize);
+    auto charge = cms::test::ChargeHeap(footprint);
+    if (charge.block == nullptr)
+    {
+        traceQUEUE_CREATE_FAILED(queueType);
+        cms::test::KernelObjectCreated(QueueKind(queueType), nullptr, footprint);
+        return nullptr;
+    }
+    cms::test::DynamicAllocationMade();
+
+    auto queue = cms::test::ArenaNew<FakeQueue>();
+    queue->heapCharge = charge;
     queue->queueLength = queueLength;
     queue->itemSize = itemSize;
     queue->queueType = queueType;
+    if (itemSize != 0U)
+    {
+        queue->storage = static_cast<uint8_t *>(cms::test::ArenaAllocate(static_cast<size_t>(queueLength) * itemSize,
+                                                                          alignof(std::max_align_t)));
+    }
+    traceQUEUE_CREATE(queue);
+    cms::test::KernelObjectCreated(QueueKind(queueType), queue, footprint);
     return queue;
 }
 
-namespace cms{
-    namespace test {
-        extern void MutexAboutToDelete(QueueHandle_t mutex);
-    }
-}
 extern "C" void vQueueDelete(QueueHandle_t queue)
 {
     configASSERT(queue != nullptr);
-    if (queue->queueType == queueQUEUE_TYPE_MUTEX)
+    traceQUEUE_DELETE(queue);
+    if (cms::test::IsMutex(queue))
     {
         cms::test::MutexAboutToDelete(queue);
     }
-    delete queue;
+    cms::test::IsrObjectDeleted(queue);
+    cms::test::KernelObjectDeleted(queue);
+    if (queue->isStatic)
+    {
+        queue->~QueueDefinition();
+    }
+    else
+    {
+        cms::test::ReleaseHeap(queue->heapCharge);
+        cms::test::ArenaFree(queue->storage);
+        cms::test::ArenaDelete(queue);
+    }
 }
 
 extern "C" UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t queue)
 {
     configASSERT(queue != nullptr);
-    return queue->queue.size();
+    configASSERT(!cms::test::IsInIsrContext());
+    return queue->messagesWaiting;
+}
+
+extern "C" UBaseType_t uxQueueMessagesWaitingFromISR(const QueueHandle_t queue)
+{
+    configASSERT(queue != nullptr);
+    return queue->messagesWaiting;
 }
 
 extern "C" UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t queue)
 {
     configASSERT(queue != nullptr);
-    return queue->queueLength - uxQueueMessagesWaiting(queue);
+    return queue->queueLength - queue->messagesWaiting;
+}
+
+extern "C" BaseType_t xQueueIsQueueEmptyFromISR(const QueueHandle_t queue)
+{
+    configASSERT(queue != nullptr);
+    return (queue->messagesWaiting == 0) ? pdTRUE : pdFALSE;
+}
+
+extern "C" BaseType_t xQueueIsQueueFullFromISR(const QueueHandle_t queue)
+{
+    configASSERT(queue != nullptr);
+    return (queue->messagesWaiting >= queue->queueLength) ? pdTRUE : pdFALSE;
 }
 
 BaseType_t cms::InternalQueueReceive(FakeQueue * queue)
 {
     configASSERT(queue != nullptr);
 
-    uint64_t dummy;
-    return cms::InternalQueueReceive(queue, &dummy);
+    return cms::InternalQueueReceive(queue, nullptr);
+}
+
+static uint8_t * QueueSlot(const FakeQueue * queue, size_t index)
+{
+    return queue->storage + ((index % queue->queueLength) * queue->itemSize);
 }
 
 BaseType_t cms::InternalQueueReceive(FakeQueue * queue, void * const buffer)
 {
     configASSERT(queue != nullptr);
 
-    if (!queue->queue.empty())
+    if (queue->messagesWaiting != 0)
     {
-        auto front = queue->queue.front();
-        memcpy(buffer, front.data(), queue->itemSize);
-        queue->queue.pop_front();
+        if ((buffer != nullptr) && (queue->itemSize != 0U))
+        {
+            memcpy(buffer, QueueSlot(queue, queue->head), queue->itemSize);
+        }
+        queue->head = static_cast<UBaseType_t>((queue->head + 1U) % queue->queueLength);
+        queue->messagesWaiting--;
+
+        if (cms::test::IsMutex(queue))
+        {
+            cms::test::MutexTaken(queue);
+        }
+        cms::test::IsrEventReceived(queue);
+        cms::test::TraceEvent(QueueTraceOp(queue, false), queue, queue->itemSize, pdTRUE);
+        TimelineQueueLevel(queue);
         return pdTRUE;
     }
     else
     {
+        cms::test::TraceEvent(QueueTraceOp(queue, false), queue, queue->itemSize, pdFALSE);
         return pdFALSE;
     }
 }
@@ -96,9 +207,42 @@ extern "C" BaseType_t xQueueReceive(QueueHandle_t queue, void * const buffer, Ti
 {
     configASSERT(queue != nullptr);
     configASSERT(buffer != nullptr);
+    configASSERT(!cms::test::IsInIsrContext());
 
     (void)ticks; //in our unit testing fake, never honor ticks to wait.
-    return cms::InternalQueueReceive(queue, buffer);
+    auto rtn = cms::InternalQueueReceive(queue, buffer);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_RECEIVE(queue);
+    }
+    else
+    {
+        traceQUEUE_RECEIVE_FAILED(queue);
+    }
+    return rtn;
+}
+
+extern "C" BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void * const buffer,
+                                           BaseType_t * const pxHigherPriorityTaskWoken)
+{
+    configASSERT(queue != nullptr);
+    configASSERT(!((buffer == nullptr) && (queue->itemSize != 0U)));
+
+    //no task is ever blocked sending, hence no task is woken.
+    (void)pxHigherPriorityTaskWoken;
+
+    //i.e. xSemaphoreTakeFromISR when there is no buffer
+    auto rtn = (buffer == nullptr) ? cms::InternalQueueReceive(queue) :
+                                     cms::InternalQueueReceive(queue, buffer);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_RECEIVE_FROM_ISR(queue);
+    }
+    else
+    {
+        traceQUEUE_RECEIVE_FROM_ISR_FAILED(queue);
+    }
+    return rtn;
 }
 
 extern "C" BaseType_t xQueueGenericSend(QueueHandle_t queue,
@@ -107,74 +251,173 @@ extern "C" BaseType_t xQueueGenericSend(QueueHandle_t queue,
                                         const BaseType_t copyPosition)
 {
     (void)ticks;
+    configASSERT(!cms::test::IsInIsrContext());
+    auto rtn = cms::InternalQueueSend(queue, itemToQueue, copyPosition);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_SEND(queue);
+    }
+    else
+    {
+        traceQUEUE_SEND_FAILED(queue);
+    }
+    return rtn;
+}
+
+extern "C" BaseType_t xQueueGenericSendFromISR(QueueHandle_t queue,
+                                               const void * const itemToQueue,
+                                               BaseType_t * const pxHigherPriorityTaskWoken,
+                                               const BaseType_t copyPosition)
+{
+    auto rtn = cms::InternalQueueSend(queue, itemToQueue, copyPosition);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_SEND_FROM_ISR(queue);
+        cms::test::IsrEventPosted(queue);
+
+        //assume the receiving task is waiting, and is the highest priority task.
+        if (pxHigherPriorityTaskWoken != nullptr)
+        {
+            *pxHigherPriorityTaskWoken = pdTRUE;
+        }
+    }
+    else
+    {
+        traceQUEUE_SEND_FROM_ISR_FAILED(queue);
+    }
+
+    return rtn;
+}
+
+BaseType_t cms::InternalQueueSend(FakeQueue * queue,
+                                  const void * const itemToQueue,
+                                  const BaseType_t copyPosition)
+{
     configASSERT(queue != nullptr);
     configASSERT(!((itemToQueue == nullptr) && (queue->itemSize != 0U)));
     configASSERT(!((copyPosition == queueOVERWRITE) && (queue->queueLength != 1)));
 
+    configASSERT((copyPosition == queueSEND_TO_BACK) ||
+                 (copyPosition == queueSEND_TO_FRONT) ||
+                 (copyPosition == queueOVERWRITE));
+
     if ((copyPosition != queueOVERWRITE) &&
-        (queue->queue.size() >= queue->queueLength))
+        (queue->messagesWaiting >= queue->queueLength))
     {
+        cms::test::TraceEvent(QueueTraceOp(queue, true), queue, queue->itemSize, errQUEUE_FULL);
         return errQUEUE_FULL;
     }
 
-    std::vector<uint8_t> msg;
-    msg.resize(queue->itemSize);
-    memcpy(msg.data(), itemToQueue, queue->itemSize);
-
+    //semaphores and mutexes have no storage, only a count of available tokens
+    size_t slot;
     if (copyPosition == queueSEND_TO_BACK)
     {
-        queue->queue.push_back(msg);
+        slot = queue->head + queue->messagesWaiting;
+        queue->messagesWaiting++;
     }
     else if (copyPosition == queueSEND_TO_FRONT)
     {
-        queue->queue.push_front(msg);
+        queue->head = static_cast<UBaseType_t>((queue->head + queue->queueLength - 1U) % queue->queueLength);
+        slot = queue->head;
+        queue->messagesWaiting++;
     }
-    else if (copyPosition == queueOVERWRITE)
+    else
     {
-        queue->queue.pop_front();
-        queue->queue.push_front(msg);
+        slot = queue->head;
+        queue->messagesWaiting = 1;
     }
-    else
+
+    if (queue->itemSize != 0U)
     {
-        configASSERT(true == false);
+        memcpy(QueueSlot(queue, slot), itemToQueue, queue->itemSize);
     }
 
+    if (cms::test::IsMutex(queue))
+    {
+        cms::test::MutexGiven(queue);
+    }
+    cms::test::TraceEvent(QueueTraceOp(queue, true), queue, queue->itemSize, pdTRUE);
+    TimelineQueueLevel(queue);
+
     if (queue->queueSetContainer != nullptr)
     {
-        xQueueGenericSend(queue->queueSetContainer, &queue, ticks, queueSEND_TO_BACK);
+        traceQUEUE_SET_SEND(queue->queueSetContainer);
+        cms::InternalQueueSend(queue->queueSetContainer, &queue, queueSEND_TO_BACK);
     }
 
     return pdTRUE;
 }
 
-extern "C" BaseType_t xQueuePeek(QueueHandle_t queue, void * const buffer, TickType_t ticks)
+static BaseType_t QueuePeek(QueueHandle_t queue, void * const buffer)
 {
     configASSERT(queue != nullptr);
-    (void)ticks; //in our unit testing fake, never honor ticks to wait.
 
-    if (!queue->queue.empty())
+    if (queue->messagesWaiting != 0)
     {
-        auto front = queue->queue.front();
-        memcpy(buffer, front.data(), queue->itemSize);
+        if (queue->itemSize != 0U)
+        {
+            memcpy(buffer, QueueSlot(queue, queue->head), queue->itemSize);
+        }
+        cms::test::TraceEvent(cms::test::TraceOp::QueuePeek, queue, queue->itemSize, pdTRUE);
         return pdTRUE;
     }
     else
     {
+        cms::test::TraceEvent(cms::test::TraceOp::QueuePeek, queue, queue->itemSize, pdFALSE);
         return pdFALSE;
     }
 }
 
+extern "C" BaseType_t xQueuePeek(QueueHandle_t queue, void * const buffer, TickType_t ticks)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+    (void)ticks; //in our unit testing fake, never honor ticks to wait.
+    auto rtn = QueuePeek(queue, buffer);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_PEEK(queue);
+    }
+    else
+    {
+        traceQUEUE_PEEK_FAILED(queue);
+    }
+    return rtn;
+}
+
+extern "C" BaseType_t xQueuePeekFromISR(QueueHandle_t queue, void * const buffer)
+{
+    auto rtn = QueuePeek(queue, buffer);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_PEEK_FROM_ISR(queue);
+    }
+    else
+    {
+        traceQUEUE_PEEK_FROM_ISR_FAILED(queue);
+    }
+    return rtn;
+}
+
 extern "C" QueueHandle_t xQueueGenericCreateStatic(const UBaseType_t queueLength,
                                         const UBaseType_t itemSize,
                                         uint8_t * queueStorage,
                                         StaticQueue_t * staticQueue,
                                         const uint8_t queueType)
 {
-    //for unit testing, just going to ignore the provided static queue and allocate
-    //dynamically.
-    (void)queueStorage;
-    (void)staticQueue;
-    auto queue = xQueueGenericCreate(queueLength, itemSize, queueType);
+    configASSERT(staticQueue != nullptr);
+    configASSERT(!((queueStorage == nullptr) && (itemSize != 0U)));
+    configASSERT(!((queueStorage != nullptr) && (itemSize == 0U)));
+
+    //as with the kernel, the control block lives in the caller's buffer
+    auto queue = new (staticQueue) FakeQueue();
+    queue->queueLength = queueLength;
+    queue->itemSize = itemSize;
+    queue->queueType = queueType;
+    queue->storage = queueStorage;
+    queue->isStatic = true;
+    traceQUEUE_CREATE(queue);
+    cms::test::StaticKernelObjectCreated(QueueKind(queueType), queue,
+                                         CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE + (static_cast<size_t>(queueLength) * itemSize));
     return queue;
 }
 
@@ -183,6 +426,8 @@ extern "C" void vQueueAddToRegistry(QueueHandle_t queue, const char * queueName)
     configASSERT(queue != nullptr);
     configASSERT(queueName != nullptr);
     queue->registryName = queueName;
+    traceQUEUE_REGISTRY_ADD(queue, queueName);
+    cms::test::KernelObjectNamed(queue, queueName);
 }
 
 extern "C" const char * pcQueueGetName(QueueHandle_t queue)
@@ -195,4 +440,5 @@ extern "C" void vQueueUnregisterQueue(QueueHandle_t queue)
 {
     configASSERT(queue != nullptr);
     queue->registryName = nullptr;
+    cms::test::KernelObjectNamed(queue, nullptr);
 }
\ No newline at end of file
@@ -42,7 +42,7 @@ extern "C" BaseType_t xQueueAddToSet(QueueSetMemberHandle_t itemToAdd, QueueSetH
     configASSERT(fakeSet != nullptr);
 
     if ((fakeItemToAdd->queueSetContainer != nullptr) ||
-        (!fakeItemToAdd->queue.empty()))
+        (fakeItemToAdd->messagesWaiting != 0))
     {
         return pdFAIL;
     }
@@ -61,7 +61,7 @@ extern "C" BaseType_t xQueueRemoveFromSet(QueueSetMemberHandle_t itemToRemove, Q
     configASSERT(set != nullptr);
 
     if ((fakeItemToRemove->queueSetContainer != set) ||
-        (!fakeItemToRemove->queue.empty()))
+        (fakeItemToRemove->messagesWaiting != 0))
     {
         return pdFAIL;
     }
@@ -83,4 +83,17 @@ extern "C" QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t queueSet,
     }
 
     return nullptr;
-}
\ No newline at end of file
+}
+
+extern "C" QueueSetMemberHandle_t xQueueSelectFromSetFromISR(QueueSetHandle_t queueSet)
+{
+    QueueSetMemberHandle_t rtnItem = nullptr;
+
+    auto result = cms::InternalQueueReceive(queueSet, &rtnItem);
+    if (result == pdTRUE)
+    {
+        return rtnItem;
+    }
+
+    return nullptr;
+}
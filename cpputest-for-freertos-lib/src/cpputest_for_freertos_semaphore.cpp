@@ -26,17 +26,37 @@
 /// @endcond
 
 #include "cpputest_for_freertos_fake_queue.hpp"
+#include "cpputest_for_freertos_fake_isr.hpp"
+#include "cpputest_for_freertos_isr.hpp"
 #include <cstring>
 #include "queue.h"
 #include "semphr.h"
 
 extern "C" BaseType_t xQueueSemaphoreTake(QueueHandle_t queue, TickType_t ticks)
 {
-    (void) ticks;  //ignore in cpputest fake semaphore
+    //ticks are not honored in cpputest fake semaphore, only used
+    //to detect a task which would be waiting on a mutex.
     configASSERT(queue != nullptr);
     configASSERT(queue->queueType != queueQUEUE_TYPE_RECURSIVE_MUTEX);
+    configASSERT(!cms::test::IsInIsrContext());
 
-    return cms::InternalQueueReceive(queue);
+    auto rtn = cms::InternalQueueReceive(queue);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_RECEIVE(queue);
+    }
+    else
+    {
+        traceQUEUE_RECEIVE_FAILED(queue);
+    }
+
+    if ((queue->queueType == queueQUEUE_TYPE_MUTEX) && (rtn != pdTRUE))
+    {
+        //the calling task would block on the mutex, or gave up
+        cms::test::MutexTakeFailed(queue, ticks);
+    }
+
+    return rtn;
 }
 
 
@@ -46,23 +66,58 @@ extern "C" BaseType_t xQueueGiveFromISR(QueueHandle_t queue,
     configASSERT(queue != nullptr);
     configASSERT(queue->queueType != queueQUEUE_TYPE_RECURSIVE_MUTEX);
 
-    (void)pxHigherPriorityTaskWoken;
-    return xSemaphoreGive(queue);
+    auto rtn = cms::InternalQueueSend(queue, nullptr, queueSEND_TO_BACK);
+    if (rtn == pdTRUE)
+    {
+        traceQUEUE_SEND_FROM_ISR(queue);
+        cms::test::IsrEventPosted(queue);
+
+        //assume the task taking the semaphore is waiting, and is the highest priority task.
+        if (pxHigherPriorityTaskWoken != nullptr)
+        {
+            *pxHigherPriorityTaskWoken = pdTRUE;
+        }
+    }
+    else
+    {
+        traceQUEUE_SEND_FROM_ISR_FAILED(queue);
+    }
+
+    return rtn;
 }
 
-extern "C" QueueHandle_t xQueueCreateCountingSemaphore(const UBaseType_t maxCount,
-                                                       const UBaseType_t initialCount)
+static QueueHandle_t InitCountingSemaphore(QueueHandle_t sema, const UBaseType_t initialCount)
 {
-    QueueHandle_t sema = xQueueCreate(maxCount, 0);
-    if (sema == nullptr)
+    if (sema != nullptr)
     {
-        return nullptr;
+        sema->messagesWaiting = initialCount;
+        traceCREATE_COUNTING_SEMAPHORE();
     }
-
-    for (int i = 0; i < initialCount; ++i)
+    else
     {
-        xSemaphoreGive(sema);
+        traceCREATE_COUNTING_SEMAPHORE_FAILED();
     }
-
     return sema;
-}
\ No newline at end of file
+}
+
+extern "C" QueueHandle_t xQueueCreateCountingSemaphore(const UBaseType_t maxCount,
+                                                       const UBaseType_t initialCount)
+{
+    configASSERT(maxCount != 0);
+    configASSERT(initialCount <= maxCount);
+
+    return InitCountingSemaphore(xQueueGenericCreate(maxCount, 0, queueQUEUE_TYPE_COUNTING_SEMAPHORE),
+                                 initialCount);
+}
+
+extern "C" QueueHandle_t xQueueCreateCountingSemaphoreStatic(const UBaseType_t maxCount,
+                                                             const UBaseType_t initialCount,
+                                                             StaticQueue_t * staticQueue)
+{
+    configASSERT(maxCount != 0);
+    configASSERT(initialCount <= maxCount);
+
+    auto sema = xQueueGenericCreateStatic(maxCount, 0, nullptr, staticQueue,
+                                          queueQUEUE_TYPE_COUNTING_SEMAPHORE);
+    return InitCountingSemaphore(sema, initialCount);
+}
@@ -0,0 +1,201 @@
+/// @brief Provides the simulated multi-core (SMP) port: the current core,
+///        the recursive TASK and ISR port locks and core yield requests.
+///        Lock acquisitions while another core holds the lock are counted
+///        as contention.
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include <array>
+#include <algorithm>
+#include "cpputest_for_freertos_smp.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+
+//must be last
+#include "CppUTest/TestHarness.h"
+
+namespace cms {
+namespace test {
+
+    struct LockState
+    {
+        std::array<uint32_t, configNUMBER_OF_CORES> depth;
+        SmpLockStats stats;
+        uint32_t releaseMismatches;
+    };
+
+    static constexpr size_t SMP_LOCK_COUNT = 2;
+    static thread_local std::array<LockState, SMP_LOCK_COUNT> s_locks = {};
+    static thread_local std::array<uint32_t, configNUMBER_OF_CORES> s_yieldCoreCount = {};
+    static thread_local BaseType_t s_currentCore = 0;
+
+    static LockState& Lock(SmpLock lock)
+    {
+        return s_locks[static_cast<size_t>(lock)];
+    }
+
+    static size_t CoreIndex(BaseType_t core)
+    {
+        configASSERT((core >= 0) && (core < configNUMBER_OF_CORES));
+        return static_cast<size_t>(core);
+    }
+
+    static void ResetSmp()
+    {
+        s_locks = {};
+        s_yieldCoreCount = {};
+        s_currentCore = 0;
+    }
+
+    void SmpInit()
+    {
+        ResetSmp();
+    }
+
+    void SmpTeardown()
+    {
+        bool isAnyHeld = false;
+        uint32_t mismatches = 0;
+        for (const auto& lock : s_locks)
+        {
+            isAnyHeld |= std::any_of(lock.depth.begin(), lock.depth.end(), [](uint32_t depth)
+            {
+                return depth != 0;
+            });
+            mismatches += lock.releaseMismatches;
+        }
+
+        ResetSmp();
+
+        if (isAnyHeld)
+        {
+            FAIL_TEST("An SMP port lock is still held by a core.");
+        }
+
+        if (mismatches != 0)
+        {
+            FAIL_TEST("An SMP port lock was released by a core which did not hold it.");
+        }
+    }
+
+    void SetCurrentCore(BaseType_t core)
+    {
+        (void)CoreIndex(core);
+        s_currentCore = core;
+    }
+
+    BaseType_t GetCurrentCore()
+    {
+        return s_currentCore;
+    }
+
+    SmpLockStats GetSmpLockStats(SmpLock lock)
+    {
+        return Lock(lock).stats;
+    }
+
+    bool IsSmpLockHeld(SmpLock lock, BaseType_t core)
+    {
+        return Lock(lock).depth[CoreIndex(core)] != 0;
+    }
+
+    uint32_t GetYieldCoreCount(BaseType_t core)
+    {
+        return s_yieldCoreCount[CoreIndex(core)];
+    }
+
+    void SmpLockAcquire(SmpLock lock)
+    {
+        auto& state = Lock(lock);
+        auto core = CoreIndex(s_currentCore);
+
+        //recursive, only the outermost acquisition is of interest
+        if (state.depth[core] == 0)
+        {
+            state.stats.acquisitions++;
+            for (size_t other = 0; other < state.depth.size(); ++other)
+            {
+                if ((other != core) && (state.depth[other] != 0))
+                {
+                    //target hardware would spin here, until the
+                    //other core releases the lock.
+                    state.stats.contentions++;
+                    break;
+                }
+            }
+        }
+
+        state.depth[core]++;
+    }
+
+    void SmpLockRelease(SmpLock lock)
+    {
+        auto& state = Lock(lock);
+        auto core = CoreIndex(s_currentCore);
+        if (state.depth[core] == 0)
+        {
+            state.releaseMismatches++;
+            return;
+        }
+
+        state.depth[core]--;
+    }
+
+} //namespace test
+} //namespace cms
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+using namespace cms::test;
+
+extern "C" BaseType_t cmsPortGetCoreId(void)
+{
+    return GetCurrentCore();
+}
+
+extern "C" void cmsPortYieldCore(BaseType_t core)
+{
+    s_yieldCoreCount[CoreIndex(core)]++;
+}
+
+extern "C" void cmsPortGetTaskLock(void)
+{
+    SmpLockAcquire(SmpLock::Task);
+}
+
+extern "C" void cmsPortReleaseTaskLock(void)
+{
+    SmpLockRelease(SmpLock::Task);
+}
+
+extern "C" void cmsPortGetIsrLock(void)
+{
+    SmpLockAcquire(SmpLock::Isr);
+}
+
+extern "C" void cmsPortReleaseIsrLock(void)
+{
+    SmpLockRelease(SmpLock::Isr);
+}
+
+#endif /* if ( configNUMBER_OF_CORES > 1 ) */
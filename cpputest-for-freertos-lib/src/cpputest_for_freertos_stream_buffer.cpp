@@ -0,0 +1,551 @@
+/// @brief Provides an implementation of fake FreeRTOS stream buffers
+///        and message buffers, which, like FreeRTOS, are the same object.
+///        cpputest-for-freertos-lib assumes that a stream buffer should be
+///        functional, i.e. not a mock. No blocking is implemented.
+///
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include "cpputest_for_freertos_stream_buffer.hpp"
+#include "cpputest_for_freertos_fake_isr.hpp"
+#include "cpputest_for_freertos_fake_memory.hpp"
+#include "cpputest_for_freertos_fake_kernel_objects.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "FreeRTOS.h"
+#include "stream_buffer.h"
+
+struct StreamBufferExtras
+{
+    cms::test::StreamBufferStats stats = {};
+    std::chrono::nanoseconds created = {};
+    cms::test::HeapCharge heapCharge; ///< the kernel's allocation, when created dynamically
+};
+
+typedef struct StreamBufferDef_t
+{
+    uint8_t * storage = nullptr;  ///< a single contiguous ring of length bytes
+    size_t length = {};
+    size_t head = {};             ///< index of the oldest byte
+    size_t bytesBuffered = {};
+    size_t triggerLevel = {};
+    StreamBufferExtras * extras = nullptr;
+    #if (configUSE_SB_COMPLETED_CALLBACK == 1)
+        StreamBufferCallbackFunction_t sendCompletedCallback = nullptr;
+        StreamBufferCallbackFunction_t receiveCompletedCallback = nullptr;
+    #endif
+    BaseType_t type = {};
+    bool isStatic = false;        ///< control block and storage were provided by the caller
+} FakeStreamBuffer;
+
+static_assert(sizeof(FakeStreamBuffer) <= sizeof(StaticStreamBuffer_t),
+              "the fake stream buffer must fit within the caller's StaticStreamBuffer_t");
+static_assert(alignof(FakeStreamBuffer) <= alignof(StaticStreamBuffer_t),
+              "the fake stream buffer must be aligned as StaticStreamBuffer_t");
+
+static constexpr size_t MESSAGE_LENGTH_BYTES = sizeof(configMESSAGE_BUFFER_LENGTH_TYPE);
+
+static bool IsMessageBuffer(const FakeStreamBuffer * buffer)
+{
+    return buffer->type == sbTYPE_MESSAGE_BUFFER;
+}
+
+static size_t SpacesAvailable(const FakeStreamBuffer * buffer)
+{
+    return buffer->length - buffer->bytesBuffered;
+}
+
+static void RingWrite(FakeStreamBuffer * buffer, const void * data, size_t count)
+{
+    auto tail = (buffer->head + buffer->bytesBuffered) % buffer->length;
+    auto firstChunk = std::min(count, buffer->length - tail);
+    memcpy(buffer->storage + tail, data, firstChunk);
+    memcpy(buffer->storage, static_cast<const uint8_t *>(data) + firstChunk, count - firstChunk);
+    buffer->bytesBuffered += count;
+}
+
+static void RingPeek(const FakeStreamBuffer * buffer, void * data, size_t count)
+{
+    auto firstChunk = std::min(count, buffer->length - buffer->head);
+    memcpy(data, buffer->storage + buffer->head, firstChunk);
+    memcpy(static_cast<uint8_t *>(data) + firstChunk, buffer->storage, count - firstChunk);
+}
+
+static void RingConsume(FakeStreamBuffer * buffer, size_t count)
+{
+    buffer->head = (buffer->head + count) % buffer->length;
+    buffer->bytesBuffered -= count;
+}
+
+static size_t NextMessageLength(const FakeStreamBuffer * buffer)
+{
+    if (buffer->bytesBuffered < MESSAGE_LENGTH_BYTES)
+    {
+        return 0;
+    }
+
+    configMESSAGE_BUFFER_LENGTH_TYPE messageLength;
+    RingPeek(buffer, &messageLength, MESSAGE_LENGTH_BYTES);
+    return static_cast<size_t>(messageLength);
+}
+
+static size_t ValidateTriggerLevel(size_t bufferSizeBytes, size_t triggerLevelBytes, BaseType_t type)
+{
+    configASSERT(bufferSizeBytes != 0);
+    configASSERT(triggerLevelBytes <= bufferSizeBytes);
+    configASSERT((type == sbTYPE_STREAM_BUFFER) ||
+                 (type == sbTYPE_MESSAGE_BUFFER) ||
+                 (type == sbTYPE_STREAM_BATCHING_BUFFER));
+    if (type == sbTYPE_MESSAGE_BUFFER)
+    {
+        configASSERT(bufferSizeBytes > MESSAGE_LENGTH_BYTES);
+    }
+
+    //as with the kernel, a trigger level of zero behaves as one
+    return (triggerLevelBytes == 0) ? 1 : triggerLevelBytes;
+}
+
+static FakeStreamBuffer * InitStreamBuffer(FakeStreamBuffer * buffer, uint8_t * storage,
+                                           size_t bufferSizeBytes, size_t triggerLevelBytes,
+                                           BaseType_t type,
+                                           StreamBufferCallbackFunction_t sendCompletedCallback,
+                                           StreamBufferCallbackFunction_t receiveCompletedCallback)
+{
+    buffer->storage = storage;
+    buffer->length = bufferSizeBytes;
+    buffer->triggerLevel = triggerLevelBytes;
+    buffer->type = type;
+    buffer->extras = cms::test::ArenaNew<StreamBufferExtras>();
+    buffer->extras->created = cms::test::GetVirtualTime();
+
+    #if (configUSE_SB_COMPLETED_CALLBACK == 1)
+        buffer->sendCompletedCallback = sendCompletedCallback;
+        buffer->receiveCompletedCallback = receiveCompletedCallback;
+    #else
+        (void)sendCompletedCallback;
+        (void)receiveCompletedCallback;
+    #endif
+    return buffer;
+}
+
+static void SendCompleted(FakeStreamBuffer * buffer, BaseType_t isInsideIsr, BaseType_t * const woken)
+{
+    #if (configUSE_SB_COMPLETED_CALLBACK == 1)
+        if (buffer->sendCompletedCallback != nullptr)
+        {
+            buffer->sendCompletedCallback(buffer, isInsideIsr, woken);
+            return;
+        }
+    #else
+        (void)isInsideIsr;
+    #endif
+
+    //assume the receiving task is waiting, and is the highest priority task.
+    cms::test::IsrEventPosted(buffer);
+    if (woken != nullptr)
+    {
+        *woken = pdTRUE;
+    }
+}
+
+static void ReceiveCompleted(FakeStreamBuffer * buffer, BaseType_t isInsideIsr, BaseType_t * const woken)
+{
+    #if (configUSE_SB_COMPLETED_CALLBACK == 1)
+        if (buffer->receiveCompletedCallback != nullptr)
+        {
+            buffer->receiveCompletedCallback(buffer, isInsideIsr, woken);
+        }
+    #else
+        //no task is ever blocked sending, hence no task is woken.
+        (void)buffer;
+        (void)isInsideIsr;
+        (void)woken;
+    #endif
+}
+
+static size_t Send(FakeStreamBuffer * buffer, const void * data, size_t dataLength,
+                   BaseType_t isInsideIsr, BaseType_t * const woken)
+{
+    configASSERT(buffer != nullptr);
+    configASSERT(data != nullptr);
+
+    auto& stats = buffer->extras->stats;
+    stats.sends++;
+
+    size_t toWrite;
+    if (IsMessageBuffer(buffer))
+    {
+        configASSERT((dataLength + MESSAGE_LENGTH_BYTES) > dataLength);
+
+        //messages are written completely or not at all
+        if ((dataLength + MESSAGE_LENGTH_BYTES) > SpacesAvailable(buffer))
+        {
+            stats.bytesDropped += dataLength;
+            return 0;
+        }
+
+        auto messageLength = static_cast<configMESSAGE_BUFFER_LENGTH_TYPE>(dataLength);
+        RingWrite(buffer, &messageLength, MESSAGE_LENGTH_BYTES);
+        toWrite = dataLength;
+    }
+    else
+    {
+        toWrite = std::min(dataLength, SpacesAvailable(buffer));
+        stats.bytesDropped += dataLength - toWrite;
+        if (toWrite == 0)
+        {
+            return 0;
+        }
+    }
+
+    RingWrite(buffer, data, toWrite);
+    stats.bytesSent += toWrite;
+    stats.maxBytesBuffered = std::max(stats.maxBytesBuffered, buffer->bytesBuffered);
+
+    if (buffer->bytesBuffered >= buffer->triggerLevel)
+    {
+        SendCompleted(buffer, isInsideIsr, woken);
+    }
+    return toWrite;
+}
+
+static size_t Receive(FakeStreamBuffer * buffer, void * data, size_t bufferLength,
+                      BaseType_t isInsideIsr, BaseType_t * const woken)
+{
+    configASSERT(buffer != nullptr);
+    configASSERT(data != nullptr);
+
+    size_t toRead;
+    if (IsMessageBuffer(buffer))
+    {
+        //a message too large for the caller's buffer is left in place
+        auto messageLength = NextMessageLength(buffer);
+        if ((buffer->bytesBuffered == 0) || (messageLength > bufferLength))
+        {
+            return 0;
+        }
+        RingConsume(buffer, MESSAGE_LENGTH_BYTES);
+        toRead = messageLength;
+    }
+    else if ((buffer->type == sbTYPE_STREAM_BATCHING_BUFFER) &&
+             (buffer->bytesBuffered < buffer->triggerLevel))
+    {
+        //a batching buffer holds bytes until the trigger level is reached
+        return 0;
+    }
+    else
+    {
+        toRead = std::min(bufferLength, buffer->bytesBuffered);
+    }
+
+    if (toRead == 0)
+    {
+        return 0;
+    }
+
+    RingPeek(buffer, data, toRead);
+    RingConsume(buffer, toRead);
+
+    auto& stats = buffer->extras->stats;
+    stats.receives++;
+    stats.bytesReceived += toRead;
+    cms::test::IsrEventReceived(buffer);
+    ReceiveCompleted(buffer, isInsideIsr, woken);
+    return toRead;
+}
+
+extern "C" StreamBufferHandle_t xStreamBufferGenericCreate(size_t xBufferSizeBytes,
+                                                           size_t xTriggerLevelBytes,
+                                                           BaseType_t xStreamBufferType,
+                                                           StreamBufferCallbackFunction_t pxSendCompletedCallback,
+                                                           StreamBufferCallbackFunction_t pxReceiveCompletedCallback)
+{
+    auto triggerLevel = ValidateTriggerLevel(xBufferSizeBytes, xTriggerLevelBytes, xStreamBufferType);
+
+    //as with the kernel, one allocation holds the control block and one byte more than the storage
+    auto kind = (xStreamBufferType == sbTYPE_MESSAGE_BUFFER) ? cms::test::KernelObjectKind::MessageBuffer :
+                                                               cms::test::KernelObjectKind::StreamBuffer;
+    auto footprint = CMS_FREERTOS_TARGET_SIZEOF_STATIC_STREAM_BUFFER + xBufferSizeBytes + 1U;
+    auto charge = cms::test::ChargeHeap(footprint);
+    if (charge.block == nullptr)
+    {
+        traceSTREAM_BUFFER_CREATE_FAILED(xStreamBufferType);
+        cms::test::KernelObjectCreated(kind, nullptr, footprint);
+        return nullptr;
+    }
+    cms::test::DynamicAllocationMade();
+
+    auto storage = static_cast<uint8_t *>(cms::test::ArenaAllocate(xBufferSizeBytes, alignof(std::max_align_t)));
+    auto buffer = InitStreamBuffer(cms::test::ArenaNew<FakeStreamBuffer>(), storage,
+                                   xBufferSizeBytes, triggerLevel, xStreamBufferType,
+                                   pxSendCompletedCallback, pxReceiveCompletedCallback);
+    buffer->extras->heapCharge = charge;
+    traceSTREAM_BUFFER_CREATE(buffer, xStreamBufferType);
+    cms::test::KernelObjectCreated(kind, buffer, footprint);
+    return buffer;
+}
+
+extern "C" StreamBufferHandle_t xStreamBufferGenericCreateStatic(size_t xBufferSizeBytes,
+                                                                 size_t xTriggerLevelBytes,
+                                                                 BaseType_t xStreamBufferType,
+                                                                 uint8_t * const pucStreamBufferStorageArea,
+                                                                 StaticStreamBuffer_t * const pxStaticStreamBuffer,
+                                                                 StreamBufferCallbackFunction_t pxSendCompletedCallback,
+                                                                 StreamBufferCallbackFunction_t pxReceiveCompletedCallback)
+{
+    configASSERT(pucStreamBufferStorageArea != nullptr);
+    configASSERT(pxStaticStreamBuffer != nullptr);
+    auto triggerLevel = ValidateTriggerLevel(xBufferSizeBytes, xTriggerLevelBytes, xStreamBufferType);
+
+    //as with the kernel, the control block lives in the caller's buffer, and
+    //one byte of the caller's storage is never used, i.e. it holds one less
+    configASSERT(xBufferSizeBytes > 1U);
+    auto buffer = InitStreamBuffer(new (pxStaticStreamBuffer) FakeStreamBuffer(), pucStreamBufferStorageArea,
+                                   xBufferSizeBytes - 1U, triggerLevel, xStreamBufferType,
+                                   pxSendCompletedCallback, pxReceiveCompletedCallback);
+    buffer->isStatic = true;
+    traceSTREAM_BUFFER_CREATE(buffer, xStreamBufferType);
+    auto kind = (xStreamBufferType == sbTYPE_MESSAGE_BUFFER) ? cms::test::KernelObjectKind::MessageBuffer :
+                                                               cms::test::KernelObjectKind::StreamBuffer;
+    cms::test::StaticKernelObjectCreated(kind, buffer, CMS_FREERTOS_TARGET_SIZEOF_STATIC_STREAM_BUFFER + xBufferSizeBytes);
+    return buffer;
+}
+
+extern "C" BaseType_t xStreamBufferGetStaticBuffers(StreamBufferHandle_t xStreamBuffer,
+                                                    uint8_t ** ppucStreamBufferStorageArea,
+                                                    StaticStreamBuffer_t ** ppxStaticStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    configASSERT(ppucStreamBufferStorageArea != nullptr);
+    configASSERT(ppxStaticStreamBuffer != nullptr);
+
+    if (!xStreamBuffer->isStatic)
+    {
+        return pdFALSE;
+    }
+
+    *ppucStreamBufferStorageArea = xStreamBuffer->storage;
+    *ppxStaticStreamBuffer = reinterpret_cast<StaticStreamBuffer_t *>(xStreamBuffer);
+    return pdTRUE;
+}
+
+extern "C" void vStreamBufferDelete(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    traceSTREAM_BUFFER_DELETE(xStreamBuffer);
+    cms::test::IsrObjectDeleted(xStreamBuffer);
+    cms::test::KernelObjectDeleted(xStreamBuffer);
+    cms::test::ReleaseHeap(xStreamBuffer->extras->heapCharge);
+    cms::test::ArenaDelete(xStreamBuffer->extras);
+    if (xStreamBuffer->isStatic)
+    {
+        xStreamBuffer->~StreamBufferDef_t();
+    }
+    else
+    {
+        cms::test::ArenaFree(xStreamBuffer->storage);
+        cms::test::ArenaDelete(xStreamBuffer);
+    }
+}
+
+extern "C" size_t xStreamBufferSend(StreamBufferHandle_t xStreamBuffer,
+                                    const void * pvTxData,
+                                    size_t xDataLengthBytes,
+                                    TickType_t xTicksToWait)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+    (void)xTicksToWait; //in our unit testing fake, never honor ticks to wait.
+    auto sent = Send(xStreamBuffer, pvTxData, xDataLengthBytes, pdFALSE, nullptr);
+    if (sent > 0U)
+    {
+        traceSTREAM_BUFFER_SEND(xStreamBuffer, sent);
+    }
+    else
+    {
+        traceSTREAM_BUFFER_SEND_FAILED(xStreamBuffer);
+    }
+    return sent;
+}
+
+extern "C" size_t xStreamBufferSendFromISR(StreamBufferHandle_t xStreamBuffer,
+                                           const void * pvTxData,
+                                           size_t xDataLengthBytes,
+                                           BaseType_t * const pxHigherPriorityTaskWoken)
+{
+    auto sent = Send(xStreamBuffer, pvTxData, xDataLengthBytes, pdTRUE, pxHigherPriorityTaskWoken);
+    traceSTREAM_BUFFER_SEND_FROM_ISR(xStreamBuffer, sent);
+    return sent;
+}
+
+extern "C" size_t xStreamBufferReceive(StreamBufferHandle_t xStreamBuffer,
+                                       void * pvRxData,
+                                       size_t xBufferLengthBytes,
+                                       TickType_t xTicksToWait)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+    (void)xTicksToWait; //in our unit testing fake, never honor ticks to wait.
+    auto received = Receive(xStreamBuffer, pvRxData, xBufferLengthBytes, pdFALSE, nullptr);
+    if (received > 0U)
+    {
+        traceSTREAM_BUFFER_RECEIVE(xStreamBuffer, received);
+    }
+    else
+    {
+        traceSTREAM_BUFFER_RECEIVE_FAILED(xStreamBuffer);
+    }
+    return received;
+}
+
+extern "C" size_t xStreamBufferReceiveFromISR(StreamBufferHandle_t xStreamBuffer,
+                                              void * pvRxData,
+                                              size_t xBufferLengthBytes,
+                                              BaseType_t * const pxHigherPriorityTaskWoken)
+{
+    auto received = Receive(xStreamBuffer, pvRxData, xBufferLengthBytes, pdTRUE, pxHigherPriorityTaskWoken);
+    traceSTREAM_BUFFER_RECEIVE_FROM_ISR(xStreamBuffer, received);
+    return received;
+}
+
+extern "C" BaseType_t xStreamBufferSendCompletedFromISR(StreamBufferHandle_t xStreamBuffer,
+                                                        BaseType_t * pxHigherPriorityTaskWoken)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    SendCompleted(xStreamBuffer, pdTRUE, pxHigherPriorityTaskWoken);
+    return pdTRUE;
+}
+
+extern "C" BaseType_t xStreamBufferReceiveCompletedFromISR(StreamBufferHandle_t xStreamBuffer,
+                                                           BaseType_t * pxHigherPriorityTaskWoken)
+{
+    configASSERT(xStreamBuffer != nullptr);
+
+    //no task is ever blocked sending, hence no task is woken.
+    (void)pxHigherPriorityTaskWoken;
+    return pdFALSE;
+}
+
+extern "C" BaseType_t xStreamBufferIsFull(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+
+    //a message buffer with no room for another length is full
+    size_t reserved = IsMessageBuffer(xStreamBuffer) ? MESSAGE_LENGTH_BYTES : 0;
+    return (SpacesAvailable(xStreamBuffer) <= reserved) ? pdTRUE : pdFALSE;
+}
+
+extern "C" BaseType_t xStreamBufferIsEmpty(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    return (xStreamBuffer->bytesBuffered == 0) ? pdTRUE : pdFALSE;
+}
+
+extern "C" BaseType_t xStreamBufferReset(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    configASSERT(!cms::test::IsInIsrContext());
+
+    //no task is ever blocked on the buffer, hence the reset always succeeds.
+    traceSTREAM_BUFFER_RESET(xStreamBuffer);
+    xStreamBuffer->head = 0;
+    xStreamBuffer->bytesBuffered = 0;
+    return pdPASS;
+}
+
+extern "C" BaseType_t xStreamBufferResetFromISR(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    xStreamBuffer->head = 0;
+    xStreamBuffer->bytesBuffered = 0;
+    return pdPASS;
+}
+
+extern "C" size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    return SpacesAvailable(xStreamBuffer);
+}
+
+extern "C" size_t xStreamBufferBytesAvailable(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    return xStreamBuffer->bytesBuffered;
+}
+
+extern "C" BaseType_t xStreamBufferSetTriggerLevel(StreamBufferHandle_t xStreamBuffer, size_t xTriggerLevel)
+{
+    configASSERT(xStreamBuffer != nullptr);
+
+    if (xTriggerLevel == 0)
+    {
+        xTriggerLevel = 1;
+    }
+
+    if (xTriggerLevel > xStreamBuffer->length)
+    {
+        return pdFALSE;
+    }
+
+    xStreamBuffer->triggerLevel = xTriggerLevel;
+    return pdTRUE;
+}
+
+extern "C" size_t xStreamBufferNextMessageLengthBytes(StreamBufferHandle_t xStreamBuffer)
+{
+    configASSERT(xStreamBuffer != nullptr);
+    if (!IsMessageBuffer(xStreamBuffer))
+    {
+        return 0;
+    }
+
+    return NextMessageLength(xStreamBuffer);
+}
+
+namespace cms {
+namespace test {
+
+    StreamBufferContents GetStreamBufferContents(StreamBufferHandle_t buffer)
+    {
+        configASSERT(buffer != nullptr);
+
+        StreamBufferContents contents = {};
+        contents.first = buffer->storage + buffer->head;
+        contents.firstLength = std::min(buffer->bytesBuffered, buffer->length - buffer->head);
+        contents.second = buffer->storage;
+        contents.secondLength = buffer->bytesBuffered - contents.firstLength;
+        return contents;
+    }
+
+    StreamBufferStats GetStreamBufferStats(StreamBufferHandle_t buffer)
+    {
+        configASSERT(buffer != nullptr);
+
+        auto stats = buffer->extras->stats;
+        stats.elapsed = GetVirtualTime() - buffer->extras->created;
+        return stats;
+    }
+
+} //namespace test
+} //namespace cms
@@ -26,34 +26,233 @@
 ///   info@covemountainsoftware.com
 ///***************************************************************************
 /// @endcond
+#include <array>
+#include <cstring>
+#include <new>
 #include "FreeRTOS.h"
 #include "task.h"
 #include "cpputest_for_freertos_timers.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_smp.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_fake_task.hpp"
+#include "cpputest_for_freertos_fake_memory.hpp"
+#include "cpputest_for_freertos_fake_kernel_objects.hpp"
+#include "cpputest_for_freertos_fake_trace.hpp"
+
+static_assert(sizeof(FakeTask) <= sizeof(StaticTask_t),
+              "the fake task must fit within the caller's StaticTask_t");
+static_assert(alignof(FakeTask) <= alignof(StaticTask_t),
+              "the fake task must be aligned as StaticTask_t");
 
 namespace cms {
 namespace test {
 
-    static TickType_t s_tickCount = 0;
+    static constexpr size_t MAX_FAKE_TASKS = 32;
 
-    void TaskInit()
+    static thread_local TickType_t s_tickCount = 0;
+    static thread_local std::array<FakeTask, MAX_FAKE_TASKS> s_tasks = {};
+    static thread_local std::array<TaskHandle_t, configNUMBER_OF_CORES> s_currentTask = {};
+    static thread_local std::array<std::chrono::nanoseconds, configNUMBER_OF_CORES> s_switchedInAt = {};
+    static thread_local std::array<std::chrono::nanoseconds, configNUMBER_OF_CORES> s_coreRunTime = {};
+
+    static void ReleaseTaskHeap(FakeTask & task)
     {
+        ReleaseHeap(task.tcbCharge);
+        ReleaseHeap(task.stackCharge);
+    }
+
+    static void ResetTasks()
+    {
+        for (auto& task : s_tasks)
+        {
+            ReleaseTaskHeap(task);
+        }
         s_tickCount = 0;
+        s_tasks = {};
+        s_currentTask = {};
+        s_switchedInAt = {};
+        s_coreRunTime = {};
+    }
+
+    void TaskInit()
+    {
+        ResetTasks();
     }
 
     void TaskDestroy()
     {
-        s_tickCount = 0;
+        ResetTasks();
+    }
+
+    std::chrono::nanoseconds GetVirtualTime()
+    {
+        //the fake timers track time in nanoseconds, prefer them if active.
+        if (TimersIsActive())
+        {
+            return GetCurrentInternalTime();
+        }
+
+        return std::chrono::milliseconds(pdTICKS_TO_MS(s_tickCount));
+    }
+
+    static size_t CoreIndex(BaseType_t core)
+    {
+        configASSERT((core >= 0) && (core < configNUMBER_OF_CORES));
+        return static_cast<size_t>(core);
+    }
+
+    static std::chrono::nanoseconds CurrentSlice(size_t core)
+    {
+        if (s_currentTask[core] == nullptr)
+        {
+            return std::chrono::nanoseconds::zero();
+        }
+
+        return GetVirtualTime() - s_switchedInAt[core];
+    }
+
+    static void SwitchOut(size_t core)
+    {
+        auto slice = CurrentSlice(core);
+        if (s_currentTask[core] != nullptr)
+        {
+            s_currentTask[core]->runTime += slice;
+            s_coreRunTime[core] += slice;
+        }
+        s_currentTask[core] = nullptr;
+    }
+
+    static bool IsAllowedOnCore(TaskHandle_t task, size_t core)
+    {
+        return (task->coreAffinityMask & (1U << core)) != 0;
+    }
+
+    void SetCurrentTask(TaskHandle_t task)
+    {
+        auto core = CoreIndex(GetCurrentCore());
+        if (task != nullptr)
+        {
+            configASSERT(task->inUse);
+
+            //the scheduler would never place the task on this core
+            configASSERT(IsAllowedOnCore(task, core));
+
+            //nor run a task on two cores at once
+            for (size_t other = 0; other < s_currentTask.size(); ++other)
+            {
+                configASSERT((other == core) || (s_currentTask[other] != task));
+            }
+        }
+
+        //as with the kernel's context switch, the trace macros
+        //find the task switched out, then in, as pxCurrentTCB
+        TaskHandle_t pxCurrentTCB = s_currentTask[core];
+        if (pxCurrentTCB != nullptr)
+        {
+            traceTASK_SWITCHED_OUT();
+        }
+
+        SwitchOut(core);
+        s_currentTask[core] = task;
+        s_switchedInAt[core] = GetVirtualTime();
+
+        pxCurrentTCB = task;
+        if (pxCurrentTCB != nullptr)
+        {
+            traceTASK_SWITCHED_IN();
+        }
+    }
+
+    std::chrono::nanoseconds GetTaskRunTime(TaskHandle_t task)
+    {
+        configASSERT(task != nullptr);
+        auto runTime = task->runTime;
+        for (size_t core = 0; core < s_currentTask.size(); ++core)
+        {
+            if (s_currentTask[core] == task)
+            {
+                runTime += CurrentSlice(core);
+            }
+        }
+        return runTime;
+    }
+
+    std::chrono::nanoseconds GetCoreRunTime(BaseType_t core)
+    {
+        auto index = CoreIndex(core);
+        return s_coreRunTime[index] + CurrentSlice(index);
+    }
+
+    void TaskMutexTaken(FakeTask * holder)
+    {
+        if (holder != nullptr)
+        {
+            holder->mutexesHeld++;
+        }
+    }
+
+    void TaskMutexGiven(FakeTask * holder)
+    {
+        if ((holder == nullptr) || (holder->mutexesHeld == 0))
+        {
+            return;
+        }
+
+        holder->mutexesHeld--;
+
+        //only disinherit once no other mutexes are held
+        if (holder->mutexesHeld == 0)
+        {
+            holder->priority = holder->basePriority;
+        }
+    }
+
+    void TaskPriorityInherit(FakeTask * holder, UBaseType_t priority)
+    {
+        if ((holder != nullptr) && (holder->priority < priority))
+        {
+            holder->priority = priority;
+        }
+    }
+
+    static TaskHandle_t InitTask(FakeTask & task, TaskFunction_t code, const char * name,
+                                 void * parameters, UBaseType_t priority,
+                                 UBaseType_t coreAffinityMask)
+    {
+        task = {};
+        task.inUse = true;
+        task.code = code;
+        if (name != nullptr)
+        {
+            strncpy(task.name, name, sizeof(task.name) - 1);
+        }
+        task.parameters = parameters;
+        task.priority = priority;
+        task.basePriority = priority;
+        task.coreAffinityMask = coreAffinityMask;
+        return &task;
+    }
+
+    //dynamically created tasks only, static tasks live in the caller's StaticTask_t
+    static TaskHandle_t AllocateTask(TaskFunction_t code, const char * name,
+                                     void * parameters, UBaseType_t priority,
+                                     UBaseType_t coreAffinityMask)
+    {
+        for (auto& task : s_tasks)
+        {
+            if (!task.inUse)
+            {
+                return InitTask(task, code, name, parameters, priority, coreAffinityMask);
+            }
+        }
+
+        return nullptr;
     }
 
 } //namespace test
 } //namespace cms
 
-//dummy task control block
-struct tskTaskControlBlock
-{
-    int dummy;
-};
-
 extern "C" BaseType_t xTaskCreate( TaskFunction_t pxTaskCode,
                         const char * const pcName,
                         const configSTACK_DEPTH_TYPE uxStackDepth,
@@ -61,12 +260,40 @@ extern "C" BaseType_t xTaskCreate( TaskFunction_t pxTaskCode,
                         UBaseType_t uxPriority,
                         TaskHandle_t * const pxCreatedTask )
 {
-    (void)pxTaskCode;
-    (void)pcName;
-    (void)uxStackDepth;
-    (void)pvParameters;
-    (void)uxPriority;
-    (void)pxCreatedTask;
+    auto footprint = CMS_FREERTOS_TARGET_SIZEOF_STATIC_TASK + (static_cast<size_t>(uxStackDepth) * CMS_FREERTOS_TARGET_SIZEOF_STACK_TYPE);
+
+    //as with the kernel, for a stack growing down, the stack is allocated first
+    auto stackCharge = cms::test::ChargeHeap(static_cast<size_t>(uxStackDepth) * CMS_FREERTOS_TARGET_SIZEOF_STACK_TYPE);
+    cms::test::HeapCharge tcbCharge = {};
+    TaskHandle_t task = nullptr;
+    if (stackCharge.block != nullptr)
+    {
+        tcbCharge = cms::test::ChargeHeap(CMS_FREERTOS_TARGET_SIZEOF_STATIC_TASK);
+    }
+    if (tcbCharge.block != nullptr)
+    {
+        task = cms::test::AllocateTask(pxTaskCode, pcName, pvParameters, uxPriority,
+                                       configTASK_DEFAULT_CORE_AFFINITY);
+    }
+
+    if (task == nullptr)
+    {
+        cms::test::ReleaseHeap(tcbCharge);
+        cms::test::ReleaseHeap(stackCharge);
+        traceTASK_CREATE_FAILED();
+        cms::test::KernelObjectCreated(cms::test::KernelObjectKind::Task, nullptr, footprint);
+        return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+    }
+    cms::test::DynamicAllocationMade();
+    task->stackCharge = stackCharge;
+    task->tcbCharge = tcbCharge;
+    traceTASK_CREATE(task);
+    cms::test::KernelObjectCreated(cms::test::KernelObjectKind::Task, task, footprint, task->name);
+
+    if (pxCreatedTask != nullptr)
+    {
+        *pxCreatedTask = task;
+    }
     return pdPASS;
 }
 
@@ -79,24 +306,149 @@ extern "C" TaskHandle_t xTaskCreateStatic(
         StackType_t * const puxStackBuffer,
         StaticTask_t * const pxTaskBuffer )
 {
-    (void)pxTaskCode;
-    (void)pcName;
-    (void)uxStackDepth;
-    (void)pvParameters;
-    (void)uxPriority;
-    (void)puxStackBuffer;
-    (void)pxTaskBuffer;
+    configASSERT(puxStackBuffer != nullptr);
+    configASSERT(pxTaskBuffer != nullptr);
+
+    auto task = cms::test::InitTask(*new (pxTaskBuffer) FakeTask(), pxTaskCode, pcName, pvParameters,
+                                    uxPriority, configTASK_DEFAULT_CORE_AFFINITY);
+    traceTASK_CREATE(task);
+    cms::test::StaticKernelObjectCreated(cms::test::KernelObjectKind::Task, task,
+                                         CMS_FREERTOS_TARGET_SIZEOF_STATIC_TASK + (static_cast<size_t>(uxStackDepth) * CMS_FREERTOS_TARGET_SIZEOF_STACK_TYPE),
+                                         task->name);
+    return task;
+}
+
+#if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+
+extern "C" BaseType_t xTaskCreateAffinitySet( TaskFunction_t pxTaskCode,
+                        const char * const pcName,
+                        const configSTACK_DEPTH_TYPE uxStackDepth,
+                        void * const pvParameters,
+                        UBaseType_t uxPriority,
+                        UBaseType_t uxCoreAffinityMask,
+                        TaskHandle_t * const pxCreatedTask )
+{
+    TaskHandle_t task = nullptr;
+    auto result = xTaskCreate(pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority, &task);
+    if (result == pdPASS)
+    {
+        task->coreAffinityMask = uxCoreAffinityMask;
+        if (pxCreatedTask != nullptr)
+        {
+            *pxCreatedTask = task;
+        }
+    }
+    return result;
+}
+
+extern "C" TaskHandle_t xTaskCreateStaticAffinitySet(
+        TaskFunction_t pxTaskCode,
+        const char * const pcName,
+        const configSTACK_DEPTH_TYPE uxStackDepth,
+        void * const pvParameters,
+        UBaseType_t uxPriority,
+        StackType_t * const puxStackBuffer,
+        StaticTask_t * const pxTaskBuffer,
+        UBaseType_t uxCoreAffinityMask )
+{
+    auto task = xTaskCreateStatic(pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority,
+                                  puxStackBuffer, pxTaskBuffer);
+    task->coreAffinityMask = uxCoreAffinityMask;
+    return task;
+}
+
+extern "C" void vTaskCoreAffinitySet( const TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask )
+{
+    TaskHandle_t task = (xTask != nullptr) ? xTask : xTaskGetCurrentTaskHandle();
+    configASSERT(task != nullptr);
+    task->coreAffinityMask = uxCoreAffinityMask;
+
+    //as the kernel would, ask a core running the task on a
+    //no longer permitted core to yield.
+    for (BaseType_t core = 0; core < configNUMBER_OF_CORES; ++core)
+    {
+        if ((xTaskGetCurrentTaskHandleForCore(core) == task) &&
+            ((uxCoreAffinityMask & (1U << core)) == 0))
+        {
+            portYIELD_CORE(core);
+        }
+    }
+}
 
-    static struct tskTaskControlBlock dummy = {};
-    return &dummy;
+extern "C" UBaseType_t vTaskCoreAffinityGet( ConstTaskHandle_t xTask )
+{
+    ConstTaskHandle_t task = (xTask != nullptr) ? xTask : xTaskGetCurrentTaskHandle();
+    configASSERT(task != nullptr);
+    return task->coreAffinityMask;
 }
 
+#endif /* if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) ) */
+
 extern "C" void vTaskDelete( TaskHandle_t xTaskToDelete )
 {
-    (void)xTaskToDelete;
+    TaskHandle_t task = (xTaskToDelete != nullptr) ? xTaskToDelete : xTaskGetCurrentTaskHandle();
+    if (task == nullptr)
+    {
+        //unit tests typically do not execute within a task
+        return;
+    }
+
+    configASSERT(task->inUse);
+    traceTASK_DELETE(task);
+    for (size_t core = 0; core < cms::test::s_currentTask.size(); ++core)
+    {
+        if (cms::test::s_currentTask[core] == task)
+        {
+            cms::test::SwitchOut(core);
+        }
+    }
+    cms::test::ReleaseTaskHeap(*task);
+    cms::test::KernelObjectDeleted(task);
+    *task = {};
 }
 
-extern "C" void vTaskDelay(const TickType_t ticks)
+extern "C" UBaseType_t uxTaskPriorityGet( const TaskHandle_t xTask )
+{
+    TaskHandle_t task = (xTask != nullptr) ? xTask : xTaskGetCurrentTaskHandle();
+    configASSERT(task != nullptr);
+    return task->priority;
+}
+
+extern "C" UBaseType_t uxTaskPriorityGetFromISR( const TaskHandle_t xTask )
+{
+    return uxTaskPriorityGet(xTask);
+}
+
+extern "C" void vTaskPrioritySet( TaskHandle_t xTask, UBaseType_t uxNewPriority )
+{
+    TaskHandle_t task = (xTask != nullptr) ? xTask : xTaskGetCurrentTaskHandle();
+    configASSERT(task != nullptr);
+    configASSERT(uxNewPriority < configMAX_PRIORITIES);
+    traceTASK_PRIORITY_SET(task, uxNewPriority);
+
+    //as the kernel does, an inherited priority is only
+    //replaced if the new priority is higher.
+    bool isInherited = task->priority != task->basePriority;
+    if (!isInherited || (uxNewPriority > task->priority))
+    {
+        task->priority = uxNewPriority;
+    }
+    task->basePriority = uxNewPriority;
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+    return cms::test::s_currentTask[cms::test::CoreIndex(cms::test::GetCurrentCore())];
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandleForCore( BaseType_t xCoreID )
+{
+    return cms::test::s_currentTask[cms::test::CoreIndex(xCoreID)];
+}
+
+//the blocked time of vTaskDelay and xTaskDelayUntil, each
+//traced by its caller, as only one is traced by the kernel.
+static void DelayTicks(const TickType_t ticks)
 {
     if (cms::test::TimersIsActive())
     {
@@ -109,7 +461,24 @@ extern "C" void vTaskDelay(const TickType_t ticks)
     }
 }
 
-extern "C" TickType_t xTaskGetTickCount(void)
+extern "C" void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+    if (cms::test::TraceIsActive())
+    {
+        cms::test::TraceEvent(cms::test::TraceOp::TaskDelay, xTaskGetCurrentTaskHandle(),
+                              static_cast<uint32_t>(xTicksToDelay), pdPASS);
+    }
+    if (xTicksToDelay > 0U)
+    {
+        TaskHandle_t pxCurrentTCB = xTaskGetCurrentTaskHandle();
+        (void)pxCurrentTCB;
+        traceTASK_DELAY();
+    }
+    DelayTicks(xTicksToDelay);
+}
+
+static TickType_t TickCount()
 {
     if (cms::test::TimersIsActive())
     {
@@ -123,6 +492,17 @@ extern "C" TickType_t xTaskGetTickCount(void)
     }
 }
 
+extern "C" TickType_t xTaskGetTickCount(void)
+{
+    configASSERT(!cms::test::IsInIsrContext());
+    return TickCount();
+}
+
+extern "C" TickType_t xTaskGetTickCountFromISR(void)
+{
+    return TickCount();
+}
+
 extern "C" BaseType_t xTaskDelayUntil(TickType_t * const previous, const TickType_t increment)
 {
     configASSERT(previous != nullptr);
@@ -130,9 +510,22 @@ extern "C" BaseType_t xTaskDelayUntil(TickType_t * const previous, const TickTyp
     auto next = *previous + increment;
     if (next <= current)
     {
+        if (cms::test::TraceIsActive())
+        {
+            cms::test::TraceEvent(cms::test::TraceOp::TaskDelayUntil, xTaskGetCurrentTaskHandle(),
+                                  static_cast<uint32_t>(increment), pdFALSE);
+        }
         return pdFALSE;
     }
 
-    vTaskDelay(next - current);
+    if (cms::test::TraceIsActive())
+    {
+        cms::test::TraceEvent(cms::test::TraceOp::TaskDelayUntil, xTaskGetCurrentTaskHandle(),
+                              static_cast<uint32_t>(increment), pdTRUE);
+    }
+    TaskHandle_t pxCurrentTCB = xTaskGetCurrentTaskHandle();
+    (void)pxCurrentTCB;
+    traceTASK_DELAY_UNTIL(next);
+    DelayTicks(next - current);
     return pdTRUE;
 }
@@ -0,0 +1,127 @@
+/// @brief Provides scoped virtual time and wall clock budgets, allowing
+///        unit tests to enforce latency requirements.
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include <exception>
+#include "cpputest_for_freertos_time_budget.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "FreeRTOS.h"
+
+//must be last
+#include "CppUTest/TestHarness.h"
+
+namespace cms {
+namespace test {
+
+    static bool ShouldCheckAtScopeExit(bool checked)
+    {
+        //do not pile a second failure on top of an in-flight
+        //test exit (i.e. configASSERT or a failed CHECK within the scope)
+        return !checked && !std::uncaught_exception();
+    }
+
+    VirtualTimeBudget::VirtualTimeBudget(TickType_t budget) :
+        m_budget(std::chrono::milliseconds(pdTICKS_TO_MS(budget))),
+        m_start(GetVirtualTime()),
+        m_checked(false)
+    {
+    }
+
+    VirtualTimeBudget::~VirtualTimeBudget() noexcept(false)
+    {
+        if (ShouldCheckAtScopeExit(m_checked))
+        {
+            Check();
+        }
+    }
+
+    std::chrono::nanoseconds VirtualTimeBudget::Elapsed() const
+    {
+        return GetVirtualTime() - m_start;
+    }
+
+    TickType_t VirtualTimeBudget::ElapsedTicks() const
+    {
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(Elapsed());
+        return pdMS_TO_TICKS(milliseconds.count());
+    }
+
+    bool VirtualTimeBudget::IsExceeded() const
+    {
+        return Elapsed() > m_budget;
+    }
+
+    void VirtualTimeBudget::Check()
+    {
+        m_checked = true;
+        auto elapsed = Elapsed();
+        if (elapsed > m_budget)
+        {
+            auto msg = StringFromFormat("Virtual time budget exceeded: %lld ns consumed, %lld ns allowed.",
+                                        static_cast<long long>(elapsed.count()),
+                                        static_cast<long long>(m_budget.count()));
+            FAIL_TEST(msg.asCharString());
+        }
+    }
+
+    WallClockBudget::WallClockBudget(std::chrono::nanoseconds budget) :
+        m_budget(budget),
+        m_start(std::chrono::steady_clock::now()),
+        m_checked(false)
+    {
+    }
+
+    WallClockBudget::~WallClockBudget() noexcept(false)
+    {
+        if (ShouldCheckAtScopeExit(m_checked))
+        {
+            Check();
+        }
+    }
+
+    std::chrono::nanoseconds WallClockBudget::Elapsed() const
+    {
+        return std::chrono::steady_clock::now() - m_start;
+    }
+
+    bool WallClockBudget::IsExceeded() const
+    {
+        return Elapsed() > m_budget;
+    }
+
+    void WallClockBudget::Check()
+    {
+        m_checked = true;
+        auto elapsed = Elapsed();
+        if (elapsed > m_budget)
+        {
+            auto msg = StringFromFormat("Wall clock budget exceeded: %lld ns consumed, %lld ns allowed.",
+                                        static_cast<long long>(elapsed.count()),
+                                        static_cast<long long>(m_budget.count()));
+            FAIL_TEST(msg.asCharString());
+        }
+    }
+
+} //namespace test
+} //namespace cms
@@ -0,0 +1,315 @@
+/// @brief Provides an opt-in Chrome Trace Event/Perfetto timeline of a test,
+///        in virtual time.
+///
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+
+#include <cstdio>
+#include <vector>
+#include "cpputest_for_freertos_fake_timeline.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "FreeRTOS.h"
+
+//must be last
+#include "CppUTest/TestHarness.h"
+
+namespace cms {
+namespace test {
+
+    struct TimelineEvent
+    {
+        char phase;                 ///< Chrome Trace Event "ph"
+        std::chrono::nanoseconds time;
+        size_t track;
+        std::string name;
+        uint64_t value;             ///< counter value, or flow id
+    };
+
+    struct Timeline
+    {
+        std::string process;
+        std::string file;
+        std::vector<std::string> tracks;
+        std::vector<size_t> openSpans;
+        std::vector<TimelineEvent> events;
+        uint64_t nextFlowId;
+    };
+
+    static constexpr size_t ISR_TRACK = 0;
+    static constexpr size_t TIMERS_TRACK = 1;
+    static constexpr size_t TASK_TRACK = 2;
+
+    thread_local Timeline* activeTimeline = nullptr;
+
+    void TimelineInit(const char * file)
+    {
+        delete activeTimeline;
+        activeTimeline = new Timeline();
+
+        auto test = UtestShell::getCurrent();
+        activeTimeline->process = std::string(test->getGroup().asCharString()) + "." +
+                              test->getName().asCharString();
+        if (file != nullptr)
+        {
+            activeTimeline->file = file;
+        }
+        activeTimeline->tracks = {"ISR", "Timers", "Task"};
+        activeTimeline->nextFlowId = 1;
+    }
+
+    void TimelineTeardown()
+    {
+        if (activeTimeline == nullptr)
+        {
+            return;
+        }
+
+        if (!activeTimeline->file.empty())
+        {
+            TimelineSave(activeTimeline->file.c_str());
+        }
+
+        delete activeTimeline;
+        activeTimeline = nullptr;
+    }
+
+    static void Record(char phase, size_t track, std::string name, uint64_t value = 0)
+    {
+        activeTimeline->events.push_back({phase, GetVirtualTime(), track, std::move(name), value});
+    }
+
+    static size_t Track(const char * name)
+    {
+        auto & tracks = activeTimeline->tracks;
+        for (size_t track = 0; track < tracks.size(); ++track)
+        {
+            if (tracks[track] == name)
+            {
+                return track;
+            }
+        }
+
+        tracks.push_back(name);
+        return tracks.size() - 1;
+    }
+
+    static void AppendEscaped(std::string & json, const std::string & text)
+    {
+        for (auto c : text)
+        {
+            if ((c == '"') || (c == '\\'))
+            {
+                json += '\\';
+                json += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                json += escaped;
+            }
+            else
+            {
+                json += c;
+            }
+        }
+    }
+
+    static void AppendMicroseconds(std::string & json, std::chrono::nanoseconds time)
+    {
+        char buffer[32];
+        auto ns = static_cast<unsigned long long>(time.count());
+        snprintf(buffer, sizeof(buffer), "%llu.%03llu", ns / 1000, ns % 1000);
+        json += buffer;
+    }
+
+    std::string GetTimelineJson()
+    {
+        std::string json = "{\"traceEvents\":[\n";
+        if (activeTimeline == nullptr)
+        {
+            return json + "],\"displayTimeUnit\":\"ns\"}\n";
+        }
+
+        json += R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":")";
+        AppendEscaped(json, activeTimeline->process);
+        json += "\"}}";
+        for (size_t track = 0; track < activeTimeline->tracks.size(); ++track)
+        {
+            json += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(track) +
+                    ",\"args\":{\"name\":\"";
+            AppendEscaped(json, activeTimeline->tracks[track]);
+            json += "\"}}";
+        }
+
+        for (auto & event : activeTimeline->events)
+        {
+            json += ",\n{\"name\":\"";
+            AppendEscaped(json, event.name);
+            json += "\",\"ph\":\"";
+            json += event.phase;
+            json += "\",\"pid\":1,\"tid\":" + std::to_string(event.track) + ",\"ts\":";
+            AppendMicroseconds(json, event.time);
+            switch (event.phase)
+            {
+                case 'C':
+                    json += ",\"args\":{\"messages\":" + std::to_string(event.value) + "}";
+                    break;
+                case 'i':
+                    json += ",\"s\":\"t\"";
+                    break;
+                case 's':
+                    json += ",\"cat\":\"isr\",\"id\":" + std::to_string(event.value);
+                    break;
+                case 'f':
+                    json += ",\"cat\":\"isr\",\"id\":" + std::to_string(event.value) + ",\"bp\":\"e\"";
+                    break;
+                default:
+                    break;
+            }
+            json += "}";
+        }
+
+        return json + "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+    std::vector<TimelineRecord> GetTimelineEvents()
+    {
+        std::vector<TimelineRecord> records;
+        if (activeTimeline == nullptr)
+        {
+            return records;
+        }
+
+        records.reserve(activeTimeline->events.size());
+        for (auto & event : activeTimeline->events)
+        {
+            records.push_back({event.phase, event.time, activeTimeline->tracks[event.track], event.name, event.value});
+        }
+        return records;
+    }
+
+    bool TimelineSave(const char * path)
+    {
+        configASSERT(path != nullptr);
+
+        auto json = GetTimelineJson();
+        auto file = fopen(path, "w");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        bool ok = fwrite(json.data(), 1, json.size(), file) == json.size();
+        return (fclose(file) == 0) && ok;
+    }
+
+    TimelineSpan::TimelineSpan(const char * name) :
+        m_recorded(activeTimeline != nullptr)
+    {
+        configASSERT(name != nullptr);
+        if (m_recorded)
+        {
+            auto track = Track(name);
+            activeTimeline->openSpans.push_back(track);
+            Record('B', track, name);
+        }
+    }
+
+    TimelineSpan::~TimelineSpan()
+    {
+        //the timeline may have been replaced or stopped within the span
+        if (m_recorded && (activeTimeline != nullptr) && !activeTimeline->openSpans.empty())
+        {
+            auto track = activeTimeline->openSpans.back();
+            activeTimeline->openSpans.pop_back();
+            Record('E', track, activeTimeline->tracks[track]);
+        }
+    }
+
+    void TimelineQueueLevel(const void * queue, const char * name, uint32_t messagesWaiting)
+    {
+        if (activeTimeline == nullptr)
+        {
+            return;
+        }
+
+        std::string counter = "queue ";
+        if (name != nullptr)
+        {
+            counter += name;
+        }
+        else
+        {
+            char address[24];
+            snprintf(address, sizeof(address), "%p", queue);
+            counter += address;
+        }
+        Record('C', TASK_TRACK, std::move(counter), messagesWaiting);
+    }
+
+    void TimelineTimerFired(const char * name)
+    {
+        if (activeTimeline == nullptr)
+        {
+            return;
+        }
+
+        Record('i', TIMERS_TRACK, (name != nullptr) ? name : "timer");
+    }
+
+    void TimelineIsrEntered()
+    {
+        if (activeTimeline == nullptr)
+        {
+            return;
+        }
+
+        Record('B', ISR_TRACK, "ISR");
+    }
+
+    void TimelineIsrExited()
+    {
+        if (activeTimeline == nullptr)
+        {
+            return;
+        }
+
+        Record('E', ISR_TRACK, "ISR");
+    }
+
+    void TimelineIsrEventReceived(std::chrono::nanoseconds isrEntry)
+    {
+        if (activeTimeline == nullptr)
+        {
+            return;
+        }
+
+        //from the ISR, to the innermost span receiving its event
+        auto id = activeTimeline->nextFlowId++;
+        activeTimeline->events.push_back({'s', isrEntry, ISR_TRACK, "ISR event", id});
+        auto track = activeTimeline->openSpans.empty() ? TASK_TRACK : activeTimeline->openSpans.back();
+        Record('f', track, "ISR event", id);
+    }
+
+} //namespace test
+} //namespace cms
@@ -23,47 +23,98 @@
 ///***************************************************************************
 /// @endcond
 
+#include <map>
 #include "FreeRTOS.h"
 #include "timers.h"
 #include "FakeTimers.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_fake_memory.hpp"
+#include "cpputest_for_freertos_fake_kernel_objects.hpp"
+#include "cpputest_for_freertos_fake_trace.hpp"
+#include "cpputest_for_freertos_fake_timeline.hpp"
 
 namespace cms {
 namespace test {
 
-    static FakeTimers* s_fakeTimers = nullptr;
+    static thread_local bool s_timersActive = false;
+    static thread_local FakeTimers* s_fakeTimers = nullptr;
+    static thread_local std::chrono::nanoseconds s_timeBeforeStart = {};
+    static thread_local std::map<FakeTimers::Handle, HeapCharge> s_timerHeapCharges;
+
+    static void ReleaseTimers()
+    {
+        for (auto& entry : s_timerHeapCharges)
+        {
+            ReleaseHeap(entry.second);
+        }
+        s_timerHeapCharges.clear();
+        delete s_fakeTimers;
+        s_fakeTimers = nullptr;
+    }
 
     void TimersInit()
     {
-        configASSERT(s_fakeTimers == nullptr);
+        //i.e. discard the timers of a teardown skipped by an earlier failure
+        ReleaseTimers();
+        s_timersActive = true;
+        s_timeBeforeStart = std::chrono::nanoseconds(0);
+    }
+
+    //the fake timers are only created once the first timer is, until
+    //then, time is tracked here.
+    static void StartTimers()
+    {
+        configASSERT(s_timersActive);
+        if (s_fakeTimers != nullptr)
+        {
+            return;
+        }
 
         std::chrono::milliseconds sysTick { configTICK_RATE_HZ * 1/1000 };
         s_fakeTimers = new FakeTimers(sysTick);
+        s_fakeTimers->MoveTimeForward(s_timeBeforeStart);
     }
 
     void TimersDestroy()
     {
-        configASSERT(s_fakeTimers != nullptr);
-        delete s_fakeTimers;
-        s_fakeTimers = nullptr;
+        configASSERT(s_timersActive);
+        ReleaseTimers();
+        s_timersActive = false;
     }
 
     bool TimersIsActive()
+    {
+        return s_timersActive;
+    }
+
+    bool TimersIsStarted()
     {
         return s_fakeTimers != nullptr;
     }
 
     void MoveTimeForward(std::chrono::nanoseconds duration)
     {
-        configASSERT(s_fakeTimers != nullptr);
-        s_fakeTimers->MoveTimeForward(duration);
+        configASSERT(s_timersActive);
+        if (s_fakeTimers != nullptr)
+        {
+            s_fakeTimers->MoveTimeForward(duration);
+        }
+        else
+        {
+            s_timeBeforeStart += duration;
+        }
     }
 
     std::chrono::nanoseconds GetCurrentInternalTime()
     {
-        if (TimersIsActive())
+        if (s_fakeTimers != nullptr)
         {
             return s_fakeTimers->GetCurrentInternalTime();
         }
+        else if (s_timersActive)
+        {
+            return s_timeBeforeStart;
+        }
         else
         {
             return std::chrono::nanoseconds (0);
@@ -93,13 +144,13 @@ namespace test {
 
 using namespace cms::test;
 
-extern "C" TimerHandle_t xTimerCreate( const char * const pcTimerName,
-                            const TickType_t xTimerPeriodInTicks,
-                            const BaseType_t xAutoReload,
-                            void * const pvTimerID,
-                            TimerCallbackFunction_t pxCallbackFunction )
+static TimerHandle_t CreateTimer(const char * const pcTimerName,
+                                 const TickType_t xTimerPeriodInTicks,
+                                 const BaseType_t xAutoReload,
+                                 void * const pvTimerID,
+                                 TimerCallbackFunction_t pxCallbackFunction)
 {
-    configASSERT(s_fakeTimers != nullptr);
+    StartTimers();
     auto behavior = FakeTimers::Behavior::SingleShot;
     if (xAutoReload == pdTRUE)
     {
@@ -109,39 +160,92 @@ extern "C" TimerHandle_t xTimerCreate( const char * const pcTimerName,
                                TicksToChrono(xTimerPeriodInTicks),
                                behavior, pvTimerID,
                                [=](FakeTimers::Handle handle, FakeTimers::Context){
-                                                pxCallbackFunction(
-                                                        (TimerHandle_t)cms::test::HandleToPointer(handle));
+                                                auto timer = (TimerHandle_t)cms::test::HandleToPointer(handle);
+                                                cms::test::TraceEvent(cms::test::TraceOp::TimerFire, timer, 0, pdPASS);
+                                                if (cms::test::TimelineIsActive())
+                                                {
+                                                    cms::test::TimelineTimerFired(pcTimerGetName(timer));
+                                                }
+                                                traceTIMER_EXPIRED(timer);
+                                                pxCallbackFunction(timer);
                                 });
+    auto timer = (TimerHandle_t)HandleToPointer(handle);
+    traceTIMER_CREATE(timer);
+    return timer;
+}
 
-    return (TimerHandle_t)HandleToPointer(handle);
+extern "C" TimerHandle_t xTimerCreate( const char * const pcTimerName,
+                            const TickType_t xTimerPeriodInTicks,
+                            const BaseType_t xAutoReload,
+                            void * const pvTimerID,
+                            TimerCallbackFunction_t pxCallbackFunction )
+{
+    configASSERT(s_timersActive);
+    auto charge = cms::test::ChargeHeap(CMS_FREERTOS_TARGET_SIZEOF_STATIC_TIMER);
+    if (charge.block == nullptr)
+    {
+        traceTIMER_CREATE_FAILED();
+        cms::test::KernelObjectCreated(cms::test::KernelObjectKind::Timer, nullptr, CMS_FREERTOS_TARGET_SIZEOF_STATIC_TIMER);
+        return nullptr;
+    }
+    cms::test::DynamicAllocationMade();
+    auto timer = CreateTimer(pcTimerName, xTimerPeriodInTicks, xAutoReload, pvTimerID, pxCallbackFunction);
+
+    s_timerHeapCharges[PointerToHandle(timer)] = charge;
+    cms::test::KernelObjectCreated(cms::test::KernelObjectKind::Timer, timer,
+                                   CMS_FREERTOS_TARGET_SIZEOF_STATIC_TIMER, pcTimerName);
+    return timer;
 }
 
-extern "C" BaseType_t xTimerGenericCommandFromTask( TimerHandle_t xTimer,
-                                         const BaseType_t xCommandID,
-                                         const TickType_t xOptionalValue,
-                                         BaseType_t * const pxHigherPriorityTaskWoken,
-                                         const TickType_t xTicksToWait )
+extern "C" TimerHandle_t xTimerCreateStatic( const char * const pcTimerName,
+                                  const TickType_t xTimerPeriodInTicks,
+                                  const BaseType_t xAutoReload,
+                                  void * const pvTimerID,
+                                  TimerCallbackFunction_t pxCallbackFunction,
+                                  StaticTimer_t * pxTimerBuffer )
+{
+    configASSERT(s_timersActive);
+    configASSERT(pxTimerBuffer != nullptr);
+
+    //the fake timers hold their own state, the caller's buffer is unused
+    auto timer = CreateTimer(pcTimerName, xTimerPeriodInTicks, xAutoReload, pvTimerID, pxCallbackFunction);
+    cms::test::StaticKernelObjectCreated(cms::test::KernelObjectKind::Timer, timer,
+                                         CMS_FREERTOS_TARGET_SIZEOF_STATIC_TIMER, pcTimerName);
+    return timer;
+}
+
+static BaseType_t TimerCommand( TimerHandle_t xTimer,
+                               const BaseType_t xCommandID,
+                               const TickType_t xOptionalValue )
 {
     configASSERT(s_fakeTimers != nullptr);
     configASSERT(xTimer != nullptr);
-
-    (void)pxHigherPriorityTaskWoken;
-    (void)xTicksToWait;
+    traceTIMER_COMMAND_RECEIVED(xTimer, xCommandID, xOptionalValue);
 
     switch (xCommandID) {
         case tmrCOMMAND_START: {
             bool ok = s_fakeTimers->TimerStart(PointerToHandle(xTimer));
             configASSERT(ok);
+            cms::test::TraceEvent(cms::test::TraceOp::TimerStart, xTimer, 0, pdPASS);
             break;
         }
         case tmrCOMMAND_DELETE: {
+            cms::test::TraceEvent(cms::test::TraceOp::TimerDelete, xTimer, 0, pdPASS);
             bool ok = s_fakeTimers->TimerDelete(PointerToHandle(xTimer));
             configASSERT(ok);
+            auto charge = s_timerHeapCharges.find(PointerToHandle(xTimer));
+            if (charge != s_timerHeapCharges.end())
+            {
+                ReleaseHeap(charge->second);
+                s_timerHeapCharges.erase(charge);
+            }
+            cms::test::KernelObjectDeleted(xTimer);
             break;
         }
         case tmrCOMMAND_STOP: {
             bool ok = s_fakeTimers->TimerStop(PointerToHandle(xTimer));
             configASSERT(ok);
+            cms::test::TraceEvent(cms::test::TraceOp::TimerStop, xTimer, 0, pdPASS);
             break;
         }
         case tmrCOMMAND_CHANGE_PERIOD: {
@@ -149,11 +253,14 @@ extern "C" BaseType_t xTimerGenericCommandFromTask( TimerHandle_t xTimer,
                     PointerToHandle(xTimer),
                     std::chrono::milliseconds (pdTICKS_TO_MS(xOptionalValue)));
             configASSERT(ok);
+            cms::test::TraceEvent(cms::test::TraceOp::TimerChangePeriod, xTimer,
+                                  static_cast<uint32_t>(xOptionalValue), pdPASS);
             break;
         }
         case tmrCOMMAND_RESET: {
             bool ok = s_fakeTimers->TimerReset(PointerToHandle(xTimer));
             configASSERT(ok);
+            cms::test::TraceEvent(cms::test::TraceOp::TimerReset, xTimer, 0, pdPASS);
             break;
         }
         default:
@@ -164,6 +271,94 @@ extern "C" BaseType_t xTimerGenericCommandFromTask( TimerHandle_t xTimer,
     return pdPASS;
 }
 
+extern "C" BaseType_t xTimerGenericCommandFromTask( TimerHandle_t xTimer,
+                                         const BaseType_t xCommandID,
+                                         const TickType_t xOptionalValue,
+                                         BaseType_t * const pxHigherPriorityTaskWoken,
+                                         const TickType_t xTicksToWait )
+{
+    configASSERT(!cms::test::IsInIsrContext());
+
+    (void)pxHigherPriorityTaskWoken;
+    (void)xTicksToWait;
+
+    //the command is processed at once, and is never refused by a full command queue
+    traceTIMER_COMMAND_SEND(xTimer, xCommandID, xOptionalValue, pdPASS);
+    return TimerCommand(xTimer, xCommandID, xOptionalValue);
+}
+
+extern "C" BaseType_t xTimerGenericCommandFromISR( TimerHandle_t xTimer,
+                                         const BaseType_t xCommandID,
+                                         const TickType_t xOptionalValue,
+                                         BaseType_t * const pxHigherPriorityTaskWoken,
+                                         const TickType_t xTicksToWait )
+{
+    (void)xTicksToWait;
+
+    BaseType_t command;
+    switch (xCommandID) {
+        case tmrCOMMAND_START_FROM_ISR:
+            command = tmrCOMMAND_START;
+            break;
+        case tmrCOMMAND_RESET_FROM_ISR:
+            command = tmrCOMMAND_RESET;
+            break;
+        case tmrCOMMAND_STOP_FROM_ISR:
+            command = tmrCOMMAND_STOP;
+            break;
+        case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR:
+            command = tmrCOMMAND_CHANGE_PERIOD;
+            break;
+        default:
+            configASSERT(true == false);
+            return pdFAIL;
+    }
+
+    traceTIMER_COMMAND_SEND(xTimer, xCommandID, xOptionalValue, pdPASS);
+    auto rtn = TimerCommand(xTimer, command, xOptionalValue);
+
+    //the timer service task is assumed to be the highest priority task
+    if (pxHigherPriorityTaskWoken != nullptr)
+    {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+
+    return rtn;
+}
+
+extern "C" BaseType_t xTimerPendFunctionCall( PendedFunction_t xFunctionToPend,
+                                   void * pvParameter1,
+                                   uint32_t ulParameter2,
+                                   TickType_t xTicksToWait )
+{
+    configASSERT(xFunctionToPend != nullptr);
+    configASSERT(!cms::test::IsInIsrContext());
+    (void)xTicksToWait;
+
+    //as with timer commands, the timer service task
+    //executes the pended function immediately.
+    xFunctionToPend(pvParameter1, ulParameter2);
+    return pdPASS;
+}
+
+extern "C" BaseType_t xTimerPendFunctionCallFromISR( PendedFunction_t xFunctionToPend,
+                                          void * pvParameter1,
+                                          uint32_t ulParameter2,
+                                          BaseType_t * pxHigherPriorityTaskWoken )
+{
+    configASSERT(xFunctionToPend != nullptr);
+
+    xFunctionToPend(pvParameter1, ulParameter2);
+
+    //the timer service task is assumed to be the highest priority task
+    if (pxHigherPriorityTaskWoken != nullptr)
+    {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+
+    return pdPASS;
+}
+
 extern "C" BaseType_t xTimerIsTimerActive( TimerHandle_t xTimer )
 {
     configASSERT(s_fakeTimers != nullptr);
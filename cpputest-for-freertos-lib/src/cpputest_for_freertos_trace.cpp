@@ -0,0 +1,171 @@
+/// @brief Provides an opt-in binary trace recorder of fake kernel API calls.
+///
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include "cpputest_for_freertos_fake_trace.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "FreeRTOS.h"
+
+//must be last
+#include "CppUTest/TestHarness.h"
+
+namespace cms {
+namespace test {
+
+    struct TraceRing
+    {
+        std::unique_ptr<TraceRecord[]> records;
+        uint64_t mask;
+        uint64_t eventCount;
+        std::chrono::steady_clock::time_point start;
+        bool hostTime;
+        std::string failureFile;
+    };
+
+    thread_local TraceRing* activeTrace = nullptr;
+
+    static size_t RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1U;
+        }
+        return result;
+    }
+
+    void TraceInit(size_t capacity, const char * failureFile, bool hostTime)
+    {
+        configASSERT(capacity > 0);
+        delete activeTrace;
+
+        capacity = RoundUpToPowerOfTwo(capacity);
+        activeTrace = new TraceRing();
+        activeTrace->records.reset(new TraceRecord[capacity]);
+        activeTrace->mask = capacity - 1;
+        activeTrace->eventCount = 0;
+        activeTrace->start = std::chrono::steady_clock::now();
+        activeTrace->hostTime = hostTime;
+        if (failureFile != nullptr)
+        {
+            activeTrace->failureFile = failureFile;
+        }
+    }
+
+    void TraceTeardown()
+    {
+        if (activeTrace == nullptr)
+        {
+            return;
+        }
+
+        if (!activeTrace->failureFile.empty() && UtestShell::getCurrent()->hasFailed())
+        {
+            if (TraceSave(activeTrace->failureFile.c_str()))
+            {
+                fprintf(stdout, "\nTrace of %llu events saved to %s\n",
+                        static_cast<unsigned long long>(activeTrace->eventCount),
+                        activeTrace->failureFile.c_str());
+            }
+        }
+
+        delete activeTrace;
+        activeTrace = nullptr;
+    }
+
+    uint64_t GetTraceEventCount()
+    {
+        return (activeTrace != nullptr) ? activeTrace->eventCount : 0;
+    }
+
+    std::vector<TraceRecord> GetTraceRecords()
+    {
+        std::vector<TraceRecord> records;
+        if (activeTrace == nullptr)
+        {
+            return records;
+        }
+
+        auto capacity = activeTrace->mask + 1;
+        auto first = (activeTrace->eventCount > capacity) ? (activeTrace->eventCount - capacity) : 0;
+        records.reserve(static_cast<size_t>(activeTrace->eventCount - first));
+        for (auto event = first; event < activeTrace->eventCount; ++event)
+        {
+            records.push_back(activeTrace->records[event & activeTrace->mask]);
+        }
+        return records;
+    }
+
+    bool TraceSave(const char * path)
+    {
+        configASSERT(path != nullptr);
+
+        auto records = GetTraceRecords();
+        TraceFileHeader header = {};
+        memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+        header.version = TRACE_FILE_VERSION;
+        header.recordSize = sizeof(TraceRecord);
+        header.eventCount = GetTraceEventCount();
+        header.recordCount = records.size();
+
+        auto file = fopen(path, "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        if (ok && !records.empty())
+        {
+            ok = fwrite(records.data(), sizeof(TraceRecord), records.size(), file) == records.size();
+        }
+        return (fclose(file) == 0) && ok;
+    }
+
+    void TraceRecordEvent(TraceRing & trace, TraceOp op, const void * object, uint32_t size, int32_t result)
+    {
+        auto & record = trace.records[trace.eventCount & trace.mask];
+        trace.eventCount++;
+        record.virtualTime = GetVirtualTime().count();
+        record.hostTime = 0;
+        if (trace.hostTime)
+        {
+            record.hostTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - trace.start).count();
+        }
+        record.object = reinterpret_cast<uintptr_t>(object);
+        record.size = size;
+        record.op = op;
+        record.result = static_cast<uint8_t>(result);
+        record.fromIsr = IsInIsrContext() ? 1 : 0;
+        record.reserved = 0;
+    }
+
+} //namespace test
+} //namespace cms
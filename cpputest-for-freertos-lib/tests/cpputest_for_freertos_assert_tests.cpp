@@ -21,16 +21,22 @@
 ///***************************************************************************
 /// @endcond
 #include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
 #include "cpputest_for_freertos_assert.hpp"
 
 TEST_GROUP(AssertTests)
 {
+    TestTestingFixture fixture;
+
     void setup() final
     {
+        cms::test::AssertInit();
     }
 
     void teardown() final
     {
+        cms::test::AssertTeardown();
+        cms::test::AssertOutputEnable();
         mock().clear();
     }
 };
@@ -42,3 +48,72 @@ TEST(AssertTests, configASSERT_results_in_expected_mock_hit_and_proper_test_exit
     configASSERT(true == false);
     mock().checkExpectations();
 }
+
+static unsigned long s_assertLine = 0;
+
+static void AssertFails()
+{
+    s_assertLine = __LINE__ + 1;
+    configASSERT(true == false);
+}
+
+TEST(AssertTests, expect_assert_counts_and_captures_asserts_without_mock)
+{
+    cms::test::AssertOutputDisable();
+    cms::test::ExpectAssert(3);
+    cms::test::AssertCaptureEnable(2);
+    fixture.setTestFunction(AssertFails);
+    for (int i = 0; i < 3; ++i)
+    {
+        fixture.runAllTests();
+    }
+
+    //no mock expectation was set, hence no failure proves mock() was bypassed
+    CHECK_EQUAL(0, fixture.getFailureCount());
+    CHECK_EQUAL(3, cms::test::AssertCount());
+    auto & records = cms::test::GetAssertRecords();
+    CHECK_EQUAL(2, records.size());
+    STRCMP_EQUAL(__FILE__, records[0].file);
+    CHECK_EQUAL(s_assertLine, records[0].line);
+    CHECK_EQUAL(s_assertLine, records[1].line);
+}
+
+TEST(AssertTests, assert_beyond_expected_count_fails_test)
+{
+    cms::test::AssertOutputDisable();
+    cms::test::ExpectAssert(1);
+    fixture.setTestFunction(AssertFails);
+    fixture.runAllTests();
+    CHECK_EQUAL(0, fixture.getFailureCount());
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+
+    //already reported by the failed test above
+    cms::test::AssertInit();
+}
+
+static void TeardownWithMissingAssert()
+{
+    cms::test::ExpectAssert(1);
+    cms::test::AssertTeardown();
+}
+
+TEST(AssertTests, assert_teardown_fails_test_when_expected_asserts_did_not_occur)
+{
+    fixture.setTestFunction(TeardownWithMissingAssert);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    CHECK_EQUAL(0, cms::test::AssertCount());
+}
+
+TEST(AssertTests, assert_count_includes_mocked_asserts)
+{
+    cms::test::AssertOutputDisable();
+    mock(cms::test::ASSERT_MOCK_NAME).expectNCalls(2, cms::test::ON_ASSERT_FUNC_NAME).ignoreOtherParameters();
+    fixture.setTestFunction(AssertFails);
+    fixture.runAllTests();
+    fixture.runAllTests();
+    CHECK_EQUAL(0, fixture.getFailureCount());
+    CHECK_EQUAL(2, cms::test::AssertCount());
+    mock().checkExpectations();
+}
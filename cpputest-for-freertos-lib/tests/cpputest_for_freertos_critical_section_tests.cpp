@@ -0,0 +1,208 @@
+/// @brief Tests of CppUTest for FreeRTOS critical section instrumentation.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <algorithm>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cpputest_for_freertos_suspend_site.h"
+#include "cpputest_for_freertos_critical_section.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+
+TEST_GROUP(CriticalSectionTests)
+{
+    TestTestingFixture fixture;
+
+    void setup() final
+    {
+        cms::test::TaskInit();
+        cms::test::CriticalSectionTrackingInit();
+    }
+
+    void teardown() final
+    {
+        cms::test::CriticalSectionTrackingTeardown();
+        cms::test::TaskDestroy();
+    }
+};
+
+TEST(CriticalSectionTests, critical_sections_track_nesting)
+{
+    CHECK_EQUAL(0, cms::test::GetCriticalNesting());
+    CHECK_FALSE(cms::test::AreInterruptsDisabled());
+
+    taskENTER_CRITICAL();
+    taskENTER_CRITICAL();
+    CHECK_EQUAL(2, cms::test::GetCriticalNesting());
+    CHECK_TRUE(cms::test::AreInterruptsDisabled());
+
+    taskEXIT_CRITICAL();
+    CHECK_EQUAL(1, cms::test::GetCriticalNesting());
+    taskEXIT_CRITICAL();
+    CHECK_EQUAL(0, cms::test::GetCriticalNesting());
+    CHECK_FALSE(cms::test::AreInterruptsDisabled());
+}
+
+TEST(CriticalSectionTests, nested_critical_sections_are_reported_as_one_region_at_outer_call_site)
+{
+    taskENTER_CRITICAL(); const unsigned long outerLine = __LINE__;
+    taskENTER_CRITICAL();
+    taskEXIT_CRITICAL();
+    taskEXIT_CRITICAL();
+
+    auto report = cms::test::GetCriticalRegionReport();
+    CHECK_EQUAL(1, report.size());
+    CHECK_TRUE(cms::test::CriticalRegionKind::Critical == report[0].kind);
+    CHECK_EQUAL(outerLine, report[0].line);
+    CHECK_EQUAL(1, report[0].count);
+}
+
+TEST(CriticalSectionTests, critical_region_records_virtual_duration)
+{
+    taskENTER_CRITICAL();
+    vTaskDelay(pdMS_TO_TICKS(5));
+    taskEXIT_CRITICAL();
+
+    taskENTER_CRITICAL();
+    vTaskDelay(pdMS_TO_TICKS(2));
+    taskEXIT_CRITICAL();
+
+    auto report = cms::test::GetCriticalRegionReport();
+    CHECK_EQUAL(2, report.size());
+    for (const auto& stats : report)
+    {
+        CHECK_EQUAL(1, stats.count);
+    }
+
+    auto longest = std::max(report[0].maxVirtualDuration, report[1].maxVirtualDuration);
+    CHECK_TRUE(std::chrono::milliseconds(5) == longest);
+}
+
+TEST(CriticalSectionTests, interrupt_disable_is_tracked_and_does_not_nest)
+{
+    taskDISABLE_INTERRUPTS();
+    taskDISABLE_INTERRUPTS();
+    CHECK_TRUE(cms::test::AreInterruptsDisabled());
+    taskENABLE_INTERRUPTS();
+    CHECK_FALSE(cms::test::AreInterruptsDisabled());
+
+    auto report = cms::test::GetCriticalRegionReport();
+    CHECK_EQUAL(1, report.size());
+    CHECK_TRUE(cms::test::CriticalRegionKind::InterruptsDisabled == report[0].kind);
+}
+
+TEST(CriticalSectionTests, interrupt_mask_from_isr_is_tracked)
+{
+    UBaseType_t outer = taskENTER_CRITICAL_FROM_ISR();
+    UBaseType_t inner = taskENTER_CRITICAL_FROM_ISR();
+    CHECK_TRUE(cms::test::AreInterruptsDisabled());
+    taskEXIT_CRITICAL_FROM_ISR(inner);
+    taskEXIT_CRITICAL_FROM_ISR(outer);
+    CHECK_FALSE(cms::test::AreInterruptsDisabled());
+    CHECK_EQUAL(0, cms::test::GetCriticalMismatchCount());
+}
+
+TEST(CriticalSectionTests, scheduler_suspend_and_resume_are_tracked)
+{
+    CHECK_EQUAL(taskSCHEDULER_RUNNING, xTaskGetSchedulerState());
+    vTaskSuspendAll();
+    vTaskSuspendAll();
+    CHECK_TRUE(cms::test::IsSchedulerSuspended());
+    CHECK_EQUAL(taskSCHEDULER_SUSPENDED, xTaskGetSchedulerState());
+    CHECK_EQUAL(pdFALSE, xTaskResumeAll());
+    CHECK_TRUE(cms::test::IsSchedulerSuspended());
+    xTaskResumeAll();
+    CHECK_FALSE(cms::test::IsSchedulerSuspended());
+}
+
+TEST(CriticalSectionTests, scheduler_suspension_is_reported_at_its_call_site)
+{
+    vTaskSuspendAll(); const unsigned long line = __LINE__;
+    vTaskSuspendAll();
+    xTaskResumeAll();
+    xTaskResumeAll();
+
+    //i.e. without the suspend site macro
+    (vTaskSuspendAll)();
+    xTaskResumeAll();
+
+    auto report = cms::test::GetCriticalRegionReport();
+    size_t attributed = 0;
+    size_t unattributed = 0;
+    for (const auto& stats : report)
+    {
+        if (stats.kind != cms::test::CriticalRegionKind::SchedulerSuspended)
+        {
+            continue;
+        }
+        if (stats.file == nullptr)
+        {
+            unattributed++;
+            continue;
+        }
+        attributed++;
+        STRCMP_EQUAL(__FILE__, stats.file);
+        CHECK_EQUAL(line, stats.line);
+        CHECK_EQUAL(1, stats.count);
+    }
+    CHECK_EQUAL(1, attributed);
+    CHECK_EQUAL(1, unattributed);
+}
+
+static void LeaveCriticalSectionActive()
+{
+    cms::test::CriticalSectionTrackingInit();
+    taskENTER_CRITICAL();
+    cms::test::CriticalSectionTrackingTeardown();
+}
+
+TEST(CriticalSectionTests, teardown_fails_test_if_critical_section_is_still_active)
+{
+    //the fixture's nested test uses its own tracking session
+    cms::test::CriticalSectionTrackingTeardown();
+    fixture.setTestFunction(LeaveCriticalSectionActive);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    CHECK_EQUAL(0, cms::test::GetCriticalNesting());
+    cms::test::CriticalSectionTrackingInit();
+}
+
+static void ExitWithoutEnter()
+{
+    cms::test::CriticalSectionTrackingInit();
+    taskEXIT_CRITICAL();
+    xTaskResumeAll();
+    CHECK_EQUAL(2, cms::test::GetCriticalMismatchCount());
+    cms::test::CriticalSectionTrackingTeardown();
+}
+
+TEST(CriticalSectionTests, teardown_fails_test_if_an_exit_was_mismatched)
+{
+    cms::test::CriticalSectionTrackingTeardown();
+    fixture.setTestFunction(ExitWithoutEnter);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    CHECK_EQUAL(0, cms::test::GetCriticalMismatchCount());
+    cms::test::CriticalSectionTrackingInit();
+}
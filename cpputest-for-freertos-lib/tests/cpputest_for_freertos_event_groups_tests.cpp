@@ -0,0 +1,161 @@
+/// @brief Tests of CppUTest for FreeRTOS event groups.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include "FreeRTOS.h"
+#include "event_groups.h"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_assert.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+static constexpr EventBits_t BIT_0 = (1U << 0);
+static constexpr EventBits_t BIT_1 = (1U << 1);
+static constexpr EventBits_t BIT_2 = (1U << 2);
+
+TEST_GROUP(EventGroupTests)
+{
+    EventGroupHandle_t mUnderTest = nullptr;
+
+    void setup() final
+    {
+        cms::test::TaskInit();
+        cms::test::IsrInit();
+        mUnderTest = xEventGroupCreate();
+        CHECK_TRUE(mUnderTest != nullptr);
+    }
+
+    void teardown() final
+    {
+        if (mUnderTest != nullptr)
+        {
+            vEventGroupDelete(mUnderTest);
+            mUnderTest = nullptr;
+        }
+        cms::test::IsrTeardown();
+        cms::test::TaskDestroy();
+        mock().clear();
+    }
+};
+
+TEST(EventGroupTests, new_event_group_has_no_bits_set)
+{
+    CHECK_EQUAL(0, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, set_and_clear_bits)
+{
+    CHECK_EQUAL(BIT_0 | BIT_2, xEventGroupSetBits(mUnderTest, BIT_0 | BIT_2));
+    CHECK_EQUAL(BIT_0 | BIT_2, xEventGroupClearBits(mUnderTest, BIT_0));
+    CHECK_EQUAL(BIT_2, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, wait_for_any_bit_returns_when_one_is_set)
+{
+    xEventGroupSetBits(mUnderTest, BIT_1);
+    auto bits = xEventGroupWaitBits(mUnderTest, BIT_0 | BIT_1, pdFALSE, pdFALSE, portMAX_DELAY);
+    CHECK_EQUAL(BIT_1, bits);
+    CHECK_EQUAL(BIT_1, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, wait_for_all_bits_is_not_satisfied_by_some_bits)
+{
+    xEventGroupSetBits(mUnderTest, BIT_0 | BIT_2);
+    auto bits = xEventGroupWaitBits(mUnderTest, BIT_0 | BIT_1, pdTRUE, pdTRUE, 0);
+    CHECK_EQUAL(BIT_0 | BIT_2, bits);
+
+    //not satisfied, so nothing was cleared
+    CHECK_EQUAL(BIT_0 | BIT_2, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, clear_on_exit_clears_only_the_waited_bits_once_satisfied)
+{
+    xEventGroupSetBits(mUnderTest, BIT_0 | BIT_1 | BIT_2);
+    auto bits = xEventGroupWaitBits(mUnderTest, BIT_0 | BIT_1, pdTRUE, pdTRUE, 0);
+    CHECK_EQUAL(BIT_0 | BIT_1 | BIT_2, bits);
+    CHECK_EQUAL(BIT_2, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, sync_sets_bits_and_clears_the_rendezvous_once_all_arrive)
+{
+    auto bits = xEventGroupSync(mUnderTest, BIT_0, BIT_0 | BIT_1, portMAX_DELAY);
+    CHECK_EQUAL(BIT_0, bits);
+    CHECK_EQUAL(BIT_0, xEventGroupGetBits(mUnderTest));
+
+    bits = xEventGroupSync(mUnderTest, BIT_1, BIT_0 | BIT_1, portMAX_DELAY);
+    CHECK_EQUAL(BIT_0 | BIT_1, bits);
+    CHECK_EQUAL(0, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, set_bits_from_isr_wakes_the_waiting_task)
+{
+    BaseType_t woken = pdFALSE;
+    cms::test::RunInIsrContext([&]()
+    {
+        CHECK_EQUAL(pdPASS, xEventGroupSetBitsFromISR(mUnderTest, BIT_1, &woken));
+        portYIELD_FROM_ISR(woken);
+    });
+    CHECK_EQUAL(pdTRUE, woken);
+    CHECK_EQUAL(BIT_1, xEventGroupGetBitsFromISR(mUnderTest));
+
+    xEventGroupWaitBits(mUnderTest, BIT_1, pdTRUE, pdFALSE, portMAX_DELAY);
+    CHECK_EQUAL(1, cms::test::GetIsrLatencies().size());
+    CHECK_EQUAL(0, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, clear_bits_from_isr)
+{
+    xEventGroupSetBits(mUnderTest, BIT_0 | BIT_1);
+    cms::test::RunInIsrContext([&]()
+    {
+        CHECK_EQUAL(pdPASS, xEventGroupClearBitsFromISR(mUnderTest, BIT_0));
+    });
+    CHECK_EQUAL(BIT_1, xEventGroupGetBits(mUnderTest));
+}
+
+TEST(EventGroupTests, static_event_group_lives_in_callers_buffer_without_heap_use)
+{
+    StaticEventGroup_t buffer;
+    StaticEventGroup_t * retrieved = nullptr;
+    auto allocations = cms::test::GetDynamicAllocationCount();
+
+    auto group = xEventGroupCreateStatic(&buffer);
+    POINTERS_EQUAL(&buffer, group);
+    CHECK_EQUAL(pdTRUE, xEventGroupGetStaticBuffer(group, &retrieved));
+    POINTERS_EQUAL(&buffer, retrieved);
+    xEventGroupSetBits(group, BIT_2);
+    CHECK_EQUAL(BIT_2, xEventGroupGetBits(group));
+    vEventGroupDelete(group);
+
+    CHECK_EQUAL(pdFALSE, xEventGroupGetStaticBuffer(mUnderTest, &retrieved));
+    CHECK_EQUAL(allocations, cms::test::GetDynamicAllocationCount());
+}
+
+TEST(EventGroupTests, waiting_on_control_bits_asserts)
+{
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    const EventBits_t controlBit = static_cast<EventBits_t>(1U) << ((sizeof(EventBits_t) * 8U) - 1U);
+    xEventGroupWaitBits(mUnderTest, controlBit, pdFALSE, pdFALSE, 0);
+    mock().checkExpectations();
+}
@@ -0,0 +1,431 @@
+/// @brief Tests of the CppUTest for FreeRTOS simulated heap.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "cpputest_for_freertos_assert.hpp"
+#include "cpputest_for_freertos_lib.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+#include "CppUTestExt/MockSupport.h"
+
+TEST_GROUP(HeapTests)
+{
+    void setup() final
+    {
+        cms::test::HeapInit();
+        cms::test::TaskInit();
+        cms::test::TimersInit();
+        cms::test::IsrInit();
+    }
+
+    void teardown() final
+    {
+        cms::test::IsrTeardown();
+        cms::test::TimersDestroy();
+        cms::test::TaskDestroy();
+        cms::test::HeapTeardown();
+        mock().clear();
+    }
+
+    //i.e. the decrease in free heap for an allocation of the given size
+    static size_t ChargeFor(size_t bytes)
+    {
+        auto free = xPortGetFreeHeapSize();
+        void * block = pvPortMalloc(bytes);
+        auto charge = free - xPortGetFreeHeapSize();
+        vPortFree(block);
+        return charge;
+    }
+
+    //i.e. heap_4's block header
+    static size_t BlockOverhead()
+    {
+        return ChargeFor(64) - 64;
+    }
+
+    static void ExhaustHeap()
+    {
+        while (pvPortMalloc(portBYTE_ALIGNMENT) != nullptr)
+        {
+        }
+    }
+};
+
+TEST(HeapTests, heap_is_the_configured_size_less_the_end_marker)
+{
+    auto free = xPortGetFreeHeapSize();
+    CHECK_EQUAL(free, xPortGetMinimumEverFreeHeapSize());
+    CHECK_TRUE(free < configTOTAL_HEAP_SIZE);
+    CHECK_TRUE(free >= (configTOTAL_HEAP_SIZE - (2 * BlockOverhead())));
+}
+
+TEST(HeapTests, allocation_is_charged_the_block_header_and_alignment)
+{
+    auto overhead = BlockOverhead();
+    CHECK_TRUE(overhead > 0);
+    CHECK_EQUAL(0, overhead % portBYTE_ALIGNMENT);
+
+    auto free = xPortGetFreeHeapSize();
+    void * block = pvPortMalloc(1);
+    CHECK_TRUE(block != nullptr);
+    CHECK_EQUAL(0, reinterpret_cast<size_t>(block) % portBYTE_ALIGNMENT);
+    auto charge = free - xPortGetFreeHeapSize();
+    CHECK_TRUE(charge > overhead);
+    CHECK_TRUE(charge <= (overhead + CMS_FREERTOS_TARGET_BYTE_ALIGNMENT));
+    CHECK_EQUAL(0, charge % CMS_FREERTOS_TARGET_BYTE_ALIGNMENT);
+
+    vPortFree(block);
+    CHECK_EQUAL(free, xPortGetFreeHeapSize());
+}
+
+TEST(HeapTests, block_header_is_two_target_pointers_rounded_up_to_the_target_alignment)
+{
+    const size_t alignment = CMS_FREERTOS_TARGET_BYTE_ALIGNMENT;
+    const size_t header = 2 * CMS_FREERTOS_TARGET_POINTER_SIZE;
+    CHECK_EQUAL(((header + alignment - 1) / alignment) * alignment, BlockOverhead());
+}
+
+TEST(HeapTests, allocations_are_aligned_for_any_host_type_whatever_the_target_alignment)
+{
+    //i.e. also when CMS_FREERTOS_TARGET_BYTE_ALIGNMENT is below the host's
+    std::array<void *, 8> blocks = {};
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        blocks[i] = pvPortMalloc((i * 3) + 1);
+        CHECK_TRUE(blocks[i] != nullptr);
+        CHECK_EQUAL(0, reinterpret_cast<uintptr_t>(blocks[i]) % alignof(std::max_align_t));
+        new (blocks[i]) std::max_align_t();
+    }
+
+    for (auto block : blocks)
+    {
+        vPortFree(block);
+    }
+}
+
+TEST(HeapTests, freed_neighbouring_blocks_are_coalesced)
+{
+    void * first = pvPortMalloc(64);
+    void * second = pvPortMalloc(64);
+    void * third = pvPortMalloc(64);
+
+    vPortFree(first);
+    vPortFree(third);
+
+    HeapStats_t stats = {};
+    vPortGetHeapStats(&stats);
+    CHECK_EQUAL(2, stats.xNumberOfFreeBlocks);
+    CHECK_EQUAL(3, stats.xNumberOfSuccessfulAllocations);
+    CHECK_EQUAL(2, stats.xNumberOfSuccessfulFrees);
+
+    vPortFree(second);
+    vPortGetHeapStats(&stats);
+    CHECK_EQUAL(1, stats.xNumberOfFreeBlocks);
+    CHECK_EQUAL(xPortGetFreeHeapSize(), stats.xSizeOfLargestFreeBlockInBytes);
+}
+
+TEST(HeapTests, fragmentation_is_visible_in_heap_stats)
+{
+    void * first = pvPortMalloc(64);
+    void * second = pvPortMalloc(64);
+    vPortFree(first);
+
+    HeapStats_t stats = {};
+    vPortGetHeapStats(&stats);
+    CHECK_EQUAL(2, stats.xNumberOfFreeBlocks);
+    CHECK_TRUE(stats.xSizeOfLargestFreeBlockInBytes < stats.xAvailableHeapSpaceInBytes);
+    CHECK_EQUAL(64 + BlockOverhead(), stats.xSizeOfSmallestFreeBlockInBytes);
+
+    vPortFree(second);
+}
+
+TEST(HeapTests, exhausted_heap_returns_null_and_records_minimum_ever_free)
+{
+    auto free = xPortGetFreeHeapSize();
+    void * big = pvPortMalloc(free / 2);
+    CHECK_TRUE(big != nullptr);
+    CHECK_TRUE(pvPortMalloc(free) == nullptr);
+
+    vPortFree(big);
+    CHECK_EQUAL(free, xPortGetFreeHeapSize());
+    CHECK_TRUE(xPortGetMinimumEverFreeHeapSize() < free);
+
+    xPortResetHeapMinimumEverFreeHeapSize();
+    CHECK_EQUAL(free, xPortGetMinimumEverFreeHeapSize());
+}
+
+TEST(HeapTests, calloc_zeroes_and_rejects_overflow)
+{
+    auto block = static_cast<uint8_t *>(pvPortCalloc(4, 8));
+    CHECK_TRUE(block != nullptr);
+    for (size_t i = 0; i < 32; ++i)
+    {
+        CHECK_EQUAL(0, block[i]);
+    }
+    vPortFree(block);
+
+    CHECK_TRUE(pvPortCalloc(SIZE_MAX, 2) == nullptr);
+}
+
+TEST(HeapTests, double_free_asserts)
+{
+    void * block = pvPortMalloc(16);
+    vPortFree(block);
+
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    vPortFree(block);
+    mock().checkExpectations();
+}
+
+TEST(HeapTests, malloc_from_isr_asserts)
+{
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    cms::test::RunInIsrContext([]() { (void)pvPortMalloc(16); });
+    mock().checkExpectations();
+}
+
+TEST(HeapTests, dynamically_created_queue_is_charged_to_the_heap)
+{
+    auto expected = ChargeFor(CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE + (10 * sizeof(uint32_t)));
+    auto free = xPortGetFreeHeapSize();
+    auto queue = xQueueCreate(10, sizeof(uint32_t));
+    CHECK_TRUE(queue != nullptr);
+    CHECK_EQUAL(free - expected, xPortGetFreeHeapSize());
+
+    vQueueDelete(queue);
+    CHECK_EQUAL(free, xPortGetFreeHeapSize());
+}
+
+TEST(HeapTests, statically_created_queue_is_not_charged_to_the_heap)
+{
+    StaticQueue_t control;
+    uint8_t storage[10 * sizeof(uint32_t)];
+    auto free = xPortGetFreeHeapSize();
+
+    auto queue = xQueueCreateStatic(10, sizeof(uint32_t), storage, &control);
+    CHECK_EQUAL(free, xPortGetFreeHeapSize());
+    vQueueDelete(queue);
+}
+
+TEST(HeapTests, kernel_objects_are_not_created_when_the_heap_is_exhausted)
+{
+    ExhaustHeap();
+
+    CHECK_TRUE(xQueueCreate(1, sizeof(uint32_t)) == nullptr);
+    CHECK_TRUE(xSemaphoreCreateMutex() == nullptr);
+    CHECK_TRUE(xEventGroupCreate() == nullptr);
+    CHECK_TRUE(xStreamBufferCreate(16, 1) == nullptr);
+    CHECK_TRUE(xTimerCreate("timer", 10, pdFALSE, nullptr, [](TimerHandle_t){}) == nullptr);
+
+    TaskHandle_t task = nullptr;
+    CHECK_EQUAL(errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY,
+                xTaskCreate([](void*){}, "task", 100, nullptr, 1, &task));
+}
+
+TEST(HeapTests, task_stack_and_control_block_are_returned_on_delete)
+{
+    auto free = xPortGetFreeHeapSize();
+    TaskHandle_t task = nullptr;
+    CHECK_EQUAL(pdPASS, xTaskCreate([](void*){}, "task", 100, nullptr, 1, &task));
+    CHECK_TRUE(xPortGetFreeHeapSize() <= (free - (100 * CMS_FREERTOS_TARGET_SIZEOF_STACK_TYPE) - CMS_FREERTOS_TARGET_SIZEOF_STATIC_TASK));
+
+    vTaskDelete(task);
+    CHECK_EQUAL(free, xPortGetFreeHeapSize());
+}
+
+TEST(HeapTests, timer_is_returned_on_delete)
+{
+    auto expected = ChargeFor(CMS_FREERTOS_TARGET_SIZEOF_STATIC_TIMER);
+    auto free = xPortGetFreeHeapSize();
+    auto timer = xTimerCreate("timer", 10, pdFALSE, nullptr, [](TimerHandle_t){});
+    CHECK_TRUE(timer != nullptr);
+    CHECK_EQUAL(free - expected, xPortGetFreeHeapSize());
+
+    xTimerDelete(timer, 0);
+    CHECK_EQUAL(free, xPortGetFreeHeapSize());
+}
+
+TEST(HeapTests, objects_created_before_a_heap_reset_may_still_be_deleted)
+{
+    auto queue = xQueueCreate(4, sizeof(uint32_t));
+    cms::test::HeapTeardown();
+    cms::test::HeapInit();
+    auto free = xPortGetFreeHeapSize();
+
+    vQueueDelete(queue);
+    CHECK_EQUAL(free, xPortGetFreeHeapSize());
+}
+
+TEST_GROUP(ArenaTests)
+{
+    void setup() final
+    {
+        cms::test::ArenaInit();
+    }
+
+    void teardown() final
+    {
+        cms::test::ArenaTeardown();
+    }
+};
+
+TEST(ArenaTests, fake_objects_are_allocated_from_the_arena_until_it_is_released)
+{
+    CHECK_EQUAL(0, cms::test::GetArenaBytesUsed());
+
+    auto queue = xQueueCreate(4, sizeof(uint64_t));
+    auto group = xEventGroupCreate();
+    auto used = cms::test::GetArenaBytesUsed();
+    CHECK_TRUE(used >= (4 * sizeof(uint64_t)));
+
+    //i.e. memory is reclaimed in one step, not per object
+    vEventGroupDelete(group);
+    vQueueDelete(queue);
+    CHECK_EQUAL(used, cms::test::GetArenaBytesUsed());
+
+    cms::test::ArenaTeardown();
+    CHECK_EQUAL(0, cms::test::GetArenaBytesUsed());
+    cms::test::ArenaInit();
+}
+
+TEST(ArenaTests, arena_grows_beyond_its_first_chunk)
+{
+    //the simulated FreeRTOS heap is returned on each delete, the arena is not
+    for (uint64_t i = 0; i < 2000; ++i)
+    {
+        auto queue = xQueueCreate(8, sizeof(uint64_t));
+        CHECK_TRUE(queue != nullptr);
+        CHECK_EQUAL(pdTRUE, xQueueSendToBack(queue, &i, 0));
+        vQueueDelete(queue);
+    }
+    CHECK_TRUE(cms::test::GetArenaBytesUsed() >= (2000 * 8 * sizeof(uint64_t)));
+
+    auto buffer = xStreamBufferCreate(64, 1);
+    uint8_t byte = 0x5a;
+    CHECK_EQUAL(1, xStreamBufferSend(buffer, &byte, 1, 0));
+    byte = 0;
+    CHECK_EQUAL(1, xStreamBufferReceive(buffer, &byte, 1, 0));
+    CHECK_EQUAL(0x5a, byte);
+    vStreamBufferDelete(buffer);
+}
+
+TEST(ArenaTests, object_created_before_the_arena_may_be_deleted_within_it)
+{
+    cms::test::ArenaTeardown();
+    auto queue = xQueueCreate(4, sizeof(uint32_t));
+    CHECK_EQUAL(0, cms::test::GetArenaBytesUsed());
+
+    cms::test::ArenaInit();
+    vQueueDelete(queue);
+}
+
+TEST_GROUP(ArenaLifetimeTests)
+{
+    void setup() final
+    {
+        cms::test::LibInitAll();
+    }
+
+    void teardown() final
+    {
+        cms::test::LibTeardownAll();
+    }
+};
+
+TEST(ArenaLifetimeTests, objects_may_be_deleted_after_lib_teardown_all)
+{
+    //untracked, as these outlive the teardown without being leaks
+    cms::test::KernelObjectTrackingTeardown();
+    auto queue = xQueueCreate(4, sizeof(uint32_t));
+    auto buffer = xStreamBufferCreate(16, 1);
+    auto owned = cms::test::make_unique_stream_buffer(16, 1);
+    cms::test::KernelObjectTrackingInit();
+    cms::test::LibTeardownAll();
+
+    //e.g. a fixture member, deleted after teardown()
+    uint32_t sent = 42;
+    CHECK_EQUAL(pdTRUE, xQueueSend(queue, &sent, 0));
+    vQueueDelete(queue);
+
+    //e.g. a module's handle, deleted by the next test's setup
+    cms::test::LibInitAll();
+    CHECK_EQUAL(0, cms::test::GetArenaBytesUsed());
+    auto reused = xStreamBufferCreate(16, 1);
+    vStreamBufferDelete(buffer);
+    owned.reset();
+    vStreamBufferDelete(reused);
+}
+
+TEST_GROUP(LibInitTests)
+{
+    TestTestingFixture fixture;
+
+    void setup() final
+    {
+        cms::test::LibInitAll();
+    }
+
+    void teardown() final
+    {
+        cms::test::LibTeardownAll();
+    }
+};
+
+static void LeaveStateForTheSkippedTeardowns()
+{
+    static StaticSemaphore_t mutexBuffer;
+    auto mutex = xSemaphoreCreateMutexStatic(&mutexBuffer);
+    xSemaphoreTake(mutex, 0);
+    taskENTER_CRITICAL();
+    cms::test::SetFootprintBudget(1);
+}
+
+TEST(LibInitTests, init_discards_the_state_of_teardowns_skipped_by_a_failure)
+{
+    //the locked mutex fails MutexTrackingTeardown(), skipping the teardowns after it
+    fixture.setTestFunction(LeaveStateForTheSkippedTeardowns);
+    fixture.setTeardown(cms::test::LibTeardownAll);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    CHECK_TRUE(cms::test::TimersIsActive());
+
+    //i.e. the next test's setup
+    cms::test::LibInitAll();
+    CHECK_EQUAL(0, cms::test::GetCriticalNesting());
+    CHECK_EQUAL(0, cms::test::GetLiveKernelObjects().size());
+}
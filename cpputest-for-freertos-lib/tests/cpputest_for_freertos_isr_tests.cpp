@@ -0,0 +1,340 @@
+/// @brief Tests of CppUTest for FreeRTOS simulated ISR context and ISR latency.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "cpputest_for_freertos_assert.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+using namespace std::chrono_literals;
+
+TEST_GROUP(IsrTests)
+{
+    QueueHandle_t mQueue = nullptr;
+
+    void setup() final
+    {
+        cms::test::TaskInit();
+        cms::test::IsrInit();
+        mQueue = xQueueCreate(10, sizeof(uint32_t));
+    }
+
+    void teardown() final
+    {
+        if (mQueue != nullptr)
+        {
+            vQueueDelete(mQueue);
+            mQueue = nullptr;
+        }
+        cms::test::IsrTeardown();
+        cms::test::TaskDestroy();
+        mock().clear();
+    }
+
+    void SendFromIsr(uint32_t value, bool yield)
+    {
+        cms::test::RunInIsrContext([&]()
+        {
+            BaseType_t woken = pdFALSE;
+            CHECK_EQUAL(pdTRUE, xQueueSendFromISR(mQueue, &value, &woken));
+            if (yield)
+            {
+                portYIELD_FROM_ISR(woken);
+            }
+        });
+    }
+
+    void ReceiveFromTask(uint32_t expected)
+    {
+        uint32_t value = 0;
+        CHECK_EQUAL(pdTRUE, xQueueReceive(mQueue, &value, 0));
+        CHECK_EQUAL(expected, value);
+    }
+};
+
+TEST(IsrTests, not_in_isr_context_by_default)
+{
+    CHECK_FALSE(cms::test::IsInIsrContext());
+}
+
+TEST(IsrTests, run_in_isr_context_sets_isr_context_for_duration_of_the_call)
+{
+    bool wasInIsr = false;
+    cms::test::RunInIsrContext([&]()
+    {
+        wasInIsr = cms::test::IsInIsrContext();
+    });
+    CHECK_TRUE(wasInIsr);
+    CHECK_FALSE(cms::test::IsInIsrContext());
+}
+
+TEST(IsrTests, nested_isr_remains_in_isr_context_until_outermost_isr_returns)
+{
+    bool afterNested = false;
+    cms::test::RunInIsrContext([&]()
+    {
+        cms::test::RunInIsrContext([]() {});
+        afterNested = cms::test::IsInIsrContext();
+    });
+    CHECK_TRUE(afterNested);
+    CHECK_FALSE(cms::test::IsInIsrContext());
+}
+
+TEST(IsrTests, queue_send_asserts_in_isr_context)
+{
+    uint32_t value = 1;
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    cms::test::RunInIsrContext([&]()
+    {
+        xQueueSend(mQueue, &value, 0);
+    });
+    mock().checkExpectations();
+    CHECK_FALSE(cms::test::IsInIsrContext());
+}
+
+TEST(IsrTests, semaphore_take_asserts_in_isr_context)
+{
+    SemaphoreHandle_t sema = xSemaphoreCreateBinary();
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    cms::test::RunInIsrContext([&]()
+    {
+        xSemaphoreTake(sema, 0);
+    });
+    mock().checkExpectations();
+    vSemaphoreDelete(sema);
+}
+
+TEST(IsrTests, task_delay_asserts_in_isr_context)
+{
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    cms::test::RunInIsrContext([]()
+    {
+        vTaskDelay(1);
+    });
+    mock().checkExpectations();
+}
+
+TEST(IsrTests, from_isr_apis_may_be_used_in_isr_context)
+{
+    SemaphoreHandle_t sema = xSemaphoreCreateBinary();
+    cms::test::RunInIsrContext([&]()
+    {
+        uint32_t value = 123;
+        CHECK_EQUAL(pdTRUE, xQueueSendFromISR(mQueue, &value, nullptr));
+        CHECK_EQUAL(1, uxQueueMessagesWaitingFromISR(mQueue));
+        CHECK_EQUAL(pdFALSE, xQueueIsQueueEmptyFromISR(mQueue));
+        CHECK_EQUAL(pdFALSE, xQueueIsQueueFullFromISR(mQueue));
+
+        uint32_t peeked = 0;
+        CHECK_EQUAL(pdTRUE, xQueuePeekFromISR(mQueue, &peeked));
+        CHECK_EQUAL(123, peeked);
+
+        uint32_t received = 0;
+        CHECK_EQUAL(pdTRUE, xQueueReceiveFromISR(mQueue, &received, nullptr));
+        CHECK_EQUAL(123, received);
+
+        CHECK_EQUAL(pdTRUE, xSemaphoreGiveFromISR(sema, nullptr));
+        CHECK_EQUAL(pdTRUE, xSemaphoreTakeFromISR(sema, nullptr));
+    });
+    vSemaphoreDelete(sema);
+}
+
+TEST(IsrTests, tick_count_from_isr_matches_task_tick_count)
+{
+    vTaskDelay(pdMS_TO_TICKS(42));
+    TickType_t fromIsr = 0;
+    cms::test::RunInIsrContext([&]()
+    {
+        fromIsr = xTaskGetTickCountFromISR();
+    });
+    CHECK_EQUAL(xTaskGetTickCount(), fromIsr);
+}
+
+TEST(IsrTests, send_from_isr_reports_higher_priority_task_woken)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t value = 1;
+    cms::test::RunInIsrContext([&]()
+    {
+        xQueueSendFromISR(mQueue, &value, &woken);
+    });
+    CHECK_EQUAL(pdTRUE, woken);
+}
+
+TEST(IsrTests, yield_from_isr_is_recorded_for_the_most_recent_isr)
+{
+    SendFromIsr(1, true);
+    CHECK_TRUE(cms::test::WasYieldRequestedFromIsr());
+
+    SendFromIsr(2, false);
+    CHECK_FALSE(cms::test::WasYieldRequestedFromIsr());
+}
+
+TEST(IsrTests, no_latency_is_recorded_until_task_receives_the_event)
+{
+    SendFromIsr(1, true);
+    CHECK_TRUE(cms::test::GetIsrLatencies().empty());
+    CHECK_TRUE(0ns == cms::test::GetMaxIsrLatency());
+}
+
+TEST(IsrTests, latency_is_zero_when_isr_yields_and_task_receives_immediately)
+{
+    SendFromIsr(1, true);
+    ReceiveFromTask(1);
+
+    auto latencies = cms::test::GetIsrLatencies();
+    CHECK_EQUAL(1, latencies.size());
+    CHECK_TRUE(0ns == latencies[0]);
+}
+
+TEST(IsrTests, latency_extends_to_next_tick_when_isr_does_not_yield)
+{
+    SendFromIsr(1, false);
+    ReceiveFromTask(1);
+
+    auto latencies = cms::test::GetIsrLatencies();
+    CHECK_EQUAL(1, latencies.size());
+    CHECK_TRUE(1ms == latencies[0]);
+}
+
+TEST(IsrTests, latency_includes_time_until_the_task_receives_the_event)
+{
+    SendFromIsr(1, true);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    ReceiveFromTask(1);
+
+    CHECK_TRUE(5ms == cms::test::GetMaxIsrLatency());
+}
+
+TEST(IsrTests, latency_is_tracked_per_event_in_order_of_receipt)
+{
+    SendFromIsr(1, true);
+    vTaskDelay(pdMS_TO_TICKS(2));
+    SendFromIsr(2, true);
+    vTaskDelay(pdMS_TO_TICKS(1));
+    ReceiveFromTask(1);
+    ReceiveFromTask(2);
+
+    auto latencies = cms::test::GetIsrLatencies();
+    CHECK_EQUAL(2, latencies.size());
+    CHECK_TRUE(3ms == latencies[0]);
+    CHECK_TRUE(1ms == latencies[1]);
+    CHECK_TRUE(3ms == cms::test::GetMaxIsrLatency());
+}
+
+TEST(IsrTests, semaphore_given_from_isr_records_latency_when_taken)
+{
+    SemaphoreHandle_t sema = xSemaphoreCreateBinary();
+    cms::test::RunInIsrContext([&]()
+    {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(sema, &woken);
+        portYIELD_FROM_ISR(woken);
+    });
+    vTaskDelay(pdMS_TO_TICKS(3));
+    CHECK_EQUAL(pdTRUE, xSemaphoreTake(sema, 0));
+    vSemaphoreDelete(sema);
+
+    CHECK_TRUE(3ms == cms::test::GetMaxIsrLatency());
+}
+
+TEST(IsrTests, events_received_within_isr_context_do_not_record_latency)
+{
+    SendFromIsr(1, true);
+    cms::test::RunInIsrContext([&]()
+    {
+        uint32_t value = 0;
+        xQueueReceiveFromISR(mQueue, &value, nullptr);
+    });
+    CHECK_TRUE(cms::test::GetIsrLatencies().empty());
+
+    vTaskDelay(pdMS_TO_TICKS(2));
+    SendFromIsr(2, true);
+    vTaskDelay(pdMS_TO_TICKS(4));
+    ReceiveFromTask(2);
+
+    auto latencies = cms::test::GetIsrLatencies();
+    CHECK_EQUAL(1, latencies.size());
+    CHECK_TRUE(4ms == latencies[0]);
+}
+
+TEST(IsrTests, deleting_a_queue_discards_its_pending_isr_events)
+{
+    SendFromIsr(1, true);
+    vQueueDelete(mQueue);
+    mQueue = xQueueCreate(10, sizeof(uint32_t));
+
+    uint32_t value = 5;
+    xQueueSend(mQueue, &value, 0);
+    ReceiveFromTask(5);
+    CHECK_TRUE(cms::test::GetIsrLatencies().empty());
+}
+
+static void TimerCallback(TimerHandle_t timer)
+{
+    (void)timer;
+}
+
+TEST(IsrTests, timers_may_be_started_and_stopped_from_isr_context)
+{
+    cms::test::TimersInit();
+    auto timer = xTimerCreate("isr", pdMS_TO_TICKS(10), pdFALSE, nullptr, TimerCallback);
+    BaseType_t woken = pdFALSE;
+    cms::test::RunInIsrContext([&]()
+    {
+        CHECK_EQUAL(pdPASS, xTimerStartFromISR(timer, &woken));
+    });
+    CHECK_TRUE(xTimerIsTimerActive(timer));
+    CHECK_EQUAL(pdTRUE, woken);
+
+    cms::test::RunInIsrContext([&]()
+    {
+        CHECK_EQUAL(pdPASS, xTimerStopFromISR(timer, nullptr));
+    });
+    CHECK_FALSE(xTimerIsTimerActive(timer));
+
+    xTimerDelete(timer, 0);
+    cms::test::TimersDestroy();
+}
+
+#if configNUMBER_OF_CORES > 1
+TEST(IsrTests, port_check_if_in_isr_reports_isr_context)
+{
+    CHECK_EQUAL(0, portCHECK_IF_IN_ISR());
+    BaseType_t inIsr = pdFALSE;
+    cms::test::RunInIsrContext([&]()
+    {
+        inIsr = portCHECK_IF_IN_ISR();
+    });
+    CHECK_EQUAL(pdTRUE, inIsr);
+}
+#endif
@@ -0,0 +1,264 @@
+/// @brief Tests of CppUTest for FreeRTOS kernel object leak detection.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <cstring>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+#include "cpputest_for_freertos_creation_site.h"
+#include "cpputest_for_freertos_kernel_objects.hpp"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+
+using cms::test::KernelObjectKind;
+
+TEST_GROUP(KernelObjectTests)
+{
+    TestTestingFixture fixture;
+
+    void setup() final
+    {
+        cms::test::HeapInit();
+        cms::test::TaskInit();
+        cms::test::TimersInit();
+        cms::test::KernelObjectTrackingInit();
+    }
+
+    void teardown() final
+    {
+        cms::test::KernelObjectTrackingTeardown();
+        cms::test::TimersDestroy();
+        cms::test::TaskDestroy();
+        cms::test::HeapTeardown();
+    }
+};
+
+TEST(KernelObjectTests, deleted_objects_are_no_longer_live)
+{
+    auto queue = xQueueCreate(2, sizeof(uint32_t));
+    auto group = xEventGroupCreate();
+    CHECK_EQUAL(2, cms::test::GetLiveKernelObjects().size());
+
+    vQueueDelete(queue);
+    vEventGroupDelete(group);
+    CHECK_EQUAL(0, cms::test::GetLiveKernelObjects().size());
+}
+
+TEST(KernelObjectTests, live_objects_are_listed_in_creation_order_with_kind_and_name)
+{
+    auto queue = xQueueCreate(2, sizeof(uint32_t));
+    vQueueAddToRegistry(queue, "events");
+    auto sema = xSemaphoreCreateCounting(4, 0);
+    auto mutex = xSemaphoreCreateMutex();
+    TaskHandle_t task = nullptr;
+    xTaskCreate([](void*){}, "worker", 100, nullptr, 1, &task);
+    auto timer = xTimerCreate("retry", 10, pdFALSE, nullptr, [](TimerHandle_t){});
+    auto group = xEventGroupCreate();
+    auto stream = xStreamBufferCreate(16, 1);
+    auto message = xMessageBufferCreate(16);
+
+    auto live = cms::test::GetLiveKernelObjects();
+    CHECK_EQUAL(8, live.size());
+    CHECK_TRUE(KernelObjectKind::Queue == live[0].kind);
+    STRCMP_EQUAL("events", live[0].name.c_str());
+    CHECK_TRUE(KernelObjectKind::Semaphore == live[1].kind);
+    CHECK_TRUE(KernelObjectKind::Mutex == live[2].kind);
+    CHECK_TRUE(KernelObjectKind::Task == live[3].kind);
+    STRCMP_EQUAL("worker", live[3].name.c_str());
+    CHECK_TRUE(KernelObjectKind::Timer == live[4].kind);
+    STRCMP_EQUAL("retry", live[4].name.c_str());
+    CHECK_TRUE(KernelObjectKind::EventGroup == live[5].kind);
+    CHECK_TRUE(KernelObjectKind::StreamBuffer == live[6].kind);
+    CHECK_TRUE(KernelObjectKind::MessageBuffer == live[7].kind);
+    for (size_t i = 1; i < live.size(); ++i)
+    {
+        CHECK_TRUE(live[i - 1].sequence < live[i].sequence);
+    }
+
+    vMessageBufferDelete(message);
+    vStreamBufferDelete(stream);
+    vEventGroupDelete(group);
+    xTimerDelete(timer, 0);
+    vTaskDelete(task);
+    vSemaphoreDelete(mutex);
+    vSemaphoreDelete(sema);
+    vQueueDelete(queue);
+}
+
+TEST(KernelObjectTests, creation_site_is_recorded)
+{
+    auto queue = xQueueCreate(2, sizeof(uint32_t)); const unsigned long line = __LINE__;
+
+    auto live = cms::test::GetLiveKernelObjects();
+    CHECK_EQUAL(1, live.size());
+    CHECK_TRUE(live[0].file != nullptr);
+    STRCMP_EQUAL(__FILE__, live[0].file);
+    CHECK_EQUAL(line, live[0].line);
+
+    vQueueDelete(queue);
+}
+
+TEST(KernelObjectTests, creation_site_of_a_failed_creation_is_not_reused)
+{
+    void * block = nullptr;
+    while ((block = pvPortMalloc(portBYTE_ALIGNMENT)) != nullptr)
+    {
+    }
+    CHECK_TRUE(xQueueCreate(1, sizeof(uint32_t)) == nullptr);
+    cms::test::HeapTeardown();
+    cms::test::HeapInit();
+
+    //i.e. created without the creation site macros
+    auto group = (xEventGroupCreate)();
+    auto live = cms::test::GetLiveKernelObjects();
+    CHECK_EQUAL(1, live.size());
+    CHECK_TRUE(live[0].file == nullptr);
+
+    vEventGroupDelete(group);
+}
+
+TEST(KernelObjectTests, statically_created_objects_are_not_tracked)
+{
+    StaticSemaphore_t buffer;
+    auto sema = xSemaphoreCreateBinaryStatic(&buffer);
+    CHECK_EQUAL(0, cms::test::GetLiveKernelObjects().size());
+    vSemaphoreDelete(sema);
+}
+
+static QueueHandle_t s_leakedQueue = nullptr;
+
+static void LeakQueue()
+{
+    cms::test::KernelObjectTrackingInit();
+    s_leakedQueue = xQueueCreate(1, sizeof(uint32_t));
+    cms::test::KernelObjectTrackingTeardown();
+}
+
+TEST(KernelObjectTests, teardown_fails_test_if_an_object_was_not_deleted)
+{
+    //the fixture's nested test uses its own tracking session
+    cms::test::KernelObjectTrackingTeardown();
+    fixture.setTestFunction(LeakQueue);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    cms::test::KernelObjectTrackingInit();
+
+    vQueueDelete(s_leakedQueue);
+    s_leakedQueue = nullptr;
+}
+
+TEST(KernelObjectTests, footprint_report_sums_objects_by_kind_and_name)
+{
+    auto first = xQueueCreate(4, sizeof(uint32_t));
+    auto second = xQueueCreate(2, sizeof(uint32_t));
+    vQueueAddToRegistry(first, "commands");
+    vQueueAddToRegistry(second, "commands");
+    auto group = xEventGroupCreate();
+
+    const size_t queueBytes = (2 * CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE) + (6 * sizeof(uint32_t));
+    auto report = cms::test::GetFootprintReport();
+    CHECK_EQUAL(queueBytes + CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP, report.totalBytes);
+    CHECK_EQUAL(2, report.entries.size());
+    CHECK_TRUE(KernelObjectKind::Queue == report.entries[0].kind);
+    STRCMP_EQUAL("commands", report.entries[0].name.c_str());
+    CHECK_EQUAL(2, report.entries[0].count);
+    CHECK_EQUAL(queueBytes, report.entries[0].bytes);
+    CHECK_TRUE(KernelObjectKind::EventGroup == report.entries[1].kind);
+    CHECK_EQUAL(CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP, report.entries[1].bytes);
+
+    vEventGroupDelete(group);
+    vQueueDelete(second);
+    vQueueDelete(first);
+}
+
+TEST(KernelObjectTests, footprint_of_a_task_includes_its_stack)
+{
+    TaskHandle_t task = nullptr;
+    xTaskCreate([](void*){}, "worker", 256, nullptr, 1, &task);
+
+    auto report = cms::test::GetFootprintReport();
+    CHECK_EQUAL(1, report.entries.size());
+    STRCMP_EQUAL("worker", report.entries[0].name.c_str());
+    CHECK_EQUAL(CMS_FREERTOS_TARGET_SIZEOF_STATIC_TASK + (256 * CMS_FREERTOS_TARGET_SIZEOF_STACK_TYPE), report.totalBytes);
+
+    vTaskDelete(task);
+}
+
+TEST(KernelObjectTests, footprint_peak_remains_after_objects_are_deleted)
+{
+    auto first = xQueueCreate(8, sizeof(uint32_t));
+    auto second = xSemaphoreCreateBinary();
+    auto peak = cms::test::GetFootprintReport().liveBytes;
+    vQueueDelete(first);
+    vSemaphoreDelete(second);
+    auto third = xSemaphoreCreateBinary();
+
+    auto report = cms::test::GetFootprintReport();
+    CHECK_EQUAL(peak, report.peakBytes);
+    CHECK_EQUAL(CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE, report.liveBytes);
+    CHECK_EQUAL(peak + CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE, report.totalBytes);
+
+    vSemaphoreDelete(third);
+}
+
+TEST(KernelObjectTests, footprint_includes_statically_created_objects)
+{
+    StaticEventGroup_t buffer;
+    xEventGroupCreateStatic(&buffer);
+
+    auto report = cms::test::GetFootprintReport();
+    CHECK_EQUAL(CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP, report.totalBytes);
+    CHECK_EQUAL(CMS_FREERTOS_TARGET_SIZEOF_STATIC_EVENT_GROUP, report.liveBytes);
+}
+
+static void ExceedFootprintBudget()
+{
+    cms::test::KernelObjectTrackingInit();
+    cms::test::SetFootprintBudget(CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE);
+    auto queue = xQueueCreate(1, sizeof(uint32_t));
+    vQueueDelete(queue);
+    cms::test::KernelObjectTrackingTeardown();
+}
+
+TEST(KernelObjectTests, teardown_fails_test_if_footprint_budget_was_exceeded)
+{
+    cms::test::KernelObjectTrackingTeardown();
+    fixture.setTestFunction(ExceedFootprintBudget);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    cms::test::KernelObjectTrackingInit();
+}
+
+TEST(KernelObjectTests, footprint_within_budget_passes)
+{
+    cms::test::SetFootprintBudget(CMS_FREERTOS_TARGET_SIZEOF_STATIC_QUEUE + sizeof(uint32_t));
+    auto queue = xQueueCreate(1, sizeof(uint32_t));
+    vQueueDelete(queue);
+}
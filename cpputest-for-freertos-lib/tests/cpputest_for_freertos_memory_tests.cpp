@@ -0,0 +1,178 @@
+/// @brief Tests of the CppUTest for FreeRTOS kernel object owners.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_kernel_objects.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "CppUTest/TestHarness.h"
+
+using namespace std::chrono_literals;
+
+TEST_GROUP(MemoryTests)
+{
+    void setup() final
+    {
+        cms::test::HeapInit();
+        cms::test::TaskInit();
+        cms::test::TimersInit();
+        cms::test::KernelObjectTrackingInit();
+    }
+
+    void teardown() final
+    {
+        cms::test::KernelObjectTrackingTeardown();
+        cms::test::TimersDestroy();
+        cms::test::TaskDestroy();
+        cms::test::HeapTeardown();
+    }
+};
+
+static void TimerCallback(TimerHandle_t timer)
+{
+    auto count = static_cast<uint32_t *>(pvTimerGetTimerID(timer));
+    (*count)++;
+}
+
+TEST(MemoryTests, factories_do_not_use_the_heap)
+{
+    auto freeBefore = xPortGetFreeHeapSize();
+    auto allocationsBefore = cms::test::GetDynamicAllocationCount();
+    uint32_t count = 0;
+
+    auto queue = cms::test::make_unique_queue(4, sizeof(uint32_t));
+    auto binary = cms::test::make_unique_binary_sema();
+    auto counting = cms::test::make_unique_counting_sema(3, 1);
+    auto mutex = cms::test::make_unique_mutex();
+    auto recursive = cms::test::make_unique_recursive_mutex();
+    auto timer = cms::test::make_unique_timer("timer", pdMS_TO_TICKS(10), pdFALSE, &count, TimerCallback);
+    auto group = cms::test::make_unique_event_group();
+    auto stream = cms::test::make_unique_stream_buffer(32, 1);
+    auto message = cms::test::make_unique_message_buffer(32);
+    auto task = cms::test::make_unique_task([](void*){}, "task", 128, nullptr, 1);
+
+    CHECK_EQUAL(freeBefore, xPortGetFreeHeapSize());
+    CHECK_EQUAL(allocationsBefore, cms::test::GetDynamicAllocationCount());
+
+    uint64_t created = 0;
+    for (const auto& entry : cms::test::GetFootprintReport().entries)
+    {
+        created += entry.count;
+    }
+    CHECK_EQUAL(10, created);
+}
+
+TEST(MemoryTests, owners_delete_their_objects_at_scope_exit)
+{
+    {
+        auto queue = cms::test::make_unique_queue(4, sizeof(uint32_t));
+        auto group = cms::test::make_unique_event_group();
+        auto task = cms::test::make_unique_task([](void*){}, "task", 128, nullptr, 1);
+        CHECK_TRUE(cms::test::GetFootprintReport().liveBytes != 0);
+    }
+    CHECK_EQUAL(0, cms::test::GetFootprintReport().liveBytes);
+
+    {
+        cms::test::unique_queue queue(xQueueCreate(4, sizeof(uint32_t)));
+        cms::test::unique_timer timer(xTimerCreate("timer", 10, pdFALSE, nullptr, TimerCallback));
+        cms::test::unique_event_group group(xEventGroupCreate());
+        cms::test::unique_stream_buffer stream(xStreamBufferCreate(32, 1));
+        CHECK_EQUAL(4, cms::test::GetLiveKernelObjects().size());
+    }
+    CHECK_EQUAL(0, cms::test::GetLiveKernelObjects().size());
+}
+
+TEST(MemoryTests, created_queue_is_functional_after_owner_is_moved)
+{
+    cms::test::unique_queue queue;
+    {
+        auto created = cms::test::make_unique_queue(2, sizeof(uint32_t));
+        queue = std::move(created);
+    }
+
+    uint32_t sent = 42;
+    CHECK_EQUAL(pdTRUE, xQueueSend(queue.get(), &sent, 0));
+    uint32_t received = 0;
+    CHECK_EQUAL(pdTRUE, xQueueReceive(queue.get(), &received, 0));
+    CHECK_EQUAL(sent, received);
+}
+
+TEST(MemoryTests, moved_from_owner_may_be_reset_to_a_dynamically_created_queue)
+{
+    auto created = cms::test::make_unique_queue(2, sizeof(uint32_t));
+    cms::test::unique_queue moved(std::move(created));
+    created.reset(xQueueCreate(1, sizeof(uint32_t)));
+
+    uint32_t sent = 7;
+    CHECK_EQUAL(pdTRUE, xQueueSend(moved.get(), &sent, 0));
+    CHECK_EQUAL(pdTRUE, xQueueSend(created.get(), &sent, 0));
+
+    //the static queue's buffers are freed once, with the queue
+    moved.reset(xQueueCreate(1, sizeof(uint32_t)));
+    CHECK_TRUE(moved.get_deleter().buffers == nullptr);
+    CHECK_TRUE(created.get_deleter().buffers == nullptr);
+}
+
+TEST(MemoryTests, released_queue_remains_valid_after_its_owner_is_gone)
+{
+    //e.g. ownership handed to C code, which deletes the queue itself
+    QueueHandle_t queue = cms::test::make_unique_queue(2, sizeof(uint32_t)).release();
+
+    uint32_t sent = 42;
+    CHECK_EQUAL(pdTRUE, xQueueSend(queue, &sent, 0));
+    uint32_t received = 0;
+    CHECK_EQUAL(pdTRUE, xQueueReceive(queue, &received, 0));
+    CHECK_EQUAL(sent, received);
+    vQueueDelete(queue);
+}
+
+TEST(MemoryTests, created_timer_is_functional)
+{
+    uint32_t count = 0;
+    auto timer = cms::test::make_unique_timer("timer", pdMS_TO_TICKS(10), pdFALSE, &count, TimerCallback);
+    xTimerStart(timer.get(), 0);
+    cms::test::MoveTimeForward(20ms);
+    CHECK_EQUAL(1, count);
+}
+
+TEST(MemoryTests, created_stream_and_message_buffers_are_functional)
+{
+    auto stream = cms::test::make_unique_stream_buffer(8, 1);
+    auto message = cms::test::make_unique_message_buffer(16);
+    CHECK_EQUAL(8, xStreamBufferSpacesAvailable(stream.get()));
+
+    const uint8_t data[] = {1, 2, 3};
+    CHECK_EQUAL(sizeof(data), xStreamBufferSend(stream.get(), data, sizeof(data), 0));
+    CHECK_EQUAL(sizeof(data), xMessageBufferSend(message.get(), data, sizeof(data), 0));
+    CHECK_EQUAL(sizeof(data), xMessageBufferNextLengthBytes(message.get()));
+}
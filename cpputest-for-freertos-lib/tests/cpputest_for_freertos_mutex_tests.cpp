@@ -24,7 +24,13 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "cpputest_for_freertos_mutex.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_assert.hpp"
+#include "cpputest_for_freertos_isr.hpp"
 #include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+#include "CppUTestExt/MockSupport.h"
 
 
 TEST_GROUP(MutexTests)
@@ -33,6 +39,8 @@ TEST_GROUP(MutexTests)
 
     void setup() final
     {
+        mMutexUnderTest = nullptr;
+        cms::test::TaskInit();
     }
 
     void teardown() final
@@ -42,6 +50,16 @@ TEST_GROUP(MutexTests)
             vSemaphoreDelete(mMutexUnderTest);
             mMutexUnderTest = nullptr;
         }
+        cms::test::TaskDestroy();
+        mock().clear();
+    }
+
+    static TaskHandle_t CreateTask(UBaseType_t priority)
+    {
+        TaskHandle_t task = nullptr;
+        xTaskCreate([](void*){}, "test", 100, nullptr, priority, &task);
+        CHECK_TRUE(task != nullptr);
+        return task;
     }
 
     void CreateMutex()
@@ -150,4 +168,486 @@ TEST(MutexTests, library_does_not_detect_locked_recursive_mutex_that_was_deleted
     mMutexUnderTest = nullptr;
     CHECK_FALSE(cms::test::IsAnyMutexLocked());
     cms::test::MutexTrackingTeardown();
-}
\ No newline at end of file
+}
+
+TEST(MutexTests, tracking_remains_consistent_when_mutexes_are_deleted_in_any_order)
+{
+    cms::test::MutexTrackingInit();
+    SemaphoreHandle_t mutexes[5];
+    for (auto& mutex : mutexes)
+    {
+        mutex = xSemaphoreCreateMutex();
+    }
+    CHECK_EQUAL(5, cms::test::GetTrackedMutexCount());
+
+    xSemaphoreTake(mutexes[1], 0);
+    xSemaphoreTake(mutexes[3], 0);
+    CHECK_TRUE(cms::test::IsAnyMutexLocked());
+
+    vSemaphoreDelete(mutexes[3]);
+    vSemaphoreDelete(mutexes[0]);
+    vSemaphoreDelete(mutexes[4]);
+    CHECK_EQUAL(2, cms::test::GetTrackedMutexCount());
+    CHECK_TRUE(cms::test::IsAnyMutexLocked());
+
+    vSemaphoreDelete(mutexes[1]);
+    CHECK_FALSE(cms::test::IsAnyMutexLocked());
+    vSemaphoreDelete(mutexes[2]);
+    CHECK_EQUAL(0, cms::test::GetTrackedMutexCount());
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, mutex_from_a_prior_tracking_session_is_not_tracked)
+{
+    cms::test::MutexTrackingInit();
+    CreateMutex();
+    cms::test::MutexTrackingTeardown();
+
+    cms::test::MutexTrackingInit();
+    CHECK_EQUAL(0, cms::test::GetTrackedMutexCount());
+    xSemaphoreTake(mMutexUnderTest, 0);
+    CHECK_FALSE(cms::test::IsAnyMutexLocked());
+    xSemaphoreGive(mMutexUnderTest);
+    vSemaphoreDelete(mMutexUnderTest);
+    mMutexUnderTest = nullptr;
+    CHECK_EQUAL(0, cms::test::GetTrackedMutexCount());
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, mutex_holder_is_tracked)
+{
+    auto task = CreateTask(tskIDLE_PRIORITY + 1);
+    cms::test::SetCurrentTask(task);
+    CreateMutex();
+    CHECK_TRUE(xSemaphoreGetMutexHolder(mMutexUnderTest) == nullptr);
+
+    xSemaphoreTake(mMutexUnderTest, 1000);
+    CHECK_TRUE(xSemaphoreGetMutexHolder(mMutexUnderTest) == task);
+
+    xSemaphoreGive(mMutexUnderTest);
+    CHECK_TRUE(xSemaphoreGetMutexHolder(mMutexUnderTest) == nullptr);
+}
+
+TEST(MutexTests, recursive_mutex_held_by_another_task_is_not_taken)
+{
+    auto holder = CreateTask(tskIDLE_PRIORITY + 1);
+    auto other = CreateTask(tskIDLE_PRIORITY + 1);
+    CreateRecursiveMutex();
+
+    cms::test::SetCurrentTask(holder);
+    CHECK_EQUAL(pdTRUE, xSemaphoreTakeRecursive(mMutexUnderTest, 1000));
+    CHECK_TRUE(xSemaphoreGetMutexHolder(mMutexUnderTest) == holder);
+
+    cms::test::SetCurrentTask(other);
+    CHECK_EQUAL(pdFALSE, xSemaphoreTakeRecursive(mMutexUnderTest, 1000));
+
+    cms::test::SetCurrentTask(holder);
+    CHECK_EQUAL(pdTRUE, xSemaphoreGiveRecursive(mMutexUnderTest));
+    CHECK_TRUE(xSemaphoreGetMutexHolder(mMutexUnderTest) == nullptr);
+}
+
+TEST(MutexTests, recursive_mutex_given_by_a_task_other_than_the_holder_asserts)
+{
+    auto holder = CreateTask(tskIDLE_PRIORITY + 1);
+    auto other = CreateTask(tskIDLE_PRIORITY + 1);
+    CreateRecursiveMutex();
+
+    cms::test::SetCurrentTask(holder);
+    xSemaphoreTakeRecursive(mMutexUnderTest, 1000);
+
+    cms::test::SetCurrentTask(other);
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    xSemaphoreGiveRecursive(mMutexUnderTest);
+    mock().checkExpectations();
+}
+
+TEST(MutexTests, recursive_mutex_given_from_isr_asserts)
+{
+    CreateRecursiveMutex();
+    xSemaphoreTakeRecursive(mMutexUnderTest, 1000);
+
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    cms::test::RunInIsrContext([this]()
+    {
+        xSemaphoreGiveRecursive(mMutexUnderTest);
+    });
+    mock().checkExpectations();
+}
+
+TEST(MutexTests, priority_inversion_is_detected_and_its_virtual_duration_reported)
+{
+    cms::test::MutexTrackingInit();
+    auto low = CreateTask(tskIDLE_PRIORITY + 1);
+    auto high = CreateTask(tskIDLE_PRIORITY + 3);
+    CreateMutex();
+
+    cms::test::SetCurrentTask(low);
+    xSemaphoreTake(mMutexUnderTest, portMAX_DELAY);
+
+    cms::test::SetCurrentTask(high);
+    CHECK_EQUAL(pdFALSE, xSemaphoreTake(mMutexUnderTest, portMAX_DELAY));
+
+    //as the kernel does, the holder inherits the waiter's priority
+    CHECK_EQUAL(tskIDLE_PRIORITY + 3, uxTaskPriorityGet(low));
+
+    cms::test::SetCurrentTask(low);
+    vTaskDelay(pdMS_TO_TICKS(7));
+    xSemaphoreGive(mMutexUnderTest);
+    CHECK_EQUAL(tskIDLE_PRIORITY + 1, uxTaskPriorityGet(low));
+
+    auto inversions = cms::test::GetPriorityInversions();
+    CHECK_EQUAL(1, inversions.size());
+    CHECK_TRUE(inversions[0].mutex == mMutexUnderTest);
+    CHECK_TRUE(inversions[0].holder == low);
+    CHECK_TRUE(inversions[0].waiter == high);
+    CHECK_EQUAL(tskIDLE_PRIORITY + 1, inversions[0].holderPriority);
+    CHECK_EQUAL(tskIDLE_PRIORITY + 3, inversions[0].waiterPriority);
+    CHECK_FALSE(inversions[0].isActive);
+    CHECK_TRUE(std::chrono::milliseconds(7) == inversions[0].duration);
+    CHECK_TRUE(std::chrono::milliseconds(7) == cms::test::GetMaxPriorityInversionDuration());
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, priority_inversion_duration_is_limited_by_the_waiters_timeout)
+{
+    cms::test::MutexTrackingInit();
+    auto low = CreateTask(tskIDLE_PRIORITY + 1);
+    auto high = CreateTask(tskIDLE_PRIORITY + 2);
+    CreateRecursiveMutex();
+
+    cms::test::SetCurrentTask(low);
+    xSemaphoreTakeRecursive(mMutexUnderTest, portMAX_DELAY);
+    cms::test::SetCurrentTask(high);
+    xSemaphoreTakeRecursive(mMutexUnderTest, pdMS_TO_TICKS(3));
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    auto inversions = cms::test::GetPriorityInversions();
+    CHECK_EQUAL(1, inversions.size());
+    CHECK_TRUE(inversions[0].isActive);
+    CHECK_TRUE(std::chrono::milliseconds(3) == inversions[0].duration);
+
+    cms::test::SetCurrentTask(low);
+    xSemaphoreGiveRecursive(mMutexUnderTest);
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, lower_or_equal_priority_waiter_or_zero_wait_is_not_a_priority_inversion)
+{
+    cms::test::MutexTrackingInit();
+    auto holder = CreateTask(tskIDLE_PRIORITY + 2);
+    auto equal = CreateTask(tskIDLE_PRIORITY + 2);
+    auto high = CreateTask(tskIDLE_PRIORITY + 3);
+    CreateMutex();
+
+    cms::test::SetCurrentTask(holder);
+    xSemaphoreTake(mMutexUnderTest, portMAX_DELAY);
+    cms::test::SetCurrentTask(equal);
+    xSemaphoreTake(mMutexUnderTest, portMAX_DELAY);
+    cms::test::SetCurrentTask(high);
+    xSemaphoreTake(mMutexUnderTest, 0);
+
+    CHECK_EQUAL(0, cms::test::GetPriorityInversions().size());
+
+    cms::test::SetCurrentTask(holder);
+    xSemaphoreGive(mMutexUnderTest);
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, profile_records_acquisitions_and_hold_time_per_registry_name)
+{
+    cms::test::MutexTrackingInit();
+    CreateMutex();
+    vQueueAddToRegistry(mMutexUnderTest, "profiled");
+
+    xSemaphoreTake(mMutexUnderTest, portMAX_DELAY);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    xSemaphoreGive(mMutexUnderTest);
+    xSemaphoreTake(mMutexUnderTest, portMAX_DELAY);
+    vTaskDelay(pdMS_TO_TICKS(2));
+    xSemaphoreGive(mMutexUnderTest);
+
+    auto profiles = cms::test::GetMutexProfile();
+    CHECK_EQUAL(1, profiles.size());
+    const auto& profile = profiles.at("profiled");
+    CHECK_EQUAL(2, profile.acquisitions);
+    CHECK_EQUAL(0, profile.failedTakes);
+    CHECK_EQUAL(1, profile.maxRecursiveDepth);
+    CHECK_EQUAL(pdMS_TO_TICKS(5), profile.maxHoldTicks);
+    CHECK_EQUAL(pdMS_TO_TICKS(7), profile.totalHoldTicks);
+    CHECK_TRUE(profile.totalHoldHostTime >= profile.maxHoldHostTime);
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, profile_counts_failed_takes)
+{
+    auto holder = CreateTask(1);
+    auto other = CreateTask(1);
+    cms::test::MutexTrackingInit();
+    CreateMutex();
+    vQueueAddToRegistry(mMutexUnderTest, "contended");
+
+    cms::test::SetCurrentTask(holder);
+    xSemaphoreTake(mMutexUnderTest, portMAX_DELAY);
+    cms::test::SetCurrentTask(other);
+    CHECK_EQUAL(pdFALSE, xSemaphoreTake(mMutexUnderTest, 0));
+    CHECK_EQUAL(pdFALSE, xSemaphoreTake(mMutexUnderTest, pdMS_TO_TICKS(10)));
+    cms::test::SetCurrentTask(holder);
+    xSemaphoreGive(mMutexUnderTest);
+
+    auto profile = cms::test::GetMutexProfile().at("contended");
+    CHECK_EQUAL(1, profile.acquisitions);
+    CHECK_EQUAL(2, profile.failedTakes);
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, profile_records_max_recursive_depth)
+{
+    cms::test::MutexTrackingInit();
+    CreateRecursiveMutex();
+    vQueueAddToRegistry(mMutexUnderTest, "recursive");
+
+    for (int i = 0; i < 3; ++i)
+    {
+        xSemaphoreTakeRecursive(mMutexUnderTest, portMAX_DELAY);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        xSemaphoreGiveRecursive(mMutexUnderTest);
+    }
+
+    auto profile = cms::test::GetMutexProfile().at("recursive");
+    CHECK_EQUAL(1, profile.acquisitions);
+    CHECK_EQUAL(3, profile.maxRecursiveDepth);
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, profile_records_recursive_depth_histogram)
+{
+    cms::test::MutexTrackingInit();
+    CreateRecursiveMutex();
+    vQueueAddToRegistry(mMutexUnderTest, "recursive");
+
+    //one flat acquisition, then one nested two deep
+    xSemaphoreTakeRecursive(mMutexUnderTest, portMAX_DELAY);
+    xSemaphoreGiveRecursive(mMutexUnderTest);
+    xSemaphoreTakeRecursive(mMutexUnderTest, portMAX_DELAY);
+    xSemaphoreTakeRecursive(mMutexUnderTest, portMAX_DELAY);
+    xSemaphoreGiveRecursive(mMutexUnderTest);
+    xSemaphoreGiveRecursive(mMutexUnderTest);
+
+    auto histogram = cms::test::GetMutexProfile().at("recursive").recursiveDepthHistogram;
+    CHECK_EQUAL(2, histogram.size());
+    CHECK_EQUAL(2, histogram.at(1));
+    CHECK_EQUAL(1, histogram.at(2));
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, profile_includes_deleted_and_currently_held_mutexes)
+{
+    cms::test::MutexTrackingInit();
+    for (int i = 0; i < 2; ++i)
+    {
+        auto mutex = xSemaphoreCreateMutex();
+        vQueueAddToRegistry(mutex, "shared");
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(3));
+        xSemaphoreGive(mutex);
+        vSemaphoreDelete(mutex);
+    }
+
+    CreateMutex();
+    vQueueAddToRegistry(mMutexUnderTest, "held");
+    xSemaphoreTake(mMutexUnderTest, portMAX_DELAY);
+    vTaskDelay(pdMS_TO_TICKS(4));
+
+    auto profiles = cms::test::GetMutexProfile();
+    CHECK_EQUAL(2, profiles.at("shared").acquisitions);
+    CHECK_EQUAL(pdMS_TO_TICKS(6), profiles.at("shared").totalHoldTicks);
+    CHECK_EQUAL(pdMS_TO_TICKS(4), profiles.at("held").maxHoldTicks);
+
+    xSemaphoreGive(mMutexUnderTest);
+    cms::test::MutexTrackingTeardown();
+}
+
+TEST(MutexTests, static_mutex_lives_in_callers_buffer_without_heap_use)
+{
+    StaticSemaphore_t buffer;
+    auto allocations = cms::test::GetDynamicAllocationCount();
+
+    cms::test::MutexTrackingInit();
+    mMutexUnderTest = xSemaphoreCreateMutexStatic(&buffer);
+    POINTERS_EQUAL(&buffer, mMutexUnderTest);
+    CHECK_EQUAL(1, uxSemaphoreGetCount(mMutexUnderTest));
+    CHECK_EQUAL(pdTRUE, xSemaphoreTake(mMutexUnderTest, 0));
+    CHECK_TRUE(cms::test::IsAnyMutexLocked());
+    CHECK_EQUAL(pdTRUE, xSemaphoreGive(mMutexUnderTest));
+    vSemaphoreDelete(mMutexUnderTest);
+    mMutexUnderTest = nullptr;
+    cms::test::MutexTrackingTeardown();
+
+    CHECK_EQUAL(allocations, cms::test::GetDynamicAllocationCount());
+}
+
+TEST(MutexTests, static_recursive_mutex_lives_in_callers_buffer_without_heap_use)
+{
+    StaticSemaphore_t buffer;
+    auto allocations = cms::test::GetDynamicAllocationCount();
+
+    mMutexUnderTest = xSemaphoreCreateRecursiveMutexStatic(&buffer);
+    POINTERS_EQUAL(&buffer, mMutexUnderTest);
+    CHECK_EQUAL(pdTRUE, xSemaphoreTakeRecursive(mMutexUnderTest, 0));
+    CHECK_EQUAL(pdTRUE, xSemaphoreTakeRecursive(mMutexUnderTest, 0));
+    CHECK_EQUAL(pdTRUE, xSemaphoreGiveRecursive(mMutexUnderTest));
+    CHECK_EQUAL(0, uxSemaphoreGetCount(mMutexUnderTest));
+    CHECK_EQUAL(pdTRUE, xSemaphoreGiveRecursive(mMutexUnderTest));
+    CHECK_EQUAL(1, uxSemaphoreGetCount(mMutexUnderTest));
+    vSemaphoreDelete(mMutexUnderTest);
+    mMutexUnderTest = nullptr;
+
+    CHECK_EQUAL(allocations, cms::test::GetDynamicAllocationCount());
+}
+
+static SemaphoreHandle_t s_mutexA = nullptr;
+static SemaphoreHandle_t s_mutexB = nullptr;
+static SemaphoreHandle_t s_mutexC = nullptr;
+
+static void TakeInOrder(SemaphoreHandle_t first, SemaphoreHandle_t second)
+{
+    xSemaphoreTake(first, portMAX_DELAY);
+    xSemaphoreTake(second, portMAX_DELAY);
+    xSemaphoreGive(second);
+    xSemaphoreGive(first);
+}
+
+static void TakeAThenBThenBThenA()
+{
+    TakeInOrder(s_mutexA, s_mutexB);
+    TakeInOrder(s_mutexB, s_mutexA);
+}
+
+static void TakeAThenBThenCThenA()
+{
+    TakeInOrder(s_mutexA, s_mutexB);
+    TakeInOrder(s_mutexB, s_mutexC);
+    TakeInOrder(s_mutexC, s_mutexA);
+}
+
+TEST_GROUP(MutexLockOrderTests)
+{
+    TestTestingFixture fixture;
+
+    void setup() final
+    {
+        cms::test::TaskInit();
+        cms::test::MutexTrackingInit();
+        s_mutexA = xSemaphoreCreateMutex();
+        s_mutexB = xSemaphoreCreateMutex();
+        s_mutexC = xSemaphoreCreateMutex();
+        vQueueAddToRegistry(s_mutexA, "A");
+        vQueueAddToRegistry(s_mutexB, "B");
+        vQueueAddToRegistry(s_mutexC, "C");
+    }
+
+    void teardown() final
+    {
+        for (auto mutex : {s_mutexA, s_mutexB, s_mutexC})
+        {
+            if (mutex != nullptr)
+            {
+                vSemaphoreDelete(mutex);
+            }
+        }
+        s_mutexA = s_mutexB = s_mutexC = nullptr;
+        cms::test::MutexTrackingTeardown();
+        cms::test::TaskDestroy();
+    }
+
+    static TaskHandle_t CreateTask()
+    {
+        TaskHandle_t task = nullptr;
+        xTaskCreate([](void*){}, "test", 100, nullptr, 1, &task);
+        CHECK_TRUE(task != nullptr);
+        return task;
+    }
+};
+
+TEST(MutexLockOrderTests, consistent_lock_order_is_not_a_violation)
+{
+    TakeInOrder(s_mutexA, s_mutexB);
+    TakeInOrder(s_mutexA, s_mutexB);
+    TakeInOrder(s_mutexB, s_mutexC);
+    TakeInOrder(s_mutexA, s_mutexC);
+    CHECK_TRUE(cms::test::GetLockOrderViolations().empty());
+}
+
+TEST(MutexLockOrderTests, lock_order_inversion_fails_the_test_immediately)
+{
+    fixture.setTestFunction(TakeAThenBThenBThenA);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    fixture.assertPrintContains("Potential deadlock: mutex A taken while holding mutex B");
+
+    auto violations = cms::test::GetLockOrderViolations();
+    CHECK_EQUAL(1, violations.size());
+    CHECK_TRUE(s_mutexA == violations[0].taken);
+    CHECK_TRUE(s_mutexB == violations[0].held);
+    CHECK_EQUAL(3, violations[0].cycle.size());
+
+    //the failed test left both mutexes locked
+    xSemaphoreGive(s_mutexA);
+    xSemaphoreGive(s_mutexB);
+}
+
+TEST(MutexLockOrderTests, lock_order_inversion_through_a_chain_of_mutexes_is_detected)
+{
+    fixture.setTestFunction(TakeAThenBThenCThenA);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    fixture.assertPrintContains("(A -> B -> C -> A)");
+
+    xSemaphoreGive(s_mutexA);
+    xSemaphoreGive(s_mutexC);
+}
+
+TEST(MutexLockOrderTests, lock_order_is_recorded_per_task)
+{
+    auto task1 = CreateTask();
+    auto task2 = CreateTask();
+
+    cms::test::SetCurrentTask(task1);
+    xSemaphoreTake(s_mutexA, portMAX_DELAY);
+    cms::test::SetCurrentTask(task2);
+    xSemaphoreTake(s_mutexB, portMAX_DELAY);
+    xSemaphoreGive(s_mutexB);
+    cms::test::SetCurrentTask(task1);
+    xSemaphoreGive(s_mutexA);
+
+    cms::test::SetCurrentTask(task2);
+    TakeInOrder(s_mutexB, s_mutexA);
+    CHECK_TRUE(cms::test::GetLockOrderViolations().empty());
+}
+
+TEST(MutexLockOrderTests, recursive_mutexes_participate_in_lock_order)
+{
+    auto recursive = xSemaphoreCreateRecursiveMutex();
+    xSemaphoreTakeRecursive(recursive, portMAX_DELAY);
+    xSemaphoreTakeRecursive(recursive, portMAX_DELAY);
+    TakeInOrder(s_mutexA, s_mutexB);
+    xSemaphoreGiveRecursive(recursive);
+    xSemaphoreGiveRecursive(recursive);
+
+    CHECK_TRUE(cms::test::GetLockOrderViolations().empty());
+    vSemaphoreDelete(recursive);
+}
+
+TEST(MutexLockOrderTests, deleted_mutex_lock_order_is_forgotten)
+{
+    TakeInOrder(s_mutexA, s_mutexB);
+    vSemaphoreDelete(s_mutexB);
+    s_mutexB = xSemaphoreCreateMutex();
+
+    TakeInOrder(s_mutexB, s_mutexA);
+    CHECK_TRUE(cms::test::GetLockOrderViolations().empty());
+}
@@ -195,6 +195,19 @@ TEST(QueueTests, can_use_queue_overwrite)
     CHECK_EQUAL(overwriteEvent.valueB, retrieved.valueB);
 }
 
+TEST(QueueTests, queue_overwrite_on_empty_queue_adds_the_item)
+{
+    const TestEventT overwriteEvent = { 123, 143 };
+
+    CreateUnderTest(1, sizeof(TestEventT));
+    CHECK_EQUAL(pdPASS, xQueueOverwrite(mQueueUnderTest, &overwriteEvent));
+    CHECK_EQUAL(1, uxQueueMessagesWaiting(mQueueUnderTest));
+
+    TestEventT retrieved= { 0, 0 };
+    CHECK_EQUAL(pdTRUE, xQueueReceive(mQueueUnderTest, &retrieved, portMAX_DELAY));
+    CHECK_EQUAL(overwriteEvent.valueA, retrieved.valueA);
+}
+
 TEST(QueueTests, can_add_queue_to_registry)
 {
     static const char * TEST_QUEUE_NAME = "This is a test";
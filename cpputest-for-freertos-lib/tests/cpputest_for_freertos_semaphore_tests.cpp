@@ -23,6 +23,7 @@
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "cpputest_for_freertos_memory.hpp"
 #include "CppUTest/TestHarness.h"
 
 TEST_GROUP(SemaphoreTests)
@@ -143,3 +144,54 @@ TEST(SemaphoreTests, counting_semaphore_give_take_match)
     CHECK_EQUAL(pdTRUE, xSemaphoreTake(mSemaUnderTest, 1000));
     CHECK_EQUAL(pdFALSE, xSemaphoreTake(mSemaUnderTest, 1000));
 }
+
+TEST(SemaphoreTests, counting_semaphore_created_full_at_max_count_rejects_give)
+{
+    const UBaseType_t maxCount = static_cast<UBaseType_t>(~0U);
+    CreateCountingSemaphore(maxCount, maxCount);
+    CHECK_EQUAL(maxCount, uxSemaphoreGetCount(mSemaUnderTest));
+    CHECK_EQUAL(pdFALSE, xSemaphoreGive(mSemaUnderTest));
+    CHECK_EQUAL(pdTRUE, xSemaphoreTake(mSemaUnderTest, 0));
+    CHECK_EQUAL(maxCount - 1, uxSemaphoreGetCount(mSemaUnderTest));
+}
+
+TEST(SemaphoreTests, static_binary_semaphore_lives_in_callers_buffer_without_heap_use)
+{
+    StaticSemaphore_t buffer;
+    auto allocations = cms::test::GetDynamicAllocationCount();
+
+    mSemaUnderTest = xSemaphoreCreateBinaryStatic(&buffer);
+    POINTERS_EQUAL(&buffer, mSemaUnderTest);
+    CHECK_EQUAL(0, uxSemaphoreGetCount(mSemaUnderTest));
+    CHECK_EQUAL(pdTRUE, xSemaphoreGive(mSemaUnderTest));
+    CHECK_EQUAL(pdFALSE, xSemaphoreGive(mSemaUnderTest));
+    CHECK_EQUAL(pdTRUE, xSemaphoreTake(mSemaUnderTest, 0));
+    vSemaphoreDelete(mSemaUnderTest);
+    mSemaUnderTest = nullptr;
+
+    CHECK_EQUAL(allocations, cms::test::GetDynamicAllocationCount());
+}
+
+TEST(SemaphoreTests, static_counting_semaphore_lives_in_callers_buffer_without_heap_use)
+{
+    StaticSemaphore_t buffer;
+    auto allocations = cms::test::GetDynamicAllocationCount();
+
+    mSemaUnderTest = xSemaphoreCreateCountingStatic(3, 2, &buffer);
+    POINTERS_EQUAL(&buffer, mSemaUnderTest);
+    CHECK_EQUAL(2, uxSemaphoreGetCount(mSemaUnderTest));
+    CHECK_EQUAL(pdTRUE, xSemaphoreGive(mSemaUnderTest));
+    CHECK_EQUAL(pdFALSE, xSemaphoreGive(mSemaUnderTest));
+    CHECK_EQUAL(3, uxSemaphoreGetCount(mSemaUnderTest));
+    vSemaphoreDelete(mSemaUnderTest);
+    mSemaUnderTest = nullptr;
+
+    CHECK_EQUAL(allocations, cms::test::GetDynamicAllocationCount());
+}
+
+TEST(SemaphoreTests, dynamic_semaphore_creation_is_counted_as_heap_use)
+{
+    auto allocations = cms::test::GetDynamicAllocationCount();
+    CreateBinarySemaphore();
+    CHECK_EQUAL(allocations + 1, cms::test::GetDynamicAllocationCount());
+}
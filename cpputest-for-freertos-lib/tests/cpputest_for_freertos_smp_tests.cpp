@@ -0,0 +1,234 @@
+/// @brief Tests of CppUTest for FreeRTOS task tracking and multi-core (SMP) simulation.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cpputest_for_freertos_smp.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_critical_section.hpp"
+#include "cpputest_for_freertos_assert.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+#include "CppUTestExt/MockSupport.h"
+
+static void TaskCode(void * parameters)
+{
+    (void)parameters;
+    //for testing, does nothing
+}
+
+TEST_GROUP(SmpTests)
+{
+    TestTestingFixture fixture;
+
+    void setup() final
+    {
+        cms::test::SmpInit();
+        cms::test::TaskInit();
+        cms::test::CriticalSectionTrackingInit();
+    }
+
+    void teardown() final
+    {
+        cms::test::CriticalSectionTrackingTeardown();
+        cms::test::TaskDestroy();
+        cms::test::SmpTeardown();
+        mock().clear();
+    }
+
+    TaskHandle_t CreateTask()
+    {
+        TaskHandle_t task = nullptr;
+        auto ok = xTaskCreate(TaskCode, "test", 100, nullptr, tskIDLE_PRIORITY + 1, &task);
+        CHECK_EQUAL(pdPASS, ok);
+        CHECK_TRUE(task != nullptr);
+        return task;
+    }
+};
+
+TEST(SmpTests, code_under_test_executes_outside_of_a_task_by_default)
+{
+    CHECK_EQUAL(0, cms::test::GetCurrentCore());
+    CHECK_TRUE(xTaskGetCurrentTaskHandle() == nullptr);
+}
+
+TEST(SmpTests, task_create_provides_unique_handles)
+{
+    auto task1 = CreateTask();
+    auto task2 = CreateTask();
+    CHECK_TRUE(task1 != task2);
+    vTaskDelete(task1);
+    vTaskDelete(task2);
+}
+
+TEST(SmpTests, current_task_is_selected_by_the_unit_test)
+{
+    auto task = CreateTask();
+    cms::test::SetCurrentTask(task);
+    CHECK_TRUE(xTaskGetCurrentTaskHandle() == task);
+    CHECK_TRUE(xTaskGetCurrentTaskHandleForCore(0) == task);
+
+    //delete self
+    vTaskDelete(nullptr);
+    CHECK_TRUE(xTaskGetCurrentTaskHandle() == nullptr);
+}
+
+TEST(SmpTests, task_run_time_is_accounted_in_virtual_time)
+{
+    auto task1 = CreateTask();
+    auto task2 = CreateTask();
+
+    cms::test::SetCurrentTask(task1);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    cms::test::SetCurrentTask(task2);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    cms::test::SetCurrentTask(nullptr);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    CHECK_TRUE(std::chrono::milliseconds(10) == cms::test::GetTaskRunTime(task1));
+    CHECK_TRUE(std::chrono::milliseconds(5) == cms::test::GetTaskRunTime(task2));
+    CHECK_TRUE(std::chrono::milliseconds(15) == cms::test::GetCoreRunTime(0));
+}
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+TEST(SmpTests, current_task_is_tracked_per_core)
+{
+    auto task1 = CreateTask();
+    auto task2 = CreateTask();
+
+    cms::test::SetCurrentTask(task1);
+    cms::test::SetCurrentCore(1);
+    CHECK_EQUAL(1, portGET_CORE_ID());
+    cms::test::SetCurrentTask(task2);
+
+    CHECK_TRUE(xTaskGetCurrentTaskHandle() == task2);
+    CHECK_TRUE(xTaskGetCurrentTaskHandleForCore(0) == task1);
+    CHECK_TRUE(xTaskGetCurrentTaskHandleForCore(1) == task2);
+}
+
+TEST(SmpTests, core_affinity_is_recorded)
+{
+    TaskHandle_t task = nullptr;
+    auto ok = xTaskCreateAffinitySet(TaskCode, "pinned", 100, nullptr, tskIDLE_PRIORITY + 1,
+                                     (1 << 1), &task);
+    CHECK_EQUAL(pdPASS, ok);
+    CHECK_EQUAL((1 << 1), vTaskCoreAffinityGet(task));
+
+    vTaskCoreAffinitySet(task, (1 << 0));
+    CHECK_EQUAL((1 << 0), vTaskCoreAffinityGet(task));
+}
+
+TEST(SmpTests, changing_affinity_of_a_running_task_requests_its_core_to_yield)
+{
+    auto task = CreateTask();
+    cms::test::SetCurrentCore(1);
+    cms::test::SetCurrentTask(task);
+    cms::test::SetCurrentCore(0);
+
+    vTaskCoreAffinitySet(task, (1 << 0));
+    CHECK_EQUAL(1, cms::test::GetYieldCoreCount(1));
+    CHECK_EQUAL(0, cms::test::GetYieldCoreCount(0));
+}
+
+TEST(SmpTests, running_a_task_on_a_core_outside_its_affinity_asserts)
+{
+    TaskHandle_t task = nullptr;
+    xTaskCreateAffinitySet(TaskCode, "pinned", 100, nullptr, tskIDLE_PRIORITY + 1, (1 << 0), &task);
+    cms::test::SetCurrentCore(1);
+
+    cms::test::AssertOutputDisable();
+    cms::test::MockExpectAssert();
+    cms::test::SetCurrentTask(task);
+    mock().checkExpectations();
+}
+
+TEST(SmpTests, core_run_time_reflects_load_balance)
+{
+    auto task1 = CreateTask();
+    auto task2 = CreateTask();
+
+    cms::test::SetCurrentTask(task1);
+    cms::test::SetCurrentCore(1);
+    cms::test::SetCurrentTask(task2);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    cms::test::SetCurrentCore(0);
+    cms::test::SetCurrentTask(nullptr);
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    CHECK_TRUE(std::chrono::milliseconds(10) == cms::test::GetCoreRunTime(0));
+    CHECK_TRUE(std::chrono::milliseconds(20) == cms::test::GetCoreRunTime(1));
+}
+
+TEST(SmpTests, critical_sections_take_the_task_and_isr_locks)
+{
+    taskENTER_CRITICAL();
+    CHECK_TRUE(cms::test::IsSmpLockHeld(cms::test::SmpLock::Task, 0));
+    CHECK_TRUE(cms::test::IsSmpLockHeld(cms::test::SmpLock::Isr, 0));
+    taskEXIT_CRITICAL();
+    CHECK_FALSE(cms::test::IsSmpLockHeld(cms::test::SmpLock::Task, 0));
+    CHECK_FALSE(cms::test::IsSmpLockHeld(cms::test::SmpLock::Isr, 0));
+    CHECK_EQUAL(1, cms::test::GetSmpLockStats(cms::test::SmpLock::Task).acquisitions);
+    CHECK_EQUAL(0, cms::test::GetSmpLockStats(cms::test::SmpLock::Task).contentions);
+}
+
+TEST(SmpTests, critical_section_nesting_is_per_core)
+{
+    taskENTER_CRITICAL();
+    cms::test::SetCurrentCore(1);
+    CHECK_EQUAL(0, cms::test::GetCriticalNesting());
+    CHECK_FALSE(cms::test::AreInterruptsDisabled());
+    cms::test::SetCurrentCore(0);
+    CHECK_EQUAL(1, cms::test::GetCriticalNesting());
+    taskEXIT_CRITICAL();
+}
+
+TEST(SmpTests, lock_contention_between_cores_is_counted)
+{
+    taskENTER_CRITICAL();
+    cms::test::SetCurrentCore(1);
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+    vTaskSuspendAll();
+    xTaskResumeAll();
+    cms::test::SetCurrentCore(0);
+    taskEXIT_CRITICAL();
+
+    CHECK_EQUAL(1, cms::test::GetSmpLockStats(cms::test::SmpLock::Isr).contentions);
+    CHECK_EQUAL(1, cms::test::GetSmpLockStats(cms::test::SmpLock::Task).contentions);
+}
+
+static void ReleaseUnheldLock()
+{
+    cms::test::SmpInit();
+    portRELEASE_TASK_LOCK();
+    cms::test::SmpTeardown();
+}
+
+TEST(SmpTests, teardown_fails_test_if_a_lock_was_released_without_being_held)
+{
+    fixture.setTestFunction(ReleaseUnheldLock);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+}
+
+#endif /* if ( configNUMBER_OF_CORES > 1 ) */
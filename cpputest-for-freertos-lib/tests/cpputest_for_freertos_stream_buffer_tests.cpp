@@ -0,0 +1,261 @@
+/// @brief Tests of CppUTest for FreeRTOS stream buffers and message buffers.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <array>
+#include <cstring>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+#include "cpputest_for_freertos_stream_buffer.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_memory.hpp"
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(StreamBufferTests)
+{
+    StreamBufferHandle_t mUnderTest = nullptr;
+
+    void setup() final
+    {
+        cms::test::TaskInit();
+        cms::test::IsrInit();
+    }
+
+    void teardown() final
+    {
+        if (mUnderTest != nullptr)
+        {
+            vStreamBufferDelete(mUnderTest);
+            mUnderTest = nullptr;
+        }
+        cms::test::IsrTeardown();
+        cms::test::TaskDestroy();
+    }
+
+    void CreateStreamBuffer(size_t size, size_t trigger = 1)
+    {
+        mUnderTest = xStreamBufferCreate(size, trigger);
+        CHECK_TRUE(mUnderTest != nullptr);
+    }
+
+    void CreateMessageBuffer(size_t size)
+    {
+        mUnderTest = xMessageBufferCreate(size);
+        CHECK_TRUE(mUnderTest != nullptr);
+    }
+};
+
+TEST(StreamBufferTests, new_stream_buffer_is_empty)
+{
+    CreateStreamBuffer(8);
+    CHECK_EQUAL(pdTRUE, xStreamBufferIsEmpty(mUnderTest));
+    CHECK_EQUAL(pdFALSE, xStreamBufferIsFull(mUnderTest));
+    CHECK_EQUAL(8, xStreamBufferSpacesAvailable(mUnderTest));
+    CHECK_EQUAL(0, xStreamBufferBytesAvailable(mUnderTest));
+}
+
+TEST(StreamBufferTests, bytes_are_received_in_the_order_sent)
+{
+    CreateStreamBuffer(8);
+    const char tx[] = "abcde";
+    CHECK_EQUAL(5, xStreamBufferSend(mUnderTest, tx, 5, 0));
+    CHECK_EQUAL(5, xStreamBufferBytesAvailable(mUnderTest));
+
+    char rx[8] = {};
+    CHECK_EQUAL(3, xStreamBufferReceive(mUnderTest, rx, 3, 0));
+    STRNCMP_EQUAL("abc", rx, 3);
+    CHECK_EQUAL(2, xStreamBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+    STRNCMP_EQUAL("de", rx, 2);
+    CHECK_EQUAL(0, xStreamBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+}
+
+TEST(StreamBufferTests, send_to_a_nearly_full_stream_buffer_writes_what_fits)
+{
+    CreateStreamBuffer(4);
+    CHECK_EQUAL(4, xStreamBufferSend(mUnderTest, "abcdef", 6, 0));
+    CHECK_EQUAL(pdTRUE, xStreamBufferIsFull(mUnderTest));
+    CHECK_EQUAL(0, xStreamBufferSend(mUnderTest, "g", 1, 0));
+    CHECK_EQUAL(3, cms::test::GetStreamBufferStats(mUnderTest).bytesDropped);
+}
+
+TEST(StreamBufferTests, contents_are_inspected_without_copying_across_the_ring_wrap)
+{
+    CreateStreamBuffer(6);
+    char rx[6];
+    xStreamBufferSend(mUnderTest, "abcd", 4, 0);
+    xStreamBufferReceive(mUnderTest, rx, 3, 0);
+    xStreamBufferSend(mUnderTest, "efgh", 4, 0);
+
+    auto contents = cms::test::GetStreamBufferContents(mUnderTest);
+    CHECK_EQUAL(5, contents.size());
+    CHECK_EQUAL(3, contents.firstLength);
+    CHECK_EQUAL(2, contents.secondLength);
+    const char expected[] = "defgh";
+    for (size_t i = 0; i < contents.size(); ++i)
+    {
+        CHECK_EQUAL(expected[i], contents[i]);
+    }
+
+    //inspection does not consume
+    CHECK_EQUAL(5, xStreamBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+    STRNCMP_EQUAL("defgh", rx, 5);
+}
+
+TEST(StreamBufferTests, send_from_isr_wakes_the_receiver_only_once_the_trigger_level_is_reached)
+{
+    CreateStreamBuffer(16, 4);
+    BaseType_t woken = pdFALSE;
+    cms::test::RunInIsrContext([&]()
+    {
+        CHECK_EQUAL(3, xStreamBufferSendFromISR(mUnderTest, "abc", 3, &woken));
+    });
+    CHECK_EQUAL(pdFALSE, woken);
+
+    cms::test::RunInIsrContext([&]()
+    {
+        CHECK_EQUAL(1, xStreamBufferSendFromISR(mUnderTest, "d", 1, &woken));
+        portYIELD_FROM_ISR(woken);
+    });
+    CHECK_EQUAL(pdTRUE, woken);
+
+    char rx[16];
+    CHECK_EQUAL(4, xStreamBufferReceive(mUnderTest, rx, sizeof(rx), portMAX_DELAY));
+    CHECK_EQUAL(1, cms::test::GetIsrLatencies().size());
+}
+
+TEST(StreamBufferTests, trigger_level_can_be_changed_within_the_buffer_size)
+{
+    CreateStreamBuffer(8);
+    CHECK_EQUAL(pdTRUE, xStreamBufferSetTriggerLevel(mUnderTest, 8));
+    CHECK_EQUAL(pdFALSE, xStreamBufferSetTriggerLevel(mUnderTest, 9));
+}
+
+TEST(StreamBufferTests, batching_buffer_holds_bytes_until_the_trigger_level)
+{
+    mUnderTest = xStreamBatchingBufferCreate(8, 3);
+    char rx[8];
+    xStreamBufferSend(mUnderTest, "ab", 2, 0);
+    CHECK_EQUAL(0, xStreamBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+    xStreamBufferSend(mUnderTest, "c", 1, 0);
+    CHECK_EQUAL(3, xStreamBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+}
+
+TEST(StreamBufferTests, reset_empties_the_buffer)
+{
+    CreateStreamBuffer(8);
+    xStreamBufferSend(mUnderTest, "abc", 3, 0);
+    CHECK_EQUAL(pdPASS, xStreamBufferReset(mUnderTest));
+    CHECK_EQUAL(pdTRUE, xStreamBufferIsEmpty(mUnderTest));
+}
+
+TEST(StreamBufferTests, message_buffer_receives_whole_messages_with_a_length_prefix)
+{
+    CreateMessageBuffer(32);
+    CHECK_EQUAL(3, xMessageBufferSend(mUnderTest, "abc", 3, 0));
+    CHECK_EQUAL(5, xMessageBufferSend(mUnderTest, "defgh", 5, 0));
+    CHECK_EQUAL(8 + (2 * sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)),
+                xStreamBufferBytesAvailable(mUnderTest));
+    CHECK_EQUAL(3, xMessageBufferNextLengthBytes(mUnderTest));
+
+    char rx[8] = {};
+    CHECK_EQUAL(3, xMessageBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+    STRNCMP_EQUAL("abc", rx, 3);
+    CHECK_EQUAL(5, xMessageBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+    STRNCMP_EQUAL("defgh", rx, 5);
+    CHECK_EQUAL(pdTRUE, xMessageBufferIsEmpty(mUnderTest));
+}
+
+TEST(StreamBufferTests, message_buffer_send_is_all_or_nothing)
+{
+    const size_t size = sizeof(configMESSAGE_BUFFER_LENGTH_TYPE) + 4;
+    CreateMessageBuffer(size);
+    CHECK_EQUAL(0, xMessageBufferSend(mUnderTest, "abcde", 5, 0));
+    CHECK_EQUAL(pdTRUE, xMessageBufferIsEmpty(mUnderTest));
+    CHECK_EQUAL(4, xMessageBufferSend(mUnderTest, "abcd", 4, 0));
+    CHECK_EQUAL(pdTRUE, xMessageBufferIsFull(mUnderTest));
+}
+
+TEST(StreamBufferTests, message_too_large_for_the_receive_buffer_is_left_in_place)
+{
+    CreateMessageBuffer(32);
+    xMessageBufferSend(mUnderTest, "abcdef", 6, 0);
+
+    char rx[4];
+    CHECK_EQUAL(0, xMessageBufferReceive(mUnderTest, rx, sizeof(rx), 0));
+    CHECK_EQUAL(6, xMessageBufferNextLengthBytes(mUnderTest));
+}
+
+TEST(StreamBufferTests, stats_report_throughput)
+{
+    CreateStreamBuffer(8);
+    char rx[8];
+    xStreamBufferSend(mUnderTest, "abcdef", 6, 0);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    xStreamBufferReceive(mUnderTest, rx, 4, 0);
+    xStreamBufferSend(mUnderTest, "ghijkl", 6, 0);
+
+    auto stats = cms::test::GetStreamBufferStats(mUnderTest);
+    CHECK_EQUAL(2, stats.sends);
+    CHECK_EQUAL(12, stats.bytesSent);
+    CHECK_EQUAL(0, stats.bytesDropped);
+    CHECK_EQUAL(1, stats.receives);
+    CHECK_EQUAL(4, stats.bytesReceived);
+    CHECK_EQUAL(8, stats.maxBytesBuffered);
+    CHECK_TRUE(std::chrono::milliseconds(10) == stats.elapsed);
+}
+
+TEST(StreamBufferTests, static_stream_buffer_uses_callers_buffers_without_heap_use)
+{
+    StaticStreamBuffer_t control;
+    std::array<uint8_t, 8> storage {};
+    uint8_t * retrievedStorage = nullptr;
+    StaticStreamBuffer_t * retrievedControl = nullptr;
+    auto allocations = cms::test::GetDynamicAllocationCount();
+
+    auto buffer = xStreamBufferCreateStatic(storage.size(), 1, storage.data(), &control);
+    POINTERS_EQUAL(&control, buffer);
+    CHECK_EQUAL(pdTRUE, xStreamBufferGetStaticBuffers(buffer, &retrievedStorage, &retrievedControl));
+    POINTERS_EQUAL(storage.data(), retrievedStorage);
+    POINTERS_EQUAL(&control, retrievedControl);
+
+    xStreamBufferSend(buffer, "xyz", 3, 0);
+    CHECK_EQUAL('x', storage[0]);
+    vStreamBufferDelete(buffer);
+
+    CHECK_EQUAL(allocations, cms::test::GetDynamicAllocationCount());
+}
+
+TEST(StreamBufferTests, static_stream_buffer_holds_one_byte_less_than_its_storage)
+{
+    //i.e. the kernel's N + 1 byte storage for an N byte buffer
+    StaticStreamBuffer_t control;
+    std::array<uint8_t, 9> storage {};
+    const uint8_t data[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    auto buffer = xStreamBufferCreateStatic(storage.size(), 1, storage.data(), &control);
+    CHECK_EQUAL(8, xStreamBufferSpacesAvailable(buffer));
+    CHECK_EQUAL(8, xStreamBufferSend(buffer, data, sizeof(data), 0));
+    CHECK_EQUAL(pdTRUE, xStreamBufferIsFull(buffer));
+    vStreamBufferDelete(buffer);
+}
@@ -20,6 +20,10 @@
 ///   info@covemountainsoftware.com
 ///***************************************************************************
 /// @endcond
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include "FreeRTOS.h"
 #include "task.h"
 #include "cpputest_for_freertos_timers.hpp"
@@ -116,4 +120,69 @@ TEST(TaskTests, task_create_static_is_available)
             &staticTaskBuffer );  /* Variable to hold the task's data structure. */
 
     CHECK_TRUE(taskHandle != nullptr);
-}
\ No newline at end of file
+}
+
+TEST(TaskTests, task_create_static_uses_the_callers_buffer_without_a_limit)
+{
+    //i.e. more than the fake's pool of dynamically created tasks
+    static std::array<StaticTask_t, 64> staticTaskBuffers;
+    static std::array<StackType_t, 16> staticStack;
+
+    for (auto& buffer : staticTaskBuffers)
+    {
+        auto taskHandle = xTaskCreateStatic(staticTaskCode, "TEST", staticStack.size(), nullptr,
+                                            tskIDLE_PRIORITY, staticStack.data(), &buffer);
+        CHECK_TRUE(taskHandle == reinterpret_cast<TaskHandle_t>(&buffer));
+    }
+}
+
+TEST(TaskTests, kernel_state_is_independent_per_thread)
+{
+    vTaskDelay(100);
+
+    //CppUTest's leak detecting new/delete is process wide and not thread safe,
+    //so it is disabled while the workers run
+    MemoryLeakWarningPlugin::saveAndDisableNewDeleteOverloads();
+
+    std::array<TickType_t, 4> workerTicks = {};
+    {
+        std::atomic<size_t> started(0);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < workerTicks.size(); ++i)
+        {
+            workers.emplace_back([i, &workerTicks, &started]()
+            {
+                cms::test::TaskInit();
+                cms::test::TimersInit();
+
+                //every worker's kernel is alive before any of them moves time
+                started++;
+                while (started < workerTicks.size())
+                {
+                    std::this_thread::yield();
+                }
+
+                for (size_t step = 0; step < 1000; ++step)
+                {
+                    vTaskDelay(static_cast<TickType_t>(i + 1));
+                }
+                workerTicks[i] = xTaskGetTickCount();
+                cms::test::TimersDestroy();
+                cms::test::TaskDestroy();
+            });
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    MemoryLeakWarningPlugin::restoreNewDeleteOverloads();
+
+    for (size_t i = 0; i < workerTicks.size(); ++i)
+    {
+        CHECK_EQUAL((i + 1) * 1000, workerTicks[i]);
+    }
+    CHECK_EQUAL(100, xTaskGetTickCount());
+}
@@ -0,0 +1,115 @@
+/// @brief Tests of CppUTest for FreeRTOS virtual time and wall clock budgets.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cpputest_for_freertos_time_budget.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+
+using namespace std::chrono_literals;
+
+TEST_GROUP(TimeBudgetTests)
+{
+    TestTestingFixture fixture;
+
+    void setup() final
+    {
+        cms::test::TaskInit();
+    }
+
+    void teardown() final
+    {
+        cms::test::TaskDestroy();
+    }
+};
+
+TEST(TimeBudgetTests, virtual_budget_tracks_task_delay_without_timers)
+{
+    cms::test::VirtualTimeBudget budget(pdMS_TO_TICKS(50));
+    vTaskDelay(pdMS_TO_TICKS(20));
+    CHECK_EQUAL(pdMS_TO_TICKS(20), budget.ElapsedTicks());
+    CHECK_FALSE(budget.IsExceeded());
+}
+
+TEST(TimeBudgetTests, virtual_budget_tracks_timers_time_when_timers_are_active)
+{
+    cms::test::TimersInit();
+    {
+        cms::test::VirtualTimeBudget budget(pdMS_TO_TICKS(5));
+        cms::test::MoveTimeForward(5ms);
+        CHECK_TRUE(budget.Elapsed() == 5ms);
+        CHECK_EQUAL(pdMS_TO_TICKS(5), budget.ElapsedTicks());
+        CHECK_FALSE(budget.IsExceeded());
+    }
+    cms::test::TimersDestroy();
+}
+
+static void VirtualBudgetExceededAtScopeExit()
+{
+    cms::test::VirtualTimeBudget budget(pdMS_TO_TICKS(10));
+    vTaskDelay(pdMS_TO_TICKS(11));
+}
+
+TEST(TimeBudgetTests, virtual_budget_fails_test_at_scope_exit_when_exceeded)
+{
+    fixture.setTestFunction(VirtualBudgetExceededAtScopeExit);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+}
+
+static void VirtualBudgetNotExceededAtScopeExit()
+{
+    cms::test::VirtualTimeBudget budget(pdMS_TO_TICKS(10));
+    TickType_t lastWake = xTaskGetTickCount();
+    xTaskDelayUntil(&lastWake, pdMS_TO_TICKS(10));
+}
+
+TEST(TimeBudgetTests, virtual_budget_does_not_fail_test_when_budget_is_met_exactly)
+{
+    fixture.setTestFunction(VirtualBudgetNotExceededAtScopeExit);
+    fixture.runAllTests();
+    CHECK_EQUAL(0, fixture.getFailureCount());
+}
+
+static void WallClockBudgetExceededAtScopeExit()
+{
+    cms::test::WallClockBudget budget(0ns);
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() == start) {}
+}
+
+TEST(TimeBudgetTests, wall_clock_budget_fails_test_at_scope_exit_when_exceeded)
+{
+    fixture.setTestFunction(WallClockBudgetExceededAtScopeExit);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+}
+
+TEST(TimeBudgetTests, wall_clock_budget_is_not_affected_by_virtual_time)
+{
+    cms::test::WallClockBudget budget(10s);
+    vTaskDelay(pdMS_TO_TICKS(60000));
+    CHECK_FALSE(budget.IsExceeded());
+}
@@ -0,0 +1,178 @@
+/// @brief Tests of the opt-in Chrome Trace Event/Perfetto timeline.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "cpputest_for_freertos_timeline.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "CppUTest/TestHarness.h"
+
+using namespace std::chrono_literals;
+
+//unique per test and process, as the CTest shards may run at the same time
+static std::string s_timelineFile;
+
+TEST_GROUP(TimelineTests)
+{
+    void setup() final
+    {
+        cms::test::HeapInit();
+        cms::test::TaskInit();
+        cms::test::TimersInit();
+        cms::test::IsrInit();
+        cms::test::TimelineInit();
+
+        auto shell = UtestShell::getCurrent();
+        s_timelineFile = std::string(shell->getGroup().asCharString()) + "_" + shell->getName().asCharString() +
+                         "_" + std::to_string(getpid()) + ".json";
+    }
+
+    void teardown() final
+    {
+        cms::test::TimelineTeardown();
+        cms::test::IsrTeardown();
+        cms::test::TimersDestroy();
+        cms::test::TaskDestroy();
+        cms::test::HeapTeardown();
+        remove(s_timelineFile.c_str());
+    }
+
+    static void CheckContains(const std::string & json, const char * expected)
+    {
+        if (json.find(expected) == std::string::npos)
+        {
+            FAIL_TEST((std::string("timeline lacks ") + expected + " in:\n" + json).c_str());
+        }
+    }
+};
+
+TEST(TimelineTests, queue_occupancy_is_a_counter_track)
+{
+    auto queue = xQueueCreate(2, sizeof(uint8_t));
+    vQueueAddToRegistry(queue, "events");
+    uint8_t value = 1;
+    xQueueSend(queue, &value, 0);
+    vTaskDelay(pdMS_TO_TICKS(1));
+    xQueueSend(queue, &value, 0);
+    xQueueReceive(queue, &value, 0);
+
+    auto json = cms::test::GetTimelineJson();
+    CheckContains(json, R"({"name":"queue events","ph":"C","pid":1,"tid":2,"ts":0.000,"args":{"messages":1}})");
+    CheckContains(json, R"({"name":"queue events","ph":"C","pid":1,"tid":2,"ts":1000.000,"args":{"messages":2}})");
+    CheckContains(json, R"({"name":"queue events","ph":"C","pid":1,"tid":2,"ts":1000.000,"args":{"messages":1}})");
+    vQueueDelete(queue);
+}
+
+TEST(TimelineTests, timer_fires_are_instants_on_the_timers_track)
+{
+    auto timer = xTimerCreate("blink", pdMS_TO_TICKS(5), pdFALSE, nullptr, [](TimerHandle_t){});
+    xTimerStart(timer, 0);
+    cms::test::MoveTimeForward(5ms);
+
+    auto json = cms::test::GetTimelineJson();
+    CheckContains(json, R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"Timers"}})");
+    CheckContains(json, R"({"name":"blink","ph":"i","pid":1,"tid":1,"ts":5000.000,"s":"t"})");
+    xTimerDelete(timer, 0);
+}
+
+TEST(TimelineTests, isr_to_span_receiving_its_event_is_a_flow)
+{
+    auto semaphore = xSemaphoreCreateBinary();
+    cms::test::MoveTimeForward(2ms);
+    cms::test::RunInIsrContext([=]() {
+        xSemaphoreGiveFromISR(semaphore, nullptr);
+    });
+    cms::test::MoveTimeForward(1ms);
+    {
+        cms::test::TimelineSpan span("Service_ProcessOneEvent");
+        xSemaphoreTake(semaphore, 0);
+    }
+
+    auto json = cms::test::GetTimelineJson();
+    CheckContains(json, R"({"name":"thread_name","ph":"M","pid":1,"tid":3,"args":{"name":"Service_ProcessOneEvent"}})");
+    CheckContains(json, R"({"name":"ISR","ph":"B","pid":1,"tid":0,"ts":2000.000})");
+    CheckContains(json, R"({"name":"ISR","ph":"E","pid":1,"tid":0,"ts":2000.000})");
+    CheckContains(json, R"({"name":"Service_ProcessOneEvent","ph":"B","pid":1,"tid":3,"ts":3000.000})");
+    CheckContains(json, R"({"name":"Service_ProcessOneEvent","ph":"E","pid":1,"tid":3,"ts":3000.000})");
+    CheckContains(json, R"({"name":"ISR event","ph":"s","pid":1,"tid":0,"ts":2000.000,"cat":"isr","id":1})");
+    CheckContains(json, R"({"name":"ISR event","ph":"f","pid":1,"tid":3,"ts":3000.000,"cat":"isr","id":1,"bp":"e"})");
+    vSemaphoreDelete(semaphore);
+}
+
+TEST(TimelineTests, events_are_available_with_their_track_by_name)
+{
+    cms::test::MoveTimeForward(1ms);
+    {
+        cms::test::TimelineSpan span("Service_ProcessOneEvent");
+    }
+
+    auto events = cms::test::GetTimelineEvents();
+    CHECK_EQUAL(2, events.size());
+    CHECK_EQUAL('B', events[0].phase);
+    CHECK_EQUAL('E', events[1].phase);
+    CHECK_TRUE(1ms == events[0].time);
+    STRCMP_EQUAL("Service_ProcessOneEvent", events[0].track.c_str());
+    STRCMP_EQUAL("Service_ProcessOneEvent", events[0].name.c_str());
+
+    cms::test::TimelineTeardown();
+    CHECK_TRUE(cms::test::GetTimelineEvents().empty());
+}
+
+TEST(TimelineTests, spans_and_events_are_not_recorded_when_inactive)
+{
+    cms::test::TimelineTeardown();
+    CHECK_FALSE(cms::test::TimelineIsActive());
+    {
+        cms::test::TimelineSpan span("Service_ProcessOneEvent");
+        cms::test::RunInIsrContext([]() {});
+    }
+    STRCMP_EQUAL("{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\"}\n", cms::test::GetTimelineJson().c_str());
+}
+
+TEST(TimelineTests, teardown_saves_the_timeline_to_the_given_file)
+{
+    cms::test::TimelineInit(s_timelineFile.c_str());
+    cms::test::RunInIsrContext([]() {});
+    auto json = cms::test::GetTimelineJson();
+    cms::test::TimelineTeardown();
+
+    auto file = fopen(s_timelineFile.c_str(), "r");
+    CHECK_TRUE(file != nullptr);
+    std::string saved;
+    char buffer[256];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        saved.append(buffer, count);
+    }
+    fclose(file);
+    STRCMP_EQUAL(json.c_str(), saved.c_str());
+}
@@ -258,3 +258,22 @@ TEST(TimersTests, timer_get_expiry_works_as_expected_with_move_time_forward_and_
     CHECK_EQUAL(400, remaining);
 }
 
+
+TEST(TimersTests, fake_timers_are_started_by_the_first_timer_created_keeping_time)
+{
+    CHECK_FALSE(cms::test::TimersIsStarted());
+    cms::test::MoveTimeForward(10s);
+    CHECK_TRUE(10s == cms::test::GetCurrentInternalTime());
+    CHECK_FALSE(cms::test::TimersIsStarted());
+
+    auto timer = xTimerCreate("test", pdMS_TO_TICKS(1000), pdFALSE, nullptr, [](TimerHandle_t){
+        mock("TEST").actualCall("callback");
+    });
+    CHECK_TRUE(cms::test::TimersIsStarted());
+    CHECK_TRUE(10s == cms::test::GetCurrentInternalTime());
+
+    xTimerStart(timer, 0);
+    mock("TEST").expectOneCall("callback");
+    cms::test::MoveTimeForward(1s);
+    mock().checkExpectations();
+}
@@ -0,0 +1,306 @@
+/// @brief Tests of the FreeRTOS trace macros invoked by the fakes.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <array>
+#include <cstring>
+#include <string>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "cpputest_for_freertos_isr.hpp"
+#include "CppUTest/TestHarness.h"
+
+//this executable's fakes are built with cpputest_for_freertos_trace_hooks_tests.h,
+//see CMS_FREERTOS_TRACE_HOOKS_HEADER
+#ifndef CMS_FREERTOS_TRACE_HOOKS_HEADER
+#error "the trace hooks tests require CMS_FREERTOS_TRACE_HOOKS_HEADER"
+#endif
+
+using namespace std::chrono_literals;
+
+struct HookCall
+{
+    const char * macro;
+    const void * object;
+    unsigned long value;
+};
+
+//no allocation, as the hooks are called from within pvPortMalloc/vPortFree
+static std::array<HookCall, 64> s_hookCalls;
+static size_t s_hookCallCount = 0;
+
+extern "C" void TraceHookCalled(const char * macro, const void * object, unsigned long value)
+{
+    if (s_hookCallCount < s_hookCalls.size())
+    {
+        s_hookCalls[s_hookCallCount] = {macro, object, value};
+    }
+    s_hookCallCount++;
+}
+
+static void TimerCallback(TimerHandle_t timer)
+{
+    (void)timer;
+}
+
+static void TaskCode(void * parameters)
+{
+    (void)parameters;
+}
+
+TEST_GROUP(TraceHooksTests)
+{
+    void setup() final
+    {
+        cms::test::HeapInit();
+        cms::test::TaskInit();
+        cms::test::TimersInit();
+        cms::test::IsrInit();
+        ClearHookCalls();
+    }
+
+    void teardown() final
+    {
+        cms::test::IsrTeardown();
+        cms::test::TimersDestroy();
+        cms::test::TaskDestroy();
+        cms::test::HeapTeardown();
+    }
+
+    static void ClearHookCalls()
+    {
+        s_hookCallCount = 0;
+    }
+
+    /**
+     * @return the macros called since ClearHookCalls(), in order, without
+     *         their "trace" prefix, e.g. "QUEUE_SEND QUEUE_RECEIVE"
+     */
+    static std::string HookCallSequence()
+    {
+        CHECK_TRUE(s_hookCallCount <= s_hookCalls.size());
+        std::string sequence;
+        for (size_t i = 0; i < s_hookCallCount; ++i)
+        {
+            if (!sequence.empty())
+            {
+                sequence += " ";
+            }
+            sequence += s_hookCalls[i].macro;
+        }
+        return sequence;
+    }
+
+    static const HookCall & FindHookCall(const char * macro)
+    {
+        for (size_t i = 0; (i < s_hookCallCount) && (i < s_hookCalls.size()); ++i)
+        {
+            if (strcmp(s_hookCalls[i].macro, macro) == 0)
+            {
+                return s_hookCalls[i];
+            }
+        }
+        FAIL(macro);
+        return s_hookCalls[0];
+    }
+};
+
+TEST(TraceHooksTests, queue_api_invokes_the_queue_trace_macros_with_the_queue)
+{
+    auto queue = xQueueCreate(1, sizeof(uint32_t));
+    STRCMP_EQUAL("MALLOC QUEUE_CREATE", HookCallSequence().c_str());
+    POINTERS_EQUAL(queue, FindHookCall("QUEUE_CREATE").object);
+
+    ClearHookCalls();
+    uint32_t value = 42;
+    vQueueAddToRegistry(queue, "queue");
+    xQueueSend(queue, &value, 0);
+    xQueueSend(queue, &value, 0);
+    xQueuePeek(queue, &value, 0);
+    xQueueReceive(queue, &value, 0);
+    xQueueReceive(queue, &value, 0);
+    STRCMP_EQUAL("QUEUE_REGISTRY_ADD QUEUE_SEND QUEUE_SEND_FAILED QUEUE_PEEK QUEUE_RECEIVE QUEUE_RECEIVE_FAILED",
+                 HookCallSequence().c_str());
+    for (size_t i = 0; i < s_hookCallCount; ++i)
+    {
+        POINTERS_EQUAL(queue, s_hookCalls[i].object);
+    }
+
+    ClearHookCalls();
+    vQueueDelete(queue);
+    STRCMP_EQUAL("QUEUE_DELETE FREE", HookCallSequence().c_str());
+}
+
+TEST(TraceHooksTests, queue_api_from_an_isr_invokes_the_from_isr_trace_macros)
+{
+    auto queue = xQueueCreate(1, sizeof(uint32_t));
+    ClearHookCalls();
+
+    cms::test::RunInIsrContext([&]()
+    {
+        uint32_t value = 42;
+        xQueueSendFromISR(queue, &value, nullptr);
+        xQueueReceiveFromISR(queue, &value, nullptr);
+    });
+
+    STRCMP_EQUAL("QUEUE_SEND_FROM_ISR QUEUE_RECEIVE_FROM_ISR", HookCallSequence().c_str());
+    vQueueDelete(queue);
+}
+
+TEST(TraceHooksTests, semaphore_and_mutex_creation_invoke_their_trace_macros_as_the_kernel)
+{
+    auto semaphore = xSemaphoreCreateCounting(2, 0);
+    STRCMP_EQUAL("MALLOC QUEUE_CREATE CREATE_COUNTING_SEMAPHORE", HookCallSequence().c_str());
+
+    //the kernel creates a mutex given
+    ClearHookCalls();
+    auto mutex = xSemaphoreCreateRecursiveMutex();
+    STRCMP_EQUAL("MALLOC QUEUE_CREATE CREATE_MUTEX QUEUE_SEND", HookCallSequence().c_str());
+    POINTERS_EQUAL(mutex, FindHookCall("CREATE_MUTEX").object);
+
+    vSemaphoreDelete(mutex);
+    vSemaphoreDelete(semaphore);
+}
+
+TEST(TraceHooksTests, recursive_mutex_api_invokes_the_recursive_trace_macros_as_the_kernel)
+{
+    auto mutex = xSemaphoreCreateRecursiveMutex();
+    ClearHookCalls();
+
+    xSemaphoreTakeRecursive(mutex, 0);
+    xSemaphoreTakeRecursive(mutex, 0);
+    xSemaphoreGiveRecursive(mutex);
+    xSemaphoreGiveRecursive(mutex);
+
+    //only the first take and the final give reach the underlying queue
+    STRCMP_EQUAL("TAKE_MUTEX_RECURSIVE QUEUE_RECEIVE TAKE_MUTEX_RECURSIVE "
+                 "GIVE_MUTEX_RECURSIVE GIVE_MUTEX_RECURSIVE QUEUE_SEND",
+                 HookCallSequence().c_str());
+    vSemaphoreDelete(mutex);
+}
+
+TEST(TraceHooksTests, task_switches_and_delays_find_the_current_task_as_pxCurrentTCB)
+{
+    TaskHandle_t task = nullptr;
+    xTaskCreate(TaskCode, "task", configMINIMAL_STACK_SIZE, nullptr, 1, &task);
+    STRCMP_EQUAL("MALLOC MALLOC TASK_CREATE", HookCallSequence().c_str());
+    POINTERS_EQUAL(task, FindHookCall("TASK_CREATE").object);
+
+    ClearHookCalls();
+    cms::test::SetCurrentTask(task);
+    vTaskDelay(5);
+    vTaskPrioritySet(task, 2);
+    cms::test::SetCurrentTask(nullptr);
+    STRCMP_EQUAL("TASK_SWITCHED_IN TASK_DELAY TASK_PRIORITY_SET TASK_SWITCHED_OUT",
+                 HookCallSequence().c_str());
+    POINTERS_EQUAL(task, FindHookCall("TASK_SWITCHED_IN").object);
+    POINTERS_EQUAL(task, FindHookCall("TASK_DELAY").object);
+    CHECK_EQUAL(5UL, FindHookCall("TASK_DELAY").value);
+    CHECK_EQUAL(2UL, FindHookCall("TASK_PRIORITY_SET").value);
+    POINTERS_EQUAL(task, FindHookCall("TASK_SWITCHED_OUT").object);
+
+    ClearHookCalls();
+    vTaskDelete(task);
+    POINTERS_EQUAL(task, FindHookCall("TASK_DELETE").object);
+}
+
+TEST(TraceHooksTests, task_delay_until_only_invokes_the_delay_until_trace_macro)
+{
+    TaskHandle_t task = nullptr;
+    xTaskCreate(TaskCode, "task", configMINIMAL_STACK_SIZE, nullptr, 1, &task);
+    cms::test::SetCurrentTask(task);
+    auto lastWakeTime = xTaskGetTickCount();
+    ClearHookCalls();
+
+    xTaskDelayUntil(&lastWakeTime, 10);
+
+    STRCMP_EQUAL("TASK_DELAY_UNTIL", HookCallSequence().c_str());
+    POINTERS_EQUAL(task, FindHookCall("TASK_DELAY_UNTIL").object);
+    CHECK_EQUAL(static_cast<unsigned long>(lastWakeTime + 10), FindHookCall("TASK_DELAY_UNTIL").value);
+    cms::test::SetCurrentTask(nullptr);
+}
+
+TEST(TraceHooksTests, timer_api_and_expiry_invoke_the_timer_trace_macros)
+{
+    auto timer = xTimerCreate("timer", pdMS_TO_TICKS(10), pdFALSE, nullptr, TimerCallback);
+    POINTERS_EQUAL(timer, FindHookCall("TIMER_CREATE").object);
+
+    ClearHookCalls();
+    xTimerStart(timer, 0);
+    STRCMP_EQUAL("TIMER_COMMAND_SEND TIMER_COMMAND_RECEIVED", HookCallSequence().c_str());
+    CHECK_EQUAL(static_cast<unsigned long>(tmrCOMMAND_START), FindHookCall("TIMER_COMMAND_SEND").value);
+
+    ClearHookCalls();
+    cms::test::MoveTimeForward(10ms);
+    STRCMP_EQUAL("TIMER_EXPIRED", HookCallSequence().c_str());
+    POINTERS_EQUAL(timer, FindHookCall("TIMER_EXPIRED").object);
+}
+
+TEST(TraceHooksTests, heap_allocations_invoke_malloc_and_free_trace_macros_with_the_block_size)
+{
+    auto block = pvPortMalloc(16);
+    STRCMP_EQUAL("MALLOC", HookCallSequence().c_str());
+    POINTERS_EQUAL(block, FindHookCall("MALLOC").object);
+
+    //as with heap_4, the size includes the block header
+    auto size = FindHookCall("MALLOC").value;
+    CHECK_TRUE(size > 16UL);
+
+    ClearHookCalls();
+    vPortFree(block);
+    STRCMP_EQUAL("FREE", HookCallSequence().c_str());
+    POINTERS_EQUAL(block, FindHookCall("FREE").object);
+    CHECK_EQUAL(size, FindHookCall("FREE").value);
+}
+
+TEST(TraceHooksTests, event_group_and_stream_buffer_api_invoke_their_trace_macros)
+{
+    auto group = xEventGroupCreate();
+    auto buffer = xStreamBufferCreate(16, 1);
+    ClearHookCalls();
+
+    xEventGroupSetBits(group, 0x01);
+    xEventGroupWaitBits(group, 0x02, pdFALSE, pdFALSE, 0);
+    const uint8_t sent[3] = {1, 2, 3};
+    uint8_t received[3] = {};
+    xStreamBufferSend(buffer, sent, sizeof(sent), 0);
+    xStreamBufferReceive(buffer, received, sizeof(received), 0);
+
+    STRCMP_EQUAL("EVENT_GROUP_SET_BITS EVENT_GROUP_WAIT_BITS_END STREAM_BUFFER_SEND STREAM_BUFFER_RECEIVE",
+                 HookCallSequence().c_str());
+    CHECK_EQUAL(0x01UL, FindHookCall("EVENT_GROUP_SET_BITS").value);
+
+    //the wait was not satisfied, i.e. timed out
+    CHECK_EQUAL(static_cast<unsigned long>(pdTRUE), FindHookCall("EVENT_GROUP_WAIT_BITS_END").value);
+    CHECK_EQUAL(3UL, FindHookCall("STREAM_BUFFER_SEND").value);
+    CHECK_EQUAL(3UL, FindHookCall("STREAM_BUFFER_RECEIVE").value);
+
+    vStreamBufferDelete(buffer);
+    vEventGroupDelete(group);
+}
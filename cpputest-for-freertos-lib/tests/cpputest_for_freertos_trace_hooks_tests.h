@@ -0,0 +1,86 @@
+/// @brief Trace macros of the trace hooks tests, included by FreeRTOSConfig.h.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#ifndef CPPUTEST_FOR_FREERTOS_TRACE_HOOKS_TESTS_H
+#define CPPUTEST_FOR_FREERTOS_TRACE_HOOKS_TESTS_H
+
+/* As with a project's trace hooks, this header is included by FreeRTOSConfig.h,
+ * hence may be included by C code, and is restricted to C. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void TraceHookCalled(const char * macro, const void * object, unsigned long value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define traceQUEUE_CREATE(pxNewQueue)                TraceHookCalled("QUEUE_CREATE", (pxNewQueue), 0)
+#define traceQUEUE_DELETE(pxQueue)                   TraceHookCalled("QUEUE_DELETE", (pxQueue), 0)
+#define traceQUEUE_REGISTRY_ADD(xQueue, pcQueueName) TraceHookCalled("QUEUE_REGISTRY_ADD", (xQueue), 0)
+#define traceQUEUE_SEND(pxQueue)                     TraceHookCalled("QUEUE_SEND", (pxQueue), 0)
+#define traceQUEUE_SEND_FAILED(pxQueue)              TraceHookCalled("QUEUE_SEND_FAILED", (pxQueue), 0)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)            TraceHookCalled("QUEUE_SEND_FROM_ISR", (pxQueue), 0)
+#define traceQUEUE_RECEIVE(pxQueue)                  TraceHookCalled("QUEUE_RECEIVE", (pxQueue), 0)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)           TraceHookCalled("QUEUE_RECEIVE_FAILED", (pxQueue), 0)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)         TraceHookCalled("QUEUE_RECEIVE_FROM_ISR", (pxQueue), 0)
+#define traceQUEUE_PEEK(pxQueue)                     TraceHookCalled("QUEUE_PEEK", (pxQueue), 0)
+
+#define traceCREATE_MUTEX(pxNewQueue)                TraceHookCalled("CREATE_MUTEX", (pxNewQueue), 0)
+#define traceTAKE_MUTEX_RECURSIVE(pxMutex)           TraceHookCalled("TAKE_MUTEX_RECURSIVE", (pxMutex), 0)
+#define traceGIVE_MUTEX_RECURSIVE(pxMutex)           TraceHookCalled("GIVE_MUTEX_RECURSIVE", (pxMutex), 0)
+#define traceCREATE_COUNTING_SEMAPHORE()             TraceHookCalled("CREATE_COUNTING_SEMAPHORE", 0, 0)
+
+/* as with the kernel, the switched task and the delaying task are pxCurrentTCB */
+#define traceTASK_CREATE(pxNewTCB)                   TraceHookCalled("TASK_CREATE", (pxNewTCB), 0)
+#define traceTASK_DELETE(pxTaskToDelete)             TraceHookCalled("TASK_DELETE", (pxTaskToDelete), 0)
+#define traceTASK_PRIORITY_SET(pxTask, uxNewPriority) \
+    TraceHookCalled("TASK_PRIORITY_SET", (pxTask), (unsigned long)(uxNewPriority))
+#define traceTASK_SWITCHED_IN()                      TraceHookCalled("TASK_SWITCHED_IN", pxCurrentTCB, 0)
+#define traceTASK_SWITCHED_OUT()                     TraceHookCalled("TASK_SWITCHED_OUT", pxCurrentTCB, 0)
+#define traceTASK_DELAY()                            TraceHookCalled("TASK_DELAY", pxCurrentTCB, (unsigned long)xTicksToDelay)
+#define traceTASK_DELAY_UNTIL(xTimeToWake) \
+    TraceHookCalled("TASK_DELAY_UNTIL", pxCurrentTCB, (unsigned long)(xTimeToWake))
+
+#define traceTIMER_CREATE(pxNewTimer)                TraceHookCalled("TIMER_CREATE", (pxNewTimer), 0)
+#define traceTIMER_COMMAND_SEND(xTimer, xMessageID, xMessageValueValue, xReturn) \
+    TraceHookCalled("TIMER_COMMAND_SEND", (xTimer), (unsigned long)(xMessageID))
+#define traceTIMER_COMMAND_RECEIVED(pxTimer, xMessageID, xMessageValue) \
+    TraceHookCalled("TIMER_COMMAND_RECEIVED", (pxTimer), (unsigned long)(xMessageID))
+#define traceTIMER_EXPIRED(pxTimer)                  TraceHookCalled("TIMER_EXPIRED", (pxTimer), 0)
+
+#define traceMALLOC(pvAddress, uiSize)               TraceHookCalled("MALLOC", (pvAddress), (unsigned long)(uiSize))
+#define traceFREE(pvAddress, uiSize)                 TraceHookCalled("FREE", (pvAddress), (unsigned long)(uiSize))
+
+#define traceEVENT_GROUP_SET_BITS(xEventGroup, uxBitsToSet) \
+    TraceHookCalled("EVENT_GROUP_SET_BITS", (xEventGroup), (unsigned long)(uxBitsToSet))
+#define traceEVENT_GROUP_WAIT_BITS_END(xEventGroup, uxBitsToWaitFor, xTimeoutOccurred) \
+    TraceHookCalled("EVENT_GROUP_WAIT_BITS_END", (xEventGroup), (unsigned long)(xTimeoutOccurred))
+
+#define traceSTREAM_BUFFER_SEND(xStreamBuffer, xBytesSent) \
+    TraceHookCalled("STREAM_BUFFER_SEND", (xStreamBuffer), (unsigned long)(xBytesSent))
+#define traceSTREAM_BUFFER_RECEIVE(xStreamBuffer, xReceivedLength) \
+    TraceHookCalled("STREAM_BUFFER_RECEIVE", (xStreamBuffer), (unsigned long)(xReceivedLength))
+
+#endif //CPPUTEST_FOR_FREERTOS_TRACE_HOOKS_TESTS_H
@@ -0,0 +1,235 @@
+/// @brief Tests of the opt-in binary trace recorder of fake kernel API calls.
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "timers.h"
+#include "cpputest_for_freertos_trace.hpp"
+#include "cpputest_for_freertos_memory.hpp"
+#include "cpputest_for_freertos_task.hpp"
+#include "cpputest_for_freertos_timers.hpp"
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+
+using namespace std::chrono_literals;
+using cms::test::TraceOp;
+
+//unique per test and process, as the CTest shards may run at the same time
+static std::string s_traceFile;
+
+TEST_GROUP(TraceTests)
+{
+    TestTestingFixture fixture;
+
+    void setup() final
+    {
+        cms::test::HeapInit();
+        cms::test::TaskInit();
+        cms::test::TimersInit();
+        cms::test::TraceInit(64);
+
+        auto shell = UtestShell::getCurrent();
+        s_traceFile = std::string(shell->getGroup().asCharString()) + "_" + shell->getName().asCharString() +
+                      "_" + std::to_string(getpid()) + ".trace";
+    }
+
+    void teardown() final
+    {
+        cms::test::TraceTeardown();
+        cms::test::TimersDestroy();
+        cms::test::TaskDestroy();
+        cms::test::HeapTeardown();
+        remove(s_traceFile.c_str());
+    }
+
+    static void CheckRecord(const cms::test::TraceRecord & record, TraceOp op,
+                            const void * object, uint8_t result)
+    {
+        STRCMP_EQUAL(cms::test::TraceOpName(op), cms::test::TraceOpName(record.op));
+        CHECK_EQUAL(reinterpret_cast<uintptr_t>(object), record.object);
+        CHECK_EQUAL(result, record.result);
+    }
+};
+
+TEST(TraceTests, queue_semaphore_and_mutex_operations_are_traced)
+{
+    auto queue = xQueueCreate(2, sizeof(uint32_t));
+    auto semaphore = xSemaphoreCreateBinary();
+    auto mutex = xSemaphoreCreateMutex();
+    uint32_t value = 7;
+
+    xQueueSend(queue, &value, 0);
+    xQueuePeek(queue, &value, 0);
+    xQueueReceive(queue, &value, 0);
+    xQueueReceive(queue, &value, 0);
+    xSemaphoreGive(semaphore);
+    xSemaphoreTake(semaphore, 0);
+    xSemaphoreTake(mutex, 0);
+    xSemaphoreGive(mutex);
+
+    //a mutex is created given
+    auto records = cms::test::GetTraceRecords();
+    CHECK_EQUAL(9, records.size());
+    CheckRecord(records[0], TraceOp::MutexGive, mutex, pdTRUE);
+    CheckRecord(records[1], TraceOp::QueueSend, queue, pdTRUE);
+    CHECK_EQUAL(sizeof(uint32_t), records[1].size);
+    CheckRecord(records[2], TraceOp::QueuePeek, queue, pdTRUE);
+    CheckRecord(records[3], TraceOp::QueueReceive, queue, pdTRUE);
+    CheckRecord(records[4], TraceOp::QueueReceive, queue, pdFALSE);
+    CheckRecord(records[5], TraceOp::SemaphoreGive, semaphore, pdTRUE);
+    CheckRecord(records[6], TraceOp::SemaphoreTake, semaphore, pdTRUE);
+    CheckRecord(records[7], TraceOp::MutexTake, mutex, pdTRUE);
+    CheckRecord(records[8], TraceOp::MutexGive, mutex, pdTRUE);
+    CHECK_EQUAL(0, records[8].fromIsr);
+
+    vSemaphoreDelete(mutex);
+    vSemaphoreDelete(semaphore);
+    vQueueDelete(queue);
+}
+
+TEST(TraceTests, timer_commands_fires_and_task_delays_are_traced_in_virtual_time)
+{
+    auto timer = xTimerCreate("trace", pdMS_TO_TICKS(10), pdFALSE, nullptr, [](TimerHandle_t){});
+    xTimerStart(timer, 0);
+    vTaskDelay(pdMS_TO_TICKS(15));
+    xTimerChangePeriod(timer, pdMS_TO_TICKS(20), 0);
+    xTimerStop(timer, 0);
+    xTimerDelete(timer, 0);
+
+    auto records = cms::test::GetTraceRecords();
+    CHECK_EQUAL(6, records.size());
+    CheckRecord(records[0], TraceOp::TimerStart, timer, pdPASS);
+    CheckRecord(records[1], TraceOp::TaskDelay, xTaskGetCurrentTaskHandle(), pdPASS);
+    CHECK_EQUAL(pdMS_TO_TICKS(15), records[1].size);
+    CHECK_EQUAL(0, records[1].virtualTime);
+    CheckRecord(records[2], TraceOp::TimerFire, timer, pdPASS);
+    CHECK_EQUAL(std::chrono::nanoseconds(10ms).count(), records[2].virtualTime);
+    CheckRecord(records[3], TraceOp::TimerChangePeriod, timer, pdPASS);
+    CHECK_EQUAL(pdMS_TO_TICKS(20), records[3].size);
+    CHECK_EQUAL(std::chrono::nanoseconds(15ms).count(), records[3].virtualTime);
+    CheckRecord(records[4], TraceOp::TimerStop, timer, pdPASS);
+    CheckRecord(records[5], TraceOp::TimerDelete, timer, pdPASS);
+}
+
+TEST(TraceTests, ring_keeps_the_most_recent_records)
+{
+    cms::test::TraceInit(3);
+    auto semaphore = xSemaphoreCreateCounting(10, 0);
+    for (int i = 0; i < 6; ++i)
+    {
+        xSemaphoreGive(semaphore);
+        vTaskDelay(1);
+    }
+
+    //capacity is rounded up to 4
+    CHECK_EQUAL(12, cms::test::GetTraceEventCount());
+    auto records = cms::test::GetTraceRecords();
+    CHECK_EQUAL(4, records.size());
+    CheckRecord(records[0], TraceOp::SemaphoreGive, semaphore, pdTRUE);
+    CheckRecord(records[3], TraceOp::TaskDelay, xTaskGetCurrentTaskHandle(), pdPASS);
+    CHECK_TRUE(records[0].virtualTime < records[3].virtualTime);
+    vSemaphoreDelete(semaphore);
+}
+
+TEST(TraceTests, host_time_is_not_recorded_when_disabled)
+{
+    cms::test::TraceInit(8, nullptr, false);
+    vTaskDelay(1);
+    auto records = cms::test::GetTraceRecords();
+    CHECK_EQUAL(1, records.size());
+    CHECK_EQUAL(0, records[0].hostTime);
+    CHECK_EQUAL(1, records[0].size);
+}
+
+TEST(TraceTests, nothing_is_traced_once_tracing_is_stopped)
+{
+    cms::test::TraceTeardown();
+    CHECK_FALSE(cms::test::TraceIsActive());
+    vTaskDelay(1);
+    CHECK_EQUAL(0, cms::test::GetTraceEventCount());
+    CHECK_TRUE(cms::test::GetTraceRecords().empty());
+}
+
+TEST(TraceTests, saved_trace_file_holds_header_and_records)
+{
+    vTaskDelay(1);
+    vTaskDelay(2);
+    CHECK_TRUE(cms::test::TraceSave(s_traceFile.c_str()));
+
+    auto file = fopen(s_traceFile.c_str(), "rb");
+    CHECK_TRUE(file != nullptr);
+    cms::test::TraceFileHeader header = {};
+    CHECK_EQUAL(1, fread(&header, sizeof(header), 1, file));
+    std::vector<cms::test::TraceRecord> records(2);
+    CHECK_EQUAL(2, fread(records.data(), sizeof(cms::test::TraceRecord), 2, file));
+    fclose(file);
+
+    MEMCMP_EQUAL(cms::test::TRACE_FILE_MAGIC, header.magic, sizeof(header.magic));
+    CHECK_EQUAL(cms::test::TRACE_FILE_VERSION, header.version);
+    CHECK_EQUAL(sizeof(cms::test::TraceRecord), header.recordSize);
+    CHECK_EQUAL(2, header.eventCount);
+    CHECK_EQUAL(2, header.recordCount);
+    CHECK_EQUAL(1, records[0].size);
+    CHECK_EQUAL(2, records[1].size);
+}
+
+static void TracedTestFails()
+{
+    cms::test::TraceInit(8, s_traceFile.c_str());
+    vTaskDelay(1);
+    FAIL_TEST("scenario failed");
+}
+
+static void TracedTestPasses()
+{
+    cms::test::TraceInit(8, s_traceFile.c_str());
+    vTaskDelay(1);
+}
+
+TEST(TraceTests, teardown_saves_trace_only_when_the_test_failed)
+{
+    fixture.setTeardown(cms::test::TraceTeardown);
+
+    fixture.setTestFunction(TracedTestPasses);
+    fixture.runAllTests();
+    CHECK_EQUAL(0, fixture.getFailureCount());
+    auto unexpected = fopen(s_traceFile.c_str(), "rb");
+    if (unexpected != nullptr)
+    {
+        fclose(unexpected);
+        FAIL("the trace of a passing test was saved");
+    }
+
+    fixture.setTestFunction(TracedTestFails);
+    fixture.runAllTests();
+    CHECK_EQUAL(1, fixture.getFailureCount());
+    auto file = fopen(s_traceFile.c_str(), "rb");
+    CHECK_TRUE(file != nullptr);
+    fclose(file);
+}
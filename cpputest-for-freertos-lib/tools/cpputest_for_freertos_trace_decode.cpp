@@ -0,0 +1,88 @@
+/// @brief Decodes a trace file saved by cms::test::TraceSave() to text,
+///        one line per traced kernel API call.
+///
+///
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// Copyright (C) 2024 Matthew Eshleman. All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// Alternatively, upon written permission from Matthew Eshleman, this program
+/// may be distributed and modified under the terms of a Commercial
+/// License. For further details, see the Contact Information below.
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include "cpputest_for_freertos_trace.hpp"
+
+using cms::test::TraceFileHeader;
+using cms::test::TraceRecord;
+
+int main(int argc, char * argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    auto file = fopen(argv[1], "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    TraceFileHeader header = {};
+    if ((fread(&header, sizeof(header), 1, file) != 1) ||
+        (memcmp(header.magic, cms::test::TRACE_FILE_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.version != cms::test::TRACE_FILE_VERSION) ||
+        (header.recordSize != sizeof(TraceRecord)))
+    {
+        fprintf(stderr, "%s: %s is not a version %" PRIu32 " trace file\n",
+                argv[0], argv[1], cms::test::TRACE_FILE_VERSION);
+        fclose(file);
+        return 1;
+    }
+
+    printf("# %" PRIu64 " events traced, the last %" PRIu64 " recorded\n",
+           header.eventCount, header.recordCount);
+    printf("# %14s %14s %-18s %-18s %10s %6s %s\n",
+           "virtual_ns", "host_ns", "op", "object", "size", "result", "context");
+
+    uint64_t decoded = 0;
+    TraceRecord record = {};
+    while ((decoded < header.recordCount) && (fread(&record, sizeof(record), 1, file) == 1))
+    {
+        printf("%16" PRId64 " %14" PRId64 " %-18s 0x%016" PRIx64 " %10" PRIu32 " %6u %s\n",
+               record.virtualTime, record.hostTime,
+               cms::test::TraceOpName(record.op),
+               record.object, record.size,
+               static_cast<unsigned>(record.result),
+               (record.fromIsr != 0) ? "isr" : "task");
+        decoded++;
+    }
+    fclose(file);
+
+    if (decoded != header.recordCount)
+    {
+        fprintf(stderr, "%s: %s is truncated, %" PRIu64 " of %" PRIu64 " records decoded\n",
+                argv[0], argv[1], decoded, header.recordCount);
+        return 1;
+    }
+
+    return 0;
+}
@@ -22,6 +22,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
 #include "buttonService.h"
 #include "cpputest_for_freertos_lib.hpp"
 #include "mockButtonReader.hpp"
@@ -89,6 +90,39 @@ TEST(ButtonServiceTests, given_button_isr_then_reads_button_status)
     mock().checkExpectations();
 }
 
+TEST(ButtonServiceTests, given_button_isr_then_timeline_shows_the_isr_flowing_to_the_processing_span)
+{
+    //see the timeline of a test by giving TimelineInit() a file, and opening it in chrome://tracing
+    cms::test::TimelineInit();
+    uint16_t pressedBits = ON_OFF_BIT;
+    uint16_t releasedBits = 0;
+    mock("ButtonReader")
+            .expectOneCall("Read")
+            .withOutputParameterReturning("pressed", &pressedBits, sizeof(pressedBits))
+            .withOutputParameterReturning("released", &releasedBits, sizeof(releasedBits));
+    mock("TEST").expectOneCall("Callback").ignoreOtherParameters();
+
+    cms::test::mock::ButtonReaderDoIsr();
+    {
+        cms::test::TimelineSpan span("ButtonService_ProcessOneEvent");
+        CHECK_TRUE(ButtonService_ProcessOneEvent(EXECUTION_OPTION_UNIT_TEST));
+    }
+    CHECK_FALSE(ButtonService_ProcessOneEvent(EXECUTION_OPTION_UNIT_TEST));
+    mock().checkExpectations();
+
+    //the flow starts on the ISR track, and ends on the span's own track
+    auto events = cms::test::GetTimelineEvents();
+    auto flowStart = std::find_if(events.begin(), events.end(), [](const cms::test::TimelineRecord& event) {
+        return (event.phase == 's') && (event.track == "ISR");
+    });
+    CHECK_TRUE(flowStart != events.end());
+    auto flowEnd = std::find_if(events.begin(), events.end(), [&](const cms::test::TimelineRecord& event) {
+        return (event.phase == 'f') && (event.value == flowStart->value);
+    });
+    CHECK_TRUE(flowEnd != events.end());
+    STRCMP_EQUAL("ButtonService_ProcessOneEvent", flowEnd->track.c_str());
+}
+
 TEST(ButtonServiceTests, given_button_isr_and_registered_callback_then_reads_button_status_and_executes_service_callback)
 {
     mock("TEST").expectOneCall("Callback")
@@ -143,4 +177,17 @@ TEST(ButtonServiceTests, given_garbage_button_read_then_callback_is_not_executed
     mock("TEST").expectNoCall("Callback");
     DoButtonIsr(1, 1);
     mock().checkExpectations();
-}
\ No newline at end of file
+}
+
+TEST(ButtonServiceTests, given_button_isr_then_isr_yields_and_event_is_processed_without_tick_delay)
+{
+    mock("TEST").expectOneCall("Callback")
+            .withParameter("state", BUTTON_PRESSED)
+            .ignoreOtherParameters();
+
+    DoButtonIsr(ON_OFF_BIT, 0);
+
+    mock().checkExpectations();
+    CHECK_TRUE(cms::test::WasYieldRequestedFromIsr());
+    CHECK_TRUE(std::chrono::nanoseconds::zero() == cms::test::GetMaxIsrLatency());
+}
@@ -1,5 +1,6 @@
 #include "buttonReader.h"
 #include "mockButtonReader.hpp"
+#include "cpputest_for_freertos_isr.hpp"
 #include "CppUTestExt/MockSupport.h"
 
 static constexpr const char* MOCK_NAME = "ButtonReader";
@@ -40,7 +41,7 @@ namespace cms::test::mock {
             return;
         }
 
-        s_lastCallback(s_lastContext);
+        cms::test::RunInIsrContext([]() { s_lastCallback(s_lastContext); });
     }
 }
 